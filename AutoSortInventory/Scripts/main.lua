@@ -16,6 +16,11 @@ local AUTO_SORT_ENABLED = true
 -- Prevent spam / potential recursive updates.
 local AUTO_SORT_COOLDOWN_SECONDS = 0.35
 
+-- Leave auto-sort to InventoryStackSizeBoost's native sorter (set AutoSort = true in
+-- its stack_config.ini). It re-sorts only the slots that changed on each update
+-- instead of a full RearrangePlayerInventory; the sort-now hotkey still uses the game's.
+local USE_NATIVE_SORTER = false
+
 -- Hotkeys
 local SORT_NOW_KEY = Key.O
 local SORT_NOW_MODS = { ModifierKey.CONTROL }
@@ -115,10 +120,21 @@ end
 -- =========================
 
 RegisterKeybindSafe(SORT_NOW_KEY, SORT_NOW_MODS, function()
+    -- InventoryStackSizeBoost finds the controller and inventory natively and runs the
+    -- sort on the game thread on the next frame
+    if StackBoostPost then
+        StackBoostPost("rearrange_inventory")
+        log("Sort queued (hotkey)")
+        return
+    end
     SortPlayerInventory(nil, "hotkey")
 end)
 
 RegisterKeybindSafe(TOGGLE_AUTO_KEY, TOGGLE_AUTO_MODS, function()
+    if USE_NATIVE_SORTER then
+        log("Auto-sort is handled by InventoryStackSizeBoost; toggle AutoSort in its stack_config.ini")
+        return
+    end
     AUTO_SORT_ENABLED = not AUTO_SORT_ENABLED
     log(string.format("Auto-sort %s", AUTO_SORT_ENABLED and "ENABLED" or "DISABLED"))
 end)
@@ -130,11 +146,28 @@ end)
 local LastAutoSortAt = 0.0
 local IsAutoSorting = false
 
+if USE_NATIVE_SORTER then
+    log("Loaded. Ctrl+O = sort now; auto-sort is done natively by InventoryStackSizeBoost.")
+    return
+end
+
 PreOnInvUpdate, PostOnInvUpdate = RegisterHook(
     "/Script/BeltTD.BeltTDPlayerController:OnInventoryUpdate",
     ---@param Context RemoteUnrealParam<APlayerController>
     function(Context)
-        if not AUTO_SORT_ENABLED or IsAutoSorting then
+        if not AUTO_SORT_ENABLED then
+            return
+        end
+
+        -- InventoryStackSizeBoost coalesces a burst of updates into one sort on the next
+        -- frame (trailing, so the last update is never skipped) and ignores the update the
+        -- sort itself raises.
+        if StackBoostPost then
+            StackBoostPost("rearrange_inventory")
+            return
+        end
+
+        if IsAutoSorting then
             return
         end
 
@@ -4,16 +4,48 @@ local function log(msg)
     print(string.format("%s %s\n", MOD_TAG, msg))
 end
 
+-- Leave the patch to InventoryStackSizeBoost (uncomment the BP_Cannon section in its
+-- table_patches.ini). It patches the template once when BP_Cannon loads and updates
+-- cannons that already exist in the same pass, instead of a callback per cannon.
+local USE_NATIVE_PATCH = false
+
+if USE_NATIVE_PATCH then
+    log("Cannon defaults are patched natively by InventoryStackSizeBoost (table_patches.ini)")
+    return
+end
+
+local GEN_VAR_PATH = "/Game/Blueprints/Buildings/BP_Cannon.BP_Cannon_C:CannonFacility_GEN_VARIABLE"
+
+-- With InventoryStackSizeBoost loaded, the first cannon hands the whole patch to it in
+-- one call: the template and every cannon spawned so far are written natively on the
+-- next frame (or once BP_Cannon has finished loading), and later cannons copy the template.
+local NATIVE_PATCH = "[" .. GEN_VAR_PATH .. "]\n" .. [[
+CatapultMaxDistance = 99999.0
+CatapultMinDistance = 0.1
+SplineNumPoints = 6
+ObstacleTraceNum = 0
+]]
+
 local gen_var = nil
+local native_patch_sent = false
 
 NotifyOnNewObject("/Script/BeltTD.CannonFacilityComponent", function(cannon_obj)
+    if StackBoostPatch then
+        if not native_patch_sent then
+            native_patch_sent = true
+            StackBoostPatch("CannonFacilityBoost", NATIVE_PATCH)
+            log("cannon facility defaults handed to InventoryStackSizeBoost")
+        end
+        return
+    end
+
     if not cannon_obj or not cannon_obj.IsValid or not cannon_obj:IsValid() then
         return
     end
 
     ExecuteInGameThread(function()
         if not gen_var or not gen_var.IsValid or not gen_var:IsValid() then
-            gen_var = StaticFindObject("/Game/Blueprints/Buildings/BP_Cannon.BP_Cannon_C:CannonFacility_GEN_VARIABLE")
+            gen_var = StaticFindObject(GEN_VAR_PATH)
             gen_var.CatapultMaxDistance = 99999.0
             gen_var.CatapultMinDistance = 0.1
             gen_var.SplineNumPoints = 6
@@ -0,0 +1,383 @@
+#pragma once
+
+/**
+ * AsyncLog - binary event logging off the hook hot path
+ *
+ * Hooks record a fixed-size binary record (event id + up to four raw 64-bit
+ * arguments) into a per-thread single-producer/single-consumer ring buffer.
+ * A background thread drains every ring, formats the records using the
+ * event's format string and hands finished lines to a sink (Output::send in
+ * the DLL). Per-event sampling and per-second rate limits are applied on the
+ * producer side before anything is written, so suppressed events cost a few
+ * relaxed atomic operations.
+ *
+ * Format strings use "{}" placeholders; each event declares one kind character
+ * per argument:
+ *   d - signed integer    u - unsigned integer    x - hex (0x...)
+ *   n - name, formatted through the name resolver (e.g. an FName's bytes)
+ */
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cwchar>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace StackBoost
+{
+    enum class AsyncLogLevel : uint8_t
+    {
+        Verbose,
+        Default,
+        Warning,
+        Error,
+    };
+
+    struct AsyncLogEventSpec
+    {
+        const wchar_t* Format;
+        const char* ArgKinds;       // One kind character per argument
+        AsyncLogLevel Level = AsyncLogLevel::Verbose;
+        uint32_t SampleEvery = 1;   // Keep 1 of every N occurrences
+        uint32_t MaxPerSecond = 0;  // 0 = unlimited
+    };
+
+    class AsyncLog
+    {
+    public:
+        static constexpr size_t MaxArgs = 4;
+        static constexpr size_t RingCapacity = 1024; // Records per thread, power of two
+
+        using Sink = std::function<void(AsyncLogLevel, const std::wstring&)>;
+        using NameResolver = std::function<std::wstring(uint64_t)>;
+
+        AsyncLog() = default;
+        AsyncLog(const AsyncLog&) = delete;
+        AsyncLog& operator=(const AsyncLog&) = delete;
+
+        ~AsyncLog()
+        {
+            Stop();
+        }
+
+        // Event ids index into `events`, which must outlive the logger
+        void Start(const AsyncLogEventSpec* events, size_t eventCount, Sink sink, NameResolver nameResolver = {})
+        {
+            Stop();
+            m_specs = events;
+            m_eventCount = eventCount;
+            m_eventState.reset(new EventState[eventCount]);
+            for (size_t i = 0; i < eventCount; ++i)
+            {
+                m_eventState[i].SampleEvery.store(events[i].SampleEvery ? events[i].SampleEvery : 1, std::memory_order_relaxed);
+                m_eventState[i].MaxPerSecond.store(events[i].MaxPerSecond, std::memory_order_relaxed);
+            }
+            m_sink = std::move(sink);
+            m_nameResolver = std::move(nameResolver);
+            m_generation = s_nextGeneration.fetch_add(1, std::memory_order_relaxed) + 1;
+            m_coarseSecond.store(NowSecond(), std::memory_order_relaxed);
+            m_running.store(true, std::memory_order_release);
+            m_thread = std::thread([this] { Run(); });
+        }
+
+        // Drains what is left and joins the background thread
+        void Stop()
+        {
+            if (!m_thread.joinable())
+            {
+                return;
+            }
+            m_running.store(false, std::memory_order_release);
+            m_thread.join();
+        }
+
+        // Runtime override of an event's sampling and rate limit
+        void Configure(uint16_t event, uint32_t sampleEvery, uint32_t maxPerSecond)
+        {
+            if (event >= m_eventCount)
+            {
+                return;
+            }
+            m_eventState[event].SampleEvery.store(sampleEvery ? sampleEvery : 1, std::memory_order_relaxed);
+            m_eventState[event].MaxPerSecond.store(maxPerSecond, std::memory_order_relaxed);
+        }
+
+        // Hot path. Arguments are integers, pointers or enums and are stored raw.
+        template <typename... Args>
+        void Log(uint16_t event, Args... args)
+        {
+            static_assert(sizeof...(Args) <= MaxArgs, "AsyncLog records hold at most four arguments");
+
+            if (!m_running.load(std::memory_order_relaxed) || event >= m_eventCount || !Admit(event))
+            {
+                return;
+            }
+
+            Ring* ring = LocalRing();
+            uint32_t head = ring->Head.load(std::memory_order_relaxed);
+            if (head - ring->Tail.load(std::memory_order_acquire) >= RingCapacity)
+            {
+                ring->Dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            Record& record = ring->Records[head & (RingCapacity - 1)];
+            record.Event = event;
+            record.ArgCount = static_cast<uint8_t>(sizeof...(Args));
+            size_t index = 0;
+            ((record.Args[index++] = ToRaw(args)), ...);
+            ring->Head.store(head + 1, std::memory_order_release);
+        }
+
+        // Packs a trivially copyable value (such as an FName) for an 'n' argument
+        template <typename T>
+        static uint64_t PackName(const T& name)
+        {
+            static_assert(sizeof(T) <= sizeof(uint64_t), "name must fit in a record argument");
+            uint64_t raw = 0;
+            std::memcpy(&raw, &name, sizeof(T));
+            return raw;
+        }
+
+        template <typename T>
+        static T UnpackName(uint64_t raw)
+        {
+            T name;
+            std::memcpy(&name, &raw, sizeof(T));
+            return name;
+        }
+
+        // Formats and emits everything queued so far on the calling thread
+        void Flush()
+        {
+            std::lock_guard<std::mutex> drainLock(m_drainMutex);
+            DrainAll();
+        }
+
+    private:
+        struct Record
+        {
+            uint16_t Event;
+            uint8_t ArgCount;
+            std::array<uint64_t, MaxArgs> Args;
+        };
+
+        struct Ring
+        {
+            alignas(64) std::atomic<uint32_t> Head{0}; // Written by the owning thread
+            alignas(64) std::atomic<uint32_t> Tail{0}; // Written by the drain thread
+            std::atomic<uint64_t> Dropped{0};
+            std::array<Record, RingCapacity> Records;
+        };
+
+        struct EventState
+        {
+            std::atomic<uint32_t> SampleEvery{1};
+            std::atomic<uint32_t> MaxPerSecond{0};
+            std::atomic<uint64_t> Occurrences{0};
+            std::atomic<int64_t> WindowSecond{0};
+            std::atomic<uint32_t> WindowCount{0};
+            std::atomic<uint64_t> RateLimited{0};
+        };
+
+        template <typename T>
+        static uint64_t ToRaw(T value)
+        {
+            if constexpr (std::is_pointer_v<T>)
+                return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value));
+            else if constexpr (std::is_enum_v<T>)
+                return static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(value));
+            else if constexpr (std::is_signed_v<T>)
+                return static_cast<uint64_t>(static_cast<int64_t>(value));
+            else
+                return static_cast<uint64_t>(value);
+        }
+
+        bool Admit(uint16_t event)
+        {
+            EventState& state = m_eventState[event];
+
+            uint32_t sampleEvery = state.SampleEvery.load(std::memory_order_relaxed);
+            if (sampleEvery > 1 && state.Occurrences.fetch_add(1, std::memory_order_relaxed) % sampleEvery != 0)
+            {
+                return false;
+            }
+
+            uint32_t maxPerSecond = state.MaxPerSecond.load(std::memory_order_relaxed);
+            if (maxPerSecond == 0)
+            {
+                return true;
+            }
+
+            int64_t second = m_coarseSecond.load(std::memory_order_relaxed);
+            int64_t window = state.WindowSecond.load(std::memory_order_relaxed);
+            if (window != second && state.WindowSecond.compare_exchange_strong(window, second, std::memory_order_relaxed))
+            {
+                state.WindowCount.store(0, std::memory_order_relaxed);
+            }
+            // Plain load first so a saturated window costs no read-modify-write
+            if (state.WindowCount.load(std::memory_order_relaxed) >= maxPerSecond ||
+                state.WindowCount.fetch_add(1, std::memory_order_relaxed) >= maxPerSecond)
+            {
+                state.RateLimited.store(state.RateLimited.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+            return true;
+        }
+
+        Ring* LocalRing()
+        {
+            // The generation guards against a new logger reusing a destroyed one's address
+            struct LocalSlot
+            {
+                uint64_t Generation = 0;
+                Ring* OwnedRing = nullptr;
+            };
+            thread_local LocalSlot t_slot;
+            if (t_slot.Generation == m_generation)
+            {
+                return t_slot.OwnedRing;
+            }
+
+            // Once per thread: rings are owned by the logger and never freed while it runs
+            std::lock_guard<std::mutex> lock(m_ringsMutex);
+            m_rings.push_back(std::make_unique<Ring>());
+            t_slot = {m_generation, m_rings.back().get()};
+            return t_slot.OwnedRing;
+        }
+
+        static int64_t NowSecond()
+        {
+            return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void Run()
+        {
+            while (m_running.load(std::memory_order_acquire))
+            {
+                // Producers read this instead of the clock when rate limiting
+                m_coarseSecond.store(NowSecond(), std::memory_order_relaxed);
+
+                bool didWork;
+                {
+                    std::lock_guard<std::mutex> drainLock(m_drainMutex);
+                    didWork = DrainAll();
+                }
+                if (!didWork)
+                {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                }
+            }
+            std::lock_guard<std::mutex> drainLock(m_drainMutex);
+            DrainAll();
+        }
+
+        bool DrainAll()
+        {
+            std::vector<Ring*> rings;
+            {
+                std::lock_guard<std::mutex> lock(m_ringsMutex);
+                rings.reserve(m_rings.size());
+                for (const auto& ring : m_rings)
+                {
+                    rings.push_back(ring.get());
+                }
+            }
+
+            bool didWork = false;
+            uint64_t dropped = 0;
+            for (Ring* ring : rings)
+            {
+                uint32_t tail = ring->Tail.load(std::memory_order_relaxed);
+                uint32_t head = ring->Head.load(std::memory_order_acquire);
+                for (; tail != head; ++tail)
+                {
+                    Emit(ring->Records[tail & (RingCapacity - 1)]);
+                    didWork = true;
+                }
+                ring->Tail.store(tail, std::memory_order_release);
+                dropped += ring->Dropped.exchange(0, std::memory_order_relaxed);
+            }
+
+            if (dropped != 0 && m_sink)
+            {
+                m_sink(AsyncLogLevel::Warning, L"[InventoryStackSizeBoost] Log buffer full, dropped " + std::to_wstring(dropped) + L" record(s)\n");
+            }
+            return didWork;
+        }
+
+        void Emit(const Record& record)
+        {
+            if (!m_sink)
+            {
+                return;
+            }
+
+            const AsyncLogEventSpec& spec = m_specs[record.Event];
+            m_line.clear();
+            size_t arg = 0;
+            for (const wchar_t* c = spec.Format; *c; ++c)
+            {
+                if (c[0] == L'{' && c[1] == L'}' && arg < record.ArgCount)
+                {
+                    char kind = spec.ArgKinds && spec.ArgKinds[arg] ? spec.ArgKinds[arg] : 'u';
+                    AppendArg(kind, record.Args[arg++]);
+                    ++c;
+                }
+                else
+                {
+                    m_line.push_back(*c);
+                }
+            }
+            m_sink(spec.Level, m_line);
+        }
+
+        void AppendArg(char kind, uint64_t raw)
+        {
+            switch (kind)
+            {
+            case 'd':
+                m_line += std::to_wstring(static_cast<int64_t>(raw));
+                break;
+            case 'x': {
+                wchar_t buffer[19];
+                swprintf(buffer, 19, L"0x%llX", static_cast<unsigned long long>(raw));
+                m_line += buffer;
+                break;
+            }
+            case 'n':
+                m_line += m_nameResolver ? m_nameResolver(raw) : std::to_wstring(raw);
+                break;
+            default:
+                m_line += std::to_wstring(raw);
+                break;
+            }
+        }
+
+        const AsyncLogEventSpec* m_specs = nullptr;
+        size_t m_eventCount = 0;
+        std::unique_ptr<EventState[]> m_eventState;
+        Sink m_sink;
+        NameResolver m_nameResolver;
+        std::wstring m_line; // Only touched while holding m_drainMutex
+
+        uint64_t m_generation = 0;
+        static inline std::atomic<uint64_t> s_nextGeneration{0};
+
+        std::atomic<int64_t> m_coarseSecond{0}; // Updated by the log thread every few ms
+        std::atomic<bool> m_running{false};
+        std::thread m_thread;
+        std::mutex m_drainMutex;
+        std::mutex m_ringsMutex;
+        std::vector<std::unique_ptr<Ring>> m_rings;
+    };
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+/**
+ * ConfigText - shared helpers for the mod's ini-style config files
+ *
+ * Lines are "key = value", '#' and ';' start comments and [Name] opens a
+ * section. Problems are collected as ConfigErrors so one bad line never
+ * discards the rest of a file.
+ */
+
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace StackBoost
+{
+    struct ConfigError
+    {
+        int Line; // 0 for problems with the file itself
+        std::wstring Message;
+    };
+
+    inline std::wstring TrimConfigText(const std::wstring& text)
+    {
+        size_t begin = 0;
+        size_t end = text.size();
+        while (begin < end && std::iswspace(text[begin])) ++begin;
+        while (end > begin && std::iswspace(text[end - 1])) --end;
+        return text.substr(begin, end - begin);
+    }
+
+    // Content of one config line, with comments stripped and whitespace trimmed.
+    // Returns false for blank and comment-only lines.
+    inline bool SplitConfigLine(const std::wstring& rawLine, std::wstring& line)
+    {
+        line = TrimConfigText(rawLine.substr(0, rawLine.find_first_of(L"#;")));
+        return !line.empty();
+    }
+
+    inline bool IsConfigSection(const std::wstring& line, std::wstring& section)
+    {
+        if (line.front() != L'[' || line.back() != L']')
+        {
+            return false;
+        }
+        section = TrimConfigText(line.substr(1, line.size() - 2));
+        return true;
+    }
+
+    // Reads a config file. A missing file is not an error (text stays empty,
+    // returns false); an unreadable one is reported as line 0.
+    inline bool ReadConfigText(const std::filesystem::path& path, std::wstring& text, std::vector<ConfigError>* errors)
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists(path, ec))
+        {
+            return false;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            if (errors) errors->push_back({0, L"cannot open " + path.wstring()});
+            return false;
+        }
+
+        // Row names and keywords are ASCII; bytes are widened as-is
+        std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        text.assign(bytes.begin(), bytes.end());
+        return true;
+    }
+}
@@ -0,0 +1,424 @@
+#pragma once
+
+/**
+ * DiscoveryCache - what the last launch found, memory-mapped on the next one
+ *
+ * Discovery results (object paths of DT_Enemies, the hook target UFunctions
+ * and patched tables, resolved field offsets, row counts) are written to a
+ * small binary file keyed by a fingerprint of the game build. On the next
+ * launch the file is mapped and each result is looked up by key, so objects
+ * can be fetched with StaticFindObject on their known path instead of walking
+ * the object array. Every cached object is still checked against its class
+ * and name before use; a mismatch just means the normal scan runs.
+ *
+ * Layout (little-endian, no padding between sections):
+ *
+ *   Header   magic, version, sizeof(wchar_t), build key, counts, checksum
+ *   Record[] key and path as (offset, length) into the string table, two values
+ *   wchar_t[] string table (not NUL-terminated)
+ *
+ * The checksum covers everything after the header, so a truncated or
+ * half-written file is rejected as a whole rather than read partially.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace StackBoost
+{
+    namespace Detail
+    {
+        constexpr uint64_t FnvOffset = 0xCBF29CE484222325ull;
+        constexpr uint64_t FnvPrime = 0x100000001B3ull;
+
+        inline uint64_t Fnv1a(const void* data, size_t size, uint64_t hash = FnvOffset)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash = (hash ^ bytes[i]) * FnvPrime;
+            }
+            return hash;
+        }
+    }
+
+    // Read-only view of a whole file, unmapped on destruction
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        ~MappedFile()
+        {
+            Close();
+        }
+
+        bool Open(const std::filesystem::path& path)
+        {
+            Close();
+#ifdef _WIN32
+            HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+            LARGE_INTEGER size{};
+            if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0)
+            {
+                CloseHandle(file);
+                return false;
+            }
+            HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            CloseHandle(file); // The mapping keeps the file open
+            if (!mapping)
+            {
+                return false;
+            }
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping); // The view keeps the mapping alive
+            if (!view)
+            {
+                return false;
+            }
+            m_data = static_cast<const unsigned char*>(view);
+            m_size = static_cast<size_t>(size.QuadPart);
+#else
+            int file = ::open(path.c_str(), O_RDONLY);
+            if (file < 0)
+            {
+                return false;
+            }
+            struct stat info{};
+            if (::fstat(file, &info) != 0 || info.st_size <= 0)
+            {
+                ::close(file);
+                return false;
+            }
+            void* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+            ::close(file);
+            if (view == MAP_FAILED)
+            {
+                return false;
+            }
+            m_data = static_cast<const unsigned char*>(view);
+            m_size = static_cast<size_t>(info.st_size);
+#endif
+            return true;
+        }
+
+        void Close()
+        {
+            if (!m_data)
+            {
+                return;
+            }
+#ifdef _WIN32
+            UnmapViewOfFile(m_data);
+#else
+            ::munmap(const_cast<unsigned char*>(m_data), m_size);
+#endif
+            m_data = nullptr;
+            m_size = 0;
+        }
+
+        const unsigned char* Data() const { return m_data; }
+        size_t Size() const { return m_size; }
+
+    private:
+        const unsigned char* m_data = nullptr;
+        size_t m_size = 0;
+    };
+
+    // Fingerprint of the files that make up a game build: each file's name, size
+    // and modification time. Patches replace the executable or a pak, so any
+    // update changes the key; contents are not read, keeping this a few stat
+    // calls rather than hashing gigabytes of paks at startup.
+    inline uint64_t ComputeBuildKey(std::vector<std::filesystem::path> files)
+    {
+        std::sort(files.begin(), files.end());
+        uint64_t hash = Detail::FnvOffset;
+        for (const std::filesystem::path& file : files)
+        {
+            std::error_code ec;
+            std::wstring name = file.filename().wstring();
+            uint64_t size = std::filesystem::file_size(file, ec);
+            if (ec) size = UINT64_MAX;
+            int64_t time = std::filesystem::last_write_time(file, ec).time_since_epoch().count();
+            if (ec) time = 0;
+
+            hash = Detail::Fnv1a(name.data(), name.size() * sizeof(wchar_t), hash);
+            hash = Detail::Fnv1a(&size, sizeof(size), hash);
+            hash = Detail::Fnv1a(&time, sizeof(time), hash);
+        }
+        return hash;
+    }
+
+    // The executable plus every pak container under <Project>/Content/Paks, for an
+    // executable at <Project>/Binaries/<Platform>/<Game>.exe
+    inline std::vector<std::filesystem::path> GameBuildFiles(const std::filesystem::path& executable)
+    {
+        std::vector<std::filesystem::path> files{executable};
+        std::filesystem::path paks = executable.parent_path().parent_path().parent_path() / L"Content" / L"Paks";
+        std::error_code ec;
+        for (std::filesystem::recursive_directory_iterator it(paks, ec), end; !ec && it != end; it.increment(ec))
+        {
+            std::wstring extension = it->path().extension().wstring();
+            if (extension == L".pak" || extension == L".utoc" || extension == L".ucas")
+            {
+                files.push_back(it->path());
+            }
+        }
+        return files;
+    }
+
+    class DiscoveryCache
+    {
+    public:
+        static constexpr uint32_t Magic = 0x43425349; // "ISBC"
+        static constexpr uint16_t Version = 1;
+
+        struct Record
+        {
+            std::wstring_view Path; // Valid until the next Set or Load
+            uint32_t A = 0; // Meaning depends on the key (field offset, row count, ...)
+            uint32_t B = 0;
+        };
+
+        // Maps the file and accepts it only if it was written for buildKey and is
+        // intact. Loaded entries carry over to the next Save unless Set replaces them.
+        bool Load(const std::filesystem::path& path, uint64_t buildKey)
+        {
+            Close();
+            m_pending.clear();
+            m_dirty = false;
+            if (!m_file.Open(path))
+            {
+                return false;
+            }
+            if (!Validate(buildKey))
+            {
+                m_file.Close();
+                return false;
+            }
+
+            for (size_t i = 0; i < LoadedCount(); ++i)
+            {
+                const RawRecord& raw = m_records[i];
+                m_pending.push_back({std::wstring(String(raw.KeyOffset, raw.KeyLength)),
+                                     std::wstring(String(raw.PathOffset, raw.PathLength)), raw.A, raw.B});
+            }
+            return true;
+        }
+
+        // Drops the mapping. Loaded entries were copied out by Load, so lookups and
+        // Save keep working from them.
+        void Close()
+        {
+            m_file.Close();
+            m_header = nullptr;
+            m_records = nullptr;
+            m_strings = nullptr;
+        }
+
+        bool Loaded() const { return m_header != nullptr; }
+        size_t LoadedCount() const { return m_header ? m_header->RecordCount : 0; }
+
+        // Looks up what was loaded or Set since, so a result found this launch is
+        // reused before it is ever saved
+        bool Find(std::wstring_view key, Record& out) const
+        {
+            for (const Pending& entry : m_pending)
+            {
+                if (entry.Key == key)
+                {
+                    out = {entry.Path, entry.A, entry.B};
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Records a result for the next launch. Marks the cache dirty only if it
+        // doesn't already hold exactly this.
+        void Set(std::wstring_view key, std::wstring_view path, uint32_t a = 0, uint32_t b = 0)
+        {
+            auto existing = std::find_if(m_pending.begin(), m_pending.end(), [&](const Pending& entry) { return entry.Key == key; });
+            if (existing == m_pending.end())
+            {
+                m_pending.push_back({std::wstring(key), std::wstring(path), a, b});
+                m_dirty = true;
+            }
+            else if (existing->Path != path || existing->A != a || existing->B != b)
+            {
+                existing->Path = path;
+                existing->A = a;
+                existing->B = b;
+                m_dirty = true;
+            }
+        }
+
+        bool Dirty() const { return m_dirty; }
+
+        // Writes the pending entries to a temporary file and moves it over path.
+        // The mapping must be closed first on Windows, where a mapped file can't be replaced.
+        bool Save(const std::filesystem::path& path, uint64_t buildKey)
+        {
+            std::vector<RawRecord> records;
+            std::wstring strings;
+            for (const Pending& entry : m_pending)
+            {
+                RawRecord raw{};
+                raw.KeyOffset = static_cast<uint32_t>(strings.size());
+                raw.KeyLength = static_cast<uint16_t>(std::min<size_t>(entry.Key.size(), UINT16_MAX));
+                strings.append(entry.Key, 0, raw.KeyLength);
+                raw.PathOffset = static_cast<uint32_t>(strings.size());
+                raw.PathLength = static_cast<uint16_t>(std::min<size_t>(entry.Path.size(), UINT16_MAX));
+                strings.append(entry.Path, 0, raw.PathLength);
+                raw.A = entry.A;
+                raw.B = entry.B;
+                records.push_back(raw);
+            }
+
+            Header header{};
+            header.Magic = Magic;
+            header.Version = Version;
+            header.CharSize = sizeof(wchar_t);
+            header.BuildKey = buildKey;
+            header.RecordCount = static_cast<uint32_t>(records.size());
+            header.StringChars = static_cast<uint32_t>(strings.size());
+            header.Checksum = Detail::Fnv1a(records.data(), records.size() * sizeof(RawRecord));
+            header.Checksum = Detail::Fnv1a(strings.data(), strings.size() * sizeof(wchar_t), header.Checksum);
+
+            std::filesystem::path temporary = path;
+            temporary += L".tmp";
+            {
+                std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+                out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+                out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(RawRecord)));
+                out.write(reinterpret_cast<const char*>(strings.data()), static_cast<std::streamsize>(strings.size() * sizeof(wchar_t)));
+                if (!out.good())
+                {
+                    return false;
+                }
+            }
+
+            std::error_code ec;
+            std::filesystem::rename(temporary, path, ec);
+            if (ec)
+            {
+                std::filesystem::remove(temporary, ec);
+                return false;
+            }
+            m_dirty = false;
+            return true;
+        }
+
+    private:
+        struct Header
+        {
+            uint32_t Magic;
+            uint16_t Version;
+            uint16_t CharSize;
+            uint64_t BuildKey;
+            uint32_t RecordCount;
+            uint32_t StringChars;
+            uint64_t Checksum;
+        };
+        static_assert(sizeof(Header) == 32, "cache header layout is part of the file format");
+
+        struct RawRecord
+        {
+            uint32_t KeyOffset;
+            uint32_t PathOffset;
+            uint16_t KeyLength;
+            uint16_t PathLength;
+            uint32_t A;
+            uint32_t B;
+        };
+        static_assert(sizeof(RawRecord) == 20, "cache record layout is part of the file format");
+
+        struct Pending
+        {
+            std::wstring Key;
+            std::wstring Path;
+            uint32_t A = 0;
+            uint32_t B = 0;
+        };
+
+        bool Validate(uint64_t buildKey)
+        {
+            const unsigned char* data = m_file.Data();
+            size_t size = m_file.Size();
+            if (size < sizeof(Header))
+            {
+                return false;
+            }
+
+            const Header* header = reinterpret_cast<const Header*>(data);
+            if (header->Magic != Magic || header->Version != Version || header->CharSize != sizeof(wchar_t) ||
+                header->BuildKey != buildKey)
+            {
+                return false;
+            }
+
+            size_t recordBytes = static_cast<size_t>(header->RecordCount) * sizeof(RawRecord);
+            size_t stringBytes = static_cast<size_t>(header->StringChars) * sizeof(wchar_t);
+            if (size != sizeof(Header) + recordBytes + stringBytes)
+            {
+                return false;
+            }
+
+            const unsigned char* body = data + sizeof(Header);
+            if (Detail::Fnv1a(body, recordBytes + stringBytes) != header->Checksum)
+            {
+                return false;
+            }
+
+            const RawRecord* records = reinterpret_cast<const RawRecord*>(body);
+            for (uint32_t i = 0; i < header->RecordCount; ++i)
+            {
+                const RawRecord& raw = records[i];
+                if (static_cast<size_t>(raw.KeyOffset) + raw.KeyLength > header->StringChars ||
+                    static_cast<size_t>(raw.PathOffset) + raw.PathLength > header->StringChars)
+                {
+                    return false;
+                }
+            }
+
+            m_header = header;
+            m_records = records;
+            m_strings = reinterpret_cast<const wchar_t*>(body + recordBytes);
+            return true;
+        }
+
+        std::wstring_view String(uint32_t offset, uint16_t length) const
+        {
+            return std::wstring_view(m_strings + offset, length);
+        }
+
+        MappedFile m_file;
+        const Header* m_header = nullptr;
+        const RawRecord* m_records = nullptr;
+        const wchar_t* m_strings = nullptr;
+        std::vector<Pending> m_pending;
+        bool m_dirty = false;
+    };
+}
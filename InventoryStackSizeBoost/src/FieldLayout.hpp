@@ -0,0 +1,307 @@
+#pragma once
+
+/**
+ * FieldLayout - flat name -> (offset, size, type) table for one row struct
+ *
+ * Built once per UScriptStruct from reflection (see RowStructLayout.hpp) and
+ * then queried only when resolving accessors, never per row. Kept free of
+ * UE4SS types so the same table can be used by host-side tools.
+ *
+ * The fields the mod touches are declared once per row struct as RowField
+ * constants (type + offset the mod was compiled against). The declaration is
+ * checked for alignment and overlap at compile time, yields the expectations
+ * compared against reflection at startup, and resolves to a FieldAccessor of
+ * the declared type, so a patch loop cannot read a field as the wrong type.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace StackBoost
+{
+    enum class FieldType : uint8_t
+    {
+        Unknown,
+        Int8,
+        Int16,
+        Int32,
+        Int64,
+        UInt8,
+        UInt16,
+        UInt32,
+        UInt64,
+        Float,
+        Double,
+        Bool,
+        Name,
+        Struct,
+        Other,
+    };
+
+    inline const wchar_t* FieldTypeName(FieldType type)
+    {
+        switch (type)
+        {
+        case FieldType::Int8: return L"Int8";
+        case FieldType::Int16: return L"Int16";
+        case FieldType::Int32: return L"Int32";
+        case FieldType::Int64: return L"Int64";
+        case FieldType::UInt8: return L"UInt8";
+        case FieldType::UInt16: return L"UInt16";
+        case FieldType::UInt32: return L"UInt32";
+        case FieldType::UInt64: return L"UInt64";
+        case FieldType::Float: return L"Float";
+        case FieldType::Double: return L"Double";
+        case FieldType::Bool: return L"Bool";
+        case FieldType::Name: return L"Name";
+        case FieldType::Struct: return L"Struct";
+        case FieldType::Other: return L"Other";
+        default: return L"Unknown";
+        }
+    }
+
+    // Maps a reflected property class name (e.g. "IntProperty") to a FieldType
+    inline FieldType FieldTypeFromPropertyClass(std::wstring_view propertyClass)
+    {
+        if (propertyClass == L"IntProperty") return FieldType::Int32;
+        if (propertyClass == L"Int8Property") return FieldType::Int8;
+        if (propertyClass == L"Int16Property") return FieldType::Int16;
+        if (propertyClass == L"Int64Property") return FieldType::Int64;
+        if (propertyClass == L"ByteProperty" || propertyClass == L"EnumProperty") return FieldType::UInt8;
+        if (propertyClass == L"UInt16Property") return FieldType::UInt16;
+        if (propertyClass == L"UInt32Property") return FieldType::UInt32;
+        if (propertyClass == L"UInt64Property") return FieldType::UInt64;
+        if (propertyClass == L"FloatProperty") return FieldType::Float;
+        if (propertyClass == L"DoubleProperty") return FieldType::Double;
+        if (propertyClass == L"BoolProperty") return FieldType::Bool;
+        if (propertyClass == L"NameProperty") return FieldType::Name;
+        if (propertyClass == L"StructProperty") return FieldType::Struct;
+        return FieldType::Other;
+    }
+
+    struct FieldInfo
+    {
+        std::wstring Name;
+        uint32_t Offset = 0;
+        uint32_t Size = 0;
+        FieldType Type = FieldType::Unknown;
+
+        // Bool only, as FBoolProperty has them: the byte holding the value (from
+        // Offset), the bits that hold it there and the bits a true value sets. A
+        // native bool owns its byte; a bitfield bool (uint8 bFoo : 1) shares it.
+        uint8_t ByteOffset = 0;
+        uint8_t FieldMask = 0xFF;
+        uint8_t ByteMask = 1;
+
+        bool IsBitfield() const { return Type == FieldType::Bool && FieldMask != 0xFF; }
+    };
+
+    // A bool field's value, given its row or object
+    inline bool ReadBoolField(const FieldInfo& field, const unsigned char* data)
+    {
+        return (data[field.Offset + field.ByteOffset] & field.FieldMask) != 0;
+    }
+
+    // A field the mod was compiled against
+    struct FieldExpectation
+    {
+        const wchar_t* Name;
+        uint32_t Offset;
+        uint32_t Size;
+        FieldType Type;
+    };
+
+    enum class FieldCheck : uint8_t
+    {
+        Match,        // Found exactly where expected
+        Moved,        // Same type and size, different offset - usable via the resolved offset
+        Missing,      // Not present in the struct
+        TypeMismatch, // Present but with a different type or size - unsafe to touch
+    };
+
+    inline const wchar_t* FieldCheckName(FieldCheck check)
+    {
+        switch (check)
+        {
+        case FieldCheck::Match: return L"match";
+        case FieldCheck::Moved: return L"moved";
+        case FieldCheck::Missing: return L"missing";
+        default: return L"type mismatch";
+        }
+    }
+
+    // Exact FieldType of a C++ field type; Unknown for types a RowField cannot declare
+    template <typename T>
+    constexpr FieldType FieldTypeOf()
+    {
+        if constexpr (std::is_same_v<T, bool>) return FieldType::Bool;
+        else if constexpr (std::is_same_v<T, float>) return FieldType::Float;
+        else if constexpr (std::is_same_v<T, double>) return FieldType::Double;
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+            return sizeof(T) == 1 ? FieldType::Int8 : sizeof(T) == 2 ? FieldType::Int16 : sizeof(T) == 4 ? FieldType::Int32 : FieldType::Int64;
+        else if constexpr (std::is_integral_v<T>)
+            return sizeof(T) == 1 ? FieldType::UInt8 : sizeof(T) == 2 ? FieldType::UInt16 : sizeof(T) == 4 ? FieldType::UInt32 : FieldType::UInt64;
+        else return FieldType::Unknown;
+    }
+
+    template <typename T>
+    struct FieldAccessor;
+
+    // A field of a row struct as the mod was compiled against it:
+    //   constexpr RowField<int32_t, 0x5C> MaximumStack{L"MaximumStack"};
+    template <typename T, uint32_t DeclaredOffset>
+    struct RowField
+    {
+        static_assert(FieldTypeOf<T>() != FieldType::Unknown, "RowField type must be an integer, float, double or bool");
+        static_assert(DeclaredOffset % alignof(T) == 0, "RowField offset is not aligned for its type");
+
+        using Type = T;
+        static constexpr uint32_t Offset = DeclaredOffset;
+        static constexpr uint32_t Size = sizeof(T);
+
+        const wchar_t* Name;
+
+        constexpr FieldExpectation Expectation() const
+        {
+            return {Name, DeclaredOffset, static_cast<uint32_t>(sizeof(T)), FieldTypeOf<T>()};
+        }
+
+        // At the declared offset, for rows whose layout is known to match (host tables, tests)
+        static constexpr FieldAccessor<T> Declared()
+        {
+            return {DeclaredOffset, true};
+        }
+    };
+
+    // Expectation table for the startup check, in declaration order
+    template <typename... Fields>
+    constexpr std::array<FieldExpectation, sizeof...(Fields)> RowExpectations(const Fields&... fields)
+    {
+        return {fields.Expectation()...};
+    }
+
+    // For static_assert: no two declared fields share a byte
+    template <size_t N>
+    constexpr bool RowFieldsDisjoint(const std::array<FieldExpectation, N>& fields)
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            for (size_t j = i + 1; j < N; ++j)
+            {
+                if (fields[i].Offset < fields[j].Offset + fields[j].Size && fields[j].Offset < fields[i].Offset + fields[i].Size)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Typed view of one field, resolved once and applied to many rows
+    template <typename T>
+    struct FieldAccessor
+    {
+        size_t Offset = 0;
+        bool Valid = false;
+
+        constexpr bool IsValid() const { return Valid; }
+
+        T* Ptr(unsigned char* row) const
+        {
+            return reinterpret_cast<T*>(row + Offset);
+        }
+
+        T Get(const unsigned char* row) const
+        {
+            T value;
+            std::memcpy(&value, row + Offset, sizeof(T));
+            return value;
+        }
+
+        void Set(unsigned char* row, T value) const
+        {
+            std::memcpy(row + Offset, &value, sizeof(T));
+        }
+    };
+
+    template <typename T>
+    constexpr bool FieldTypeHolds(FieldType type)
+    {
+        if constexpr (std::is_same_v<T, bool>) return type == FieldType::Bool;
+        else if constexpr (std::is_same_v<T, float>) return type == FieldType::Float;
+        else if constexpr (std::is_same_v<T, double>) return type == FieldType::Double;
+        else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+            return type == FieldType::Int8 || type == FieldType::Int16 || type == FieldType::Int32 || type == FieldType::Int64;
+        else if constexpr (std::is_integral_v<T>)
+            return type == FieldType::UInt8 || type == FieldType::UInt16 || type == FieldType::UInt32 || type == FieldType::UInt64;
+        else return false;
+    }
+
+    class FieldLayout
+    {
+    public:
+        void Add(FieldInfo field)
+        {
+            m_fields.push_back(std::move(field));
+        }
+
+        const std::vector<FieldInfo>& Fields() const { return m_fields; }
+        bool Empty() const { return m_fields.empty(); }
+
+        const FieldInfo* Find(std::wstring_view name) const
+        {
+            for (const FieldInfo& field : m_fields)
+            {
+                if (field.Name == name)
+                {
+                    return &field;
+                }
+            }
+            return nullptr;
+        }
+
+        FieldCheck Check(const FieldExpectation& expected) const
+        {
+            const FieldInfo* field = Find(expected.Name);
+            if (!field)
+            {
+                return FieldCheck::Missing;
+            }
+            if (field->Type != expected.Type || field->Size != expected.Size || field->IsBitfield())
+            {
+                return FieldCheck::TypeMismatch; // A RowField<bool> is a whole byte
+            }
+            return field->Offset == expected.Offset ? FieldCheck::Match : FieldCheck::Moved;
+        }
+
+        // Returns an invalid accessor if the field is missing or cannot hold a T
+        template <typename T>
+        FieldAccessor<T> Accessor(std::wstring_view name) const
+        {
+            FieldAccessor<T> accessor;
+            const FieldInfo* field = Find(name);
+            if (field && field->Size == sizeof(T) && FieldTypeHolds<T>(field->Type) && !field->IsBitfield())
+            {
+                accessor.Offset = field->Offset;
+                accessor.Valid = true;
+            }
+            return accessor;
+        }
+
+        // Resolved at the reflected offset (a Moved field is still usable), typed by the declaration
+        template <typename T, uint32_t DeclaredOffset>
+        FieldAccessor<T> Accessor(const RowField<T, DeclaredOffset>& field) const
+        {
+            return Accessor<T>(field.Name);
+        }
+
+    private:
+        std::vector<FieldInfo> m_fields;
+    };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * FileWatcher - polls one file's modification time on a background thread
+ *
+ * The filesystem is touched solely by the watcher thread. A change calls
+ * onChange from the watcher thread, so the owner can schedule the reload
+ * instead of polling every frame. Creating, editing or deleting the file all
+ * count as a change.
+ */
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include "PeriodicWorker.hpp"
+
+namespace StackBoost
+{
+    class FileWatcher
+    {
+    public:
+        ~FileWatcher()
+        {
+            Stop();
+        }
+
+        void Start(std::filesystem::path path, std::chrono::milliseconds interval, std::function<void()> onChange = {})
+        {
+            Stop();
+            m_path = std::move(path);
+            m_onChange = std::move(onChange);
+            m_lastWrite = ReadWriteTime();
+            m_worker.Start(interval, [this] { Poll(); });
+        }
+
+        void Stop()
+        {
+            m_worker.Stop();
+        }
+
+        const std::filesystem::path& Path() const { return m_path; }
+
+    private:
+        std::filesystem::file_time_type ReadWriteTime() const
+        {
+            std::error_code ec;
+            auto time = std::filesystem::last_write_time(m_path, ec);
+            return ec ? std::filesystem::file_time_type::min() : time;
+        }
+
+        void Poll()
+        {
+            auto writeTime = ReadWriteTime();
+            if (writeTime == m_lastWrite)
+            {
+                return;
+            }
+            m_lastWrite = writeTime;
+            if (m_onChange)
+            {
+                m_onChange();
+            }
+        }
+
+        std::filesystem::path m_path;
+        std::function<void()> m_onChange;
+        std::filesystem::file_time_type m_lastWrite{}; // Watcher thread only after Start
+        PeriodicWorker m_worker;
+    };
+}
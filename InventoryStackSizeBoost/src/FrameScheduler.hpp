@@ -0,0 +1,253 @@
+#pragma once
+
+/**
+ * FrameScheduler - coalesces bursty work into at most one run per frame
+ *
+ * Work is posted as (target, action): an action is registered once with a
+ * callback and a minimum interval, the target is whatever object it applies
+ * to (or null). Posting a pair that is already queued does nothing, so an
+ * event that fires twenty times during a bulk transfer runs its handler once,
+ * on the next frame. With an interval, posts that arrive while the pair is
+ * cooling down are merged into one trailing run when the interval ends;
+ * nothing is dropped, only deferred.
+ *
+ * By default, posts made by an action for its own (target, action) while it
+ * runs are ignored, which breaks "handler triggers the event that posts the
+ * handler" loops without a separate recursion flag. Actions that poll (retry
+ * until something loads) register with ReentrantPost::Queue instead and
+ * re-post themselves for the next frame, or with PostAt for a later time
+ * (e.g. the next retry), so an action waiting on a timer costs nothing in
+ * the frames before it.
+ *
+ * Post may be called from any thread. RunFrame runs on the game thread once
+ * per frame, executes callbacks outside the lock, and costs one atomic load
+ * when nothing is queued (HasDue: two, when nothing is due yet).
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace StackBoost
+{
+    class FrameScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        using ActionId = uint32_t;
+        static constexpr ActionId InvalidAction = UINT32_MAX;
+
+        // What a post for the running (target, action) from inside its own callback does
+        enum class ReentrantPost : uint8_t
+        {
+            Ignore, // Dropped: the run in progress already covers it
+            Queue,  // Queued for the next frame like any other post
+        };
+
+        struct Counters
+        {
+            uint64_t Posted = 0;     // Posts that queued a run
+            uint64_t Merged = 0;     // Posts absorbed by an already queued run
+            uint64_t Suppressed = 0; // Posts made by the action itself while running
+            uint64_t Runs = 0;
+        };
+
+        // Register actions before posting; ids are indices and never change
+        ActionId RegisterAction(std::wstring name, std::chrono::milliseconds interval, std::function<void(void* target)> run,
+                                ReentrantPost reentrant = ReentrantPost::Ignore)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_actions.push_back({std::move(name), interval, std::move(run), reentrant});
+            return static_cast<ActionId>(m_actions.size() - 1);
+        }
+
+        ActionId FindAction(std::wstring_view name) const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (size_t i = 0; i < m_actions.size(); ++i)
+            {
+                if (m_actions[i].Name == name) return static_cast<ActionId>(i);
+            }
+            return InvalidAction;
+        }
+
+        // Returns true if this post queued a run, false if it was merged or suppressed
+        bool Post(ActionId action, void* target = nullptr, Clock::time_point now = Clock::now())
+        {
+            return PostAt(action, now, target);
+        }
+
+        // Same, but the run waits until due. A pair that is already queued keeps
+        // whichever of its run and this one comes first.
+        bool PostAt(ActionId action, Clock::time_point due, void* target = nullptr)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (action >= m_actions.size())
+            {
+                return false;
+            }
+            if (m_runningAction == action && m_runningTarget == target && m_actions[action].Reentrant == ReentrantPost::Ignore)
+            {
+                m_counters.Suppressed++;
+                return false;
+            }
+
+            auto item = std::find_if(m_items.begin(), m_items.end(),
+                                     [&](const Item& entry) { return entry.Action == action && entry.Target == target; });
+            if (item != m_items.end() && item->Queued)
+            {
+                item->Due = std::min(item->Due, std::max(due, item->CoolUntil));
+                LowerEarliestDue(item->Due);
+                m_counters.Merged++;
+                return false;
+            }
+
+            if (item == m_items.end())
+            {
+                m_items.push_back({target, action, due, Clock::time_point::min(), true});
+                LowerEarliestDue(due);
+            }
+            else
+            {
+                // Cooling down from a recent run: one trailing run when it ends
+                item->Queued = true;
+                item->Due = std::max(due, item->CoolUntil);
+                LowerEarliestDue(item->Due);
+            }
+            m_counters.Posted++;
+            m_queued.fetch_add(1, std::memory_order_release);
+            return true;
+        }
+
+        // Runs every queued item that is due. Returns the number of callbacks run.
+        size_t RunFrame(Clock::time_point now = Clock::now())
+        {
+            if (!HasDue(now))
+            {
+                return 0;
+            }
+
+            // A callback that re-enters the engine can land back here; the outer call finishes the frame
+            bool expected = false;
+            if (!m_inFrame.compare_exchange_strong(expected, true, std::memory_order_acquire))
+            {
+                return 0;
+            }
+
+            m_due.clear();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                Clock::time_point earliest = Clock::time_point::max();
+                for (Item& item : m_items)
+                {
+                    if (item.Queued && item.Due <= now)
+                    {
+                        item.Queued = false;
+                        item.CoolUntil = now + m_actions[item.Action].Interval;
+                        m_due.push_back({item.Target, item.Action});
+                        m_queued.fetch_sub(1, std::memory_order_relaxed);
+                    }
+                    else if (item.Queued)
+                    {
+                        earliest = std::min(earliest, item.Due);
+                    }
+                }
+                m_earliestDue.store(earliest.time_since_epoch().count(), std::memory_order_relaxed);
+                // Idle pairs past their cooldown need no record
+                m_items.erase(std::remove_if(m_items.begin(), m_items.end(),
+                                             [&](const Item& item) { return !item.Queued && item.CoolUntil <= now; }),
+                              m_items.end());
+            }
+
+            for (const Due& due : m_due)
+            {
+                std::function<void(void*)>* run;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_runningAction = due.Action;
+                    m_runningTarget = due.Target;
+                    m_counters.Runs++;
+                    run = &m_actions[due.Action].Run;
+                }
+                (*run)(due.Target);
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_runningAction = InvalidAction;
+                m_runningTarget = nullptr;
+            }
+            m_inFrame.store(false, std::memory_order_release);
+            return m_due.size();
+        }
+
+        bool HasQueued() const
+        {
+            return m_queued.load(std::memory_order_relaxed) != 0;
+        }
+
+        // Whether RunFrame(now) would run anything
+        bool HasDue(Clock::time_point now = Clock::now()) const
+        {
+            return m_queued.load(std::memory_order_acquire) != 0 &&
+                   now.time_since_epoch().count() >= m_earliestDue.load(std::memory_order_relaxed);
+        }
+
+        Counters GetCounters() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_counters;
+        }
+
+    private:
+        // Under m_mutex
+        void LowerEarliestDue(Clock::time_point due)
+        {
+            if (due.time_since_epoch().count() < m_earliestDue.load(std::memory_order_relaxed))
+            {
+                m_earliestDue.store(due.time_since_epoch().count(), std::memory_order_relaxed);
+            }
+        }
+
+        struct Action
+        {
+            std::wstring Name;
+            std::chrono::milliseconds Interval;
+            std::function<void(void*)> Run;
+            ReentrantPost Reentrant;
+        };
+
+        struct Item
+        {
+            void* Target;
+            ActionId Action;
+            Clock::time_point Due;
+            Clock::time_point CoolUntil;
+            bool Queued;
+        };
+
+        struct Due
+        {
+            void* Target;
+            ActionId Action;
+        };
+
+        mutable std::mutex m_mutex;
+        std::vector<Action> m_actions;
+        std::vector<Item> m_items; // Queued or cooling down
+        std::vector<Due> m_due;    // Game thread only
+        ActionId m_runningAction = InvalidAction;
+        void* m_runningTarget = nullptr;
+        Counters m_counters;
+        std::atomic<size_t> m_queued{0};
+        std::atomic<Clock::rep> m_earliestDue{Clock::time_point::max().time_since_epoch().count()}; // Of the queued items
+        std::atomic<bool> m_inFrame{false};
+    };
+}
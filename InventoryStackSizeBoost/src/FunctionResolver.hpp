@@ -0,0 +1,180 @@
+#pragma once
+
+/**
+ * FunctionResolver - single-pass lookup of hook target UFunctions
+ *
+ * Hook targets are declared up front as (owner class, function name) pairs.
+ * Both names are interned as FNames when declared, so a resolve pass scans
+ * the object array once and matches every candidate by class pointer and
+ * FName comparison only - no GetName()/GetFullName() strings are built.
+ * Adding targets does not add walks. The scan runs on several threads and
+ * stops once every target has matched. Each target keeps its lowest-index
+ * match, as a serial walk would, and is resolved and reported on the calling
+ * thread afterwards.
+ */
+
+#include <array>
+#include <cstddef>
+#include <Unreal/UObjectGlobals.hpp>
+#include <Unreal/UObject.hpp>
+#include <Unreal/NameTypes.hpp>
+#include "ObjectArrayScan.hpp"
+
+namespace StackBoost
+{
+    using namespace RC;
+    using namespace RC::Unreal;
+
+    class FunctionResolver
+    {
+    public:
+        static constexpr size_t MaxTargets = 16;
+        static constexpr size_t InvalidTarget = static_cast<size_t>(-1);
+
+        // Declares a target. ownerClass is the class FName without its U/A prefix
+        // (e.g. "BeltTDInventoryInstance"). Must be called after FNames are available.
+        size_t Add(const CharType* ownerClass, const CharType* functionName)
+        {
+            if (m_targetCount >= MaxTargets)
+            {
+                return InvalidTarget;
+            }
+
+            Target& target = m_targets[m_targetCount];
+            target.Owner = FName(ownerClass, FNAME_Add);
+            target.Function = FName(functionName, FNAME_Add);
+            target.Resolved = nullptr;
+            return m_targetCount++;
+        }
+
+        // Walks the object array once, matching all unresolved targets.
+        // onResolved(size_t target, UFunction* function) is called as each target resolves.
+        // Returns the number of targets resolved by this pass.
+        template <typename Callback>
+        size_t Resolve(Callback&& onResolved)
+        {
+            if (AllResolved())
+            {
+                return 0;
+            }
+
+            if (!FunctionClass())
+            {
+                return 0;
+            }
+
+            FirstMatchSet<MaxTargets> matches(m_targetCount);
+            for (size_t i = 0; i < m_targetCount; ++i)
+            {
+                if (m_targets[i].Resolved) matches.Exclude(i);
+            }
+
+            ScanObjectArray([&](UObject* object, size_t index) {
+                if (object->GetClassPrivate() != m_functionClass)
+                {
+                    return false;
+                }
+
+                FName functionName = object->GetNamePrivate();
+                bool allFound = false;
+                for (size_t i = 0; i < m_targetCount; ++i)
+                {
+                    const Target& target = m_targets[i];
+                    if (target.Resolved || target.Function != functionName)
+                    {
+                        continue;
+                    }
+
+                    // A UFunction's outer is the class that declares it
+                    UObject* owner = object->GetOuterPrivate();
+                    if (owner && owner->GetNamePrivate() == target.Owner)
+                    {
+                        allFound = matches.Record(i, index);
+                    }
+                }
+                return allFound;
+            });
+
+            size_t resolvedThisPass = 0;
+            for (size_t i = 0; i < m_targetCount; ++i)
+            {
+                Target& target = m_targets[i];
+                UObject* object = target.Resolved || !matches.Found(i) ? nullptr : ObjectAtIndex(matches.Get(i));
+                if (!object)
+                {
+                    continue;
+                }
+                target.Resolved = static_cast<UFunction*>(object);
+                ++m_resolvedCount;
+                ++resolvedThisPass;
+                onResolved(i, target.Resolved);
+            }
+
+            return resolvedThisPass;
+        }
+
+        // Resolves a target from an object found some other way (e.g. StaticFindObject
+        // on a cached path) after checking it is that function of that class.
+        // Returns true if the target is resolved afterwards.
+        template <typename Callback>
+        bool Offer(size_t target, UObject* object, Callback&& onResolved)
+        {
+            if (target >= m_targetCount)
+            {
+                return false;
+            }
+            Target& entry = m_targets[target];
+            if (entry.Resolved)
+            {
+                return true;
+            }
+            if (!object || !FunctionClass() || object->GetClassPrivate() != m_functionClass ||
+                object->GetNamePrivate() != entry.Function)
+            {
+                return false;
+            }
+            UObject* owner = object->GetOuterPrivate();
+            if (!owner || owner->GetNamePrivate() != entry.Owner)
+            {
+                return false;
+            }
+
+            entry.Resolved = static_cast<UFunction*>(object);
+            ++m_resolvedCount;
+            onResolved(target, entry.Resolved);
+            return true;
+        }
+
+        UFunction* Get(size_t target) const
+        {
+            return target < m_targetCount ? m_targets[target].Resolved : nullptr;
+        }
+
+        bool AllResolved() const
+        {
+            return m_resolvedCount == m_targetCount;
+        }
+
+    private:
+        UClass* FunctionClass()
+        {
+            if (!m_functionClass)
+            {
+                m_functionClass = UObjectGlobals::StaticFindObject<UClass*>(nullptr, nullptr, STR("/Script/CoreUObject.Function"));
+            }
+            return m_functionClass;
+        }
+
+        struct Target
+        {
+            FName Owner;
+            FName Function;
+            UFunction* Resolved = nullptr;
+        };
+
+        std::array<Target, MaxTargets> m_targets{};
+        size_t m_targetCount = 0;
+        size_t m_resolvedCount = 0;
+        UClass* m_functionClass = nullptr;
+    };
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+/**
+ * HookStats - call counts and latency histograms for hooks and callbacks
+ *
+ * Each instrumented entry point owns a HookStats with relaxed atomic counters
+ * and a log-linear latency histogram (four sub-buckets per power of two, so
+ * percentiles are within ~19% of the true value). Recording is a handful of
+ * uncontended atomic adds; nothing allocates or locks on the hot path.
+ * StatsRegistry formats a summary table on demand.
+ */
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace StackBoost
+{
+    class LatencyHistogram
+    {
+    public:
+        static constexpr size_t SubBuckets = 4;
+        static constexpr size_t BucketCount = 64 * SubBuckets;
+
+        void Record(uint64_t ns)
+        {
+            m_buckets[BucketFor(ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // Upper bound of the bucket holding the given percentile (0-100), in ns
+        uint64_t Percentile(double percentile) const
+        {
+            uint64_t total = 0;
+            std::array<uint64_t, BucketCount> counts;
+            for (size_t i = 0; i < BucketCount; ++i)
+            {
+                counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+                total += counts[i];
+            }
+            if (total == 0)
+            {
+                return 0;
+            }
+
+            uint64_t rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(total - 1)) + 1;
+            uint64_t seen = 0;
+            for (size_t i = 0; i < BucketCount; ++i)
+            {
+                seen += counts[i];
+                if (seen >= rank)
+                {
+                    return BucketUpperBound(i);
+                }
+            }
+            return BucketUpperBound(BucketCount - 1);
+        }
+
+        void Reset()
+        {
+            for (auto& bucket : m_buckets)
+            {
+                bucket.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        static size_t BucketFor(uint64_t ns)
+        {
+            if (ns < SubBuckets)
+            {
+                return static_cast<size_t>(ns);
+            }
+            unsigned magnitude = 63 - static_cast<unsigned>(std::countl_zero(ns));
+            size_t subBucket = static_cast<size_t>((ns >> (magnitude - 2)) & (SubBuckets - 1));
+            return (magnitude - 1) * SubBuckets + subBucket;
+        }
+
+        static uint64_t BucketUpperBound(size_t bucket)
+        {
+            if (bucket < SubBuckets)
+            {
+                return bucket;
+            }
+            size_t magnitude = bucket / SubBuckets + 1;
+            uint64_t subBucket = bucket % SubBuckets;
+            if (magnitude >= 63)
+            {
+                return UINT64_MAX;
+            }
+            return ((SubBuckets + subBucket + 1) << (magnitude - 2)) - 1;
+        }
+
+    private:
+        std::array<std::atomic<uint64_t>, BucketCount> m_buckets{};
+    };
+
+    class HookStats
+    {
+    public:
+        explicit HookStats(const wchar_t* name) : m_name(name) {}
+
+        void Record(uint64_t ns, uint64_t rowsTouched = 0)
+        {
+            m_calls.fetch_add(1, std::memory_order_relaxed);
+            m_totalNs.fetch_add(ns, std::memory_order_relaxed);
+            if (rowsTouched)
+            {
+                m_rowsTouched.fetch_add(rowsTouched, std::memory_order_relaxed);
+            }
+            uint64_t max = m_maxNs.load(std::memory_order_relaxed);
+            while (ns > max && !m_maxNs.compare_exchange_weak(max, ns, std::memory_order_relaxed))
+            {
+            }
+            m_histogram.Record(ns);
+        }
+
+        // For work measured elsewhere (e.g. rows touched between a pre and post hook)
+        void AddRowsTouched(uint64_t rows)
+        {
+            m_rowsTouched.fetch_add(rows, std::memory_order_relaxed);
+        }
+
+        void Reset()
+        {
+            m_calls.store(0, std::memory_order_relaxed);
+            m_totalNs.store(0, std::memory_order_relaxed);
+            m_maxNs.store(0, std::memory_order_relaxed);
+            m_rowsTouched.store(0, std::memory_order_relaxed);
+            m_histogram.Reset();
+        }
+
+        const wchar_t* Name() const { return m_name; }
+        uint64_t Calls() const { return m_calls.load(std::memory_order_relaxed); }
+        uint64_t TotalNs() const { return m_totalNs.load(std::memory_order_relaxed); }
+        uint64_t MaxNs() const { return m_maxNs.load(std::memory_order_relaxed); }
+        uint64_t RowsTouched() const { return m_rowsTouched.load(std::memory_order_relaxed); }
+        const LatencyHistogram& Histogram() const { return m_histogram; }
+
+    private:
+        const wchar_t* m_name;
+        std::atomic<uint64_t> m_calls{0};
+        std::atomic<uint64_t> m_totalNs{0};
+        std::atomic<uint64_t> m_maxNs{0};
+        std::atomic<uint64_t> m_rowsTouched{0};
+        LatencyHistogram m_histogram;
+    };
+
+    // Times a scope into a HookStats; rows can be added before it closes
+    class ScopedHookTimer
+    {
+    public:
+        explicit ScopedHookTimer(HookStats& stats) : m_stats(stats), m_start(std::chrono::steady_clock::now()) {}
+
+        ~ScopedHookTimer()
+        {
+            auto elapsed = std::chrono::steady_clock::now() - m_start;
+            m_stats.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()), m_rowsTouched);
+        }
+
+        ScopedHookTimer(const ScopedHookTimer&) = delete;
+        ScopedHookTimer& operator=(const ScopedHookTimer&) = delete;
+
+        void SetRowsTouched(uint64_t rows) { m_rowsTouched = rows; }
+
+    private:
+        HookStats& m_stats;
+        std::chrono::steady_clock::time_point m_start;
+        uint64_t m_rowsTouched = 0;
+    };
+
+    class StatsRegistry
+    {
+    public:
+        void Add(HookStats& stats)
+        {
+            m_stats.push_back(&stats);
+        }
+
+        // Fixed-width table, one row per registered entry point
+        std::wstring FormatSummary() const
+        {
+            std::wstring out;
+            wchar_t line[256];
+            std::swprintf(line, 256, L"%-36ls %12ls %12ls %10ls %10ls %10ls %10ls %12ls\n", L"hook", L"calls", L"total_ms",
+                          L"p50_us", L"p99_us", L"max_us", L"mean_us", L"rows/call");
+            out += line;
+
+            for (const HookStats* stats : m_stats)
+            {
+                uint64_t calls = stats->Calls();
+                double totalUs = static_cast<double>(stats->TotalNs()) / 1000.0;
+                std::swprintf(line, 256, L"%-36ls %12llu %12.3f %10.2f %10.2f %10.2f %10.2f %12.2f\n", stats->Name(),
+                              static_cast<unsigned long long>(calls), totalUs / 1000.0,
+                              static_cast<double>(stats->Histogram().Percentile(50)) / 1000.0,
+                              static_cast<double>(stats->Histogram().Percentile(99)) / 1000.0,
+                              static_cast<double>(stats->MaxNs()) / 1000.0, calls ? totalUs / static_cast<double>(calls) : 0.0,
+                              calls ? static_cast<double>(stats->RowsTouched()) / static_cast<double>(calls) : 0.0);
+                out += line;
+            }
+            return out;
+        }
+
+        void ResetAll()
+        {
+            for (HookStats* stats : m_stats)
+            {
+                stats->Reset();
+            }
+        }
+
+    private:
+        std::vector<HookStats*> m_stats;
+    };
+}
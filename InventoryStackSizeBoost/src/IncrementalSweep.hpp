@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+ * IncrementalSweep - a long sweep split into batches under a per-frame budget
+ *
+ * Start() sets up a sweep over [0, total); RunFrame() then runs batches of
+ * BatchSize items in order until the frame's time budget is used up, and
+ * picks up where it stopped on the next call. At least one batch runs per
+ * call, so a sweep always finishes, however small the budget. A budget of
+ * zero runs the whole sweep in one call.
+ *
+ * The clock is read once per batch, not per item. The sweep itself holds no
+ * lock and knows nothing about what it walks: the caller runs it from one
+ * thread (a frame action) and keeps everyone else off the data until it is
+ * done.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace StackBoost
+{
+    class IncrementalSweep
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+        static constexpr size_t DefaultBatchSize = 64;
+
+        struct Progress
+        {
+            size_t Done = 0;
+            size_t Total = 0;
+            uint32_t Frames = 0; // RunFrame calls so far
+            std::chrono::microseconds Busy{0}; // Time spent in batches so far
+        };
+
+        void Start(size_t total, size_t batchSize = DefaultBatchSize)
+        {
+            m_progress = {0, total, 0, std::chrono::microseconds(0)};
+            m_batchSize = std::max<size_t>(batchSize, 1);
+            m_active = true;
+        }
+
+        void Cancel()
+        {
+            m_active = false;
+        }
+
+        bool Active() const { return m_active; }
+        const Progress& GetProgress() const { return m_progress; }
+
+        // step(size_t begin, size_t end) handles one batch. Returns true once the
+        // sweep is done (and then leaves it inactive).
+        template <typename Step>
+        bool RunFrame(std::chrono::microseconds budget, Step&& step)
+        {
+            return RunFrame(budget, step, [] { return Clock::now(); });
+        }
+
+        // now() -> Clock::time_point, for tests
+        template <typename Step, typename Now>
+        bool RunFrame(std::chrono::microseconds budget, Step&& step, Now&& now)
+        {
+            if (!m_active)
+            {
+                return true;
+            }
+            m_progress.Frames++;
+            if (m_progress.Total == 0)
+            {
+                m_active = false;
+                return true;
+            }
+            Clock::time_point start = now();
+            Clock::time_point end = start;
+            do
+            {
+                size_t begin = m_progress.Done;
+                size_t last = std::min(begin + m_batchSize, m_progress.Total);
+                step(begin, last);
+                m_progress.Done = last;
+                end = now();
+            } while (m_progress.Done < m_progress.Total && (budget.count() == 0 || end - start < budget));
+
+            m_progress.Busy += std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+            m_active = m_progress.Done < m_progress.Total;
+            return !m_active;
+        }
+
+    private:
+        Progress m_progress;
+        size_t m_batchSize = DefaultBatchSize;
+        bool m_active = false;
+    };
+}
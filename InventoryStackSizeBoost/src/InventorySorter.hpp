@@ -0,0 +1,152 @@
+#pragma once
+
+/**
+ * InventorySorter - keeps an inventory's slots sorted with minimal work per update
+ *
+ * Each slot is reduced to a 64-bit sort key (item order, empty slots last).
+ * The sorter remembers the keys as it last left them, sorted. On an update
+ * only slots whose key differs from that are "changed"; everything else is
+ * still in sorted order, so the new arrangement is the changed slots sorted
+ * among themselves (k log k) and merged into the unchanged run (n), instead
+ * of a full re-sort.
+ *
+ * The result is a permutation (slot i takes the contents of slot Source()[i]).
+ * ApplySlotPermutation writes it back by following cycles, touching only the
+ * slots that actually move, with one scratch slot per cycle.
+ *
+ * Ties keep the current slot order, so a sorted inventory never moves.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace StackBoost
+{
+    constexpr uint64_t EmptySlotKey = UINT64_MAX;
+
+    struct SlotSortResult
+    {
+        size_t Changed = 0; // Slots whose key differed from the last sorted state
+        size_t Moved = 0;   // Slots that must take another slot's contents
+        bool Full = false;  // No usable previous state; every slot was sorted
+    };
+
+    class IncrementalSlotSorter
+    {
+    public:
+        SlotSortResult Update(const uint64_t* keys, size_t count)
+        {
+            SlotSortResult result;
+            m_changed.clear();
+            m_unchanged.clear();
+
+            result.Full = m_known.size() != count;
+            for (size_t i = 0; i < count && !result.Full; ++i)
+            {
+                if (keys[i] != m_known[i])
+                {
+                    m_changed.push_back(static_cast<uint32_t>(i));
+                }
+                else
+                {
+                    // The unchanged slots must still be in order for the merge to be valid
+                    if (!m_unchanged.empty() && Less(keys, static_cast<uint32_t>(i), m_unchanged.back()))
+                    {
+                        result.Full = true;
+                    }
+                    m_unchanged.push_back(static_cast<uint32_t>(i));
+                }
+            }
+
+            if (result.Full)
+            {
+                m_changed.resize(count);
+                for (size_t i = 0; i < count; ++i)
+                {
+                    m_changed[i] = static_cast<uint32_t>(i);
+                }
+                m_unchanged.clear();
+            }
+            result.Changed = m_changed.size();
+
+            m_source.resize(count);
+            if (m_changed.empty())
+            {
+                for (size_t i = 0; i < count; ++i)
+                {
+                    m_source[i] = static_cast<uint32_t>(i);
+                }
+            }
+            else
+            {
+                auto less = [keys](uint32_t a, uint32_t b) { return Less(keys, a, b); };
+                std::sort(m_changed.begin(), m_changed.end(), less);
+                std::merge(m_unchanged.begin(), m_unchanged.end(), m_changed.begin(), m_changed.end(), m_source.begin(), less);
+            }
+
+            m_known.resize(count);
+            for (size_t i = 0; i < count; ++i)
+            {
+                m_known[i] = keys[m_source[i]];
+                result.Moved += m_source[i] != i;
+            }
+            return result;
+        }
+
+        // Slot i takes the contents of slot Source()[i]
+        const std::vector<uint32_t>& Source() const { return m_source; }
+
+        // Forget the last state (different inventory, or slots changed behind our back)
+        void Reset()
+        {
+            m_known.clear();
+        }
+
+    private:
+        static bool Less(const uint64_t* keys, uint32_t a, uint32_t b)
+        {
+            return keys[a] != keys[b] ? keys[a] < keys[b] : a < b;
+        }
+
+        std::vector<uint64_t> m_known; // Keys as the last update left them
+        std::vector<uint32_t> m_changed;
+        std::vector<uint32_t> m_unchanged;
+        std::vector<uint32_t> m_source;
+    };
+
+    // Reorders stride-sized slots in place so slot i holds what slot source[i] held.
+    // Slots are relocated bytewise, which is how the engine moves array elements too.
+    // Returns the number of slot writes.
+    inline size_t ApplySlotPermutation(unsigned char* slots, size_t stride, const std::vector<uint32_t>& source,
+                                       std::vector<unsigned char>& scratch, std::vector<uint8_t>& placed)
+    {
+        scratch.resize(stride);
+        placed.assign(source.size(), 0);
+
+        size_t writes = 0;
+        for (size_t start = 0; start < source.size(); ++start)
+        {
+            if (placed[start] || source[start] == start)
+            {
+                continue;
+            }
+
+            std::memcpy(scratch.data(), slots + start * stride, stride);
+            size_t slot = start;
+            while (source[slot] != start)
+            {
+                std::memcpy(slots + slot * stride, slots + source[slot] * stride, stride);
+                placed[slot] = 1;
+                slot = source[slot];
+                ++writes;
+            }
+            std::memcpy(slots + slot * stride, scratch.data(), stride);
+            placed[slot] = 1;
+            ++writes;
+        }
+        return writes;
+    }
+}
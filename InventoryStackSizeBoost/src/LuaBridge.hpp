@@ -0,0 +1,182 @@
+#pragma once
+
+/**
+ * LuaBridge - the state behind the native functions Lua mods call
+ *
+ * Lua mods run on their own threads (the main Lua state, async keybinds,
+ * ExecuteInGameThread callbacks), so both pieces here take a lock and do no
+ * game work themselves:
+ *
+ * KeyedRequestQueue holds the batched patch/revert requests until the game
+ * thread drains them at the start of the next frame. Requests are keyed by the
+ * caller's patch name; a newer request for a name replaces one still pending,
+ * so a mod that re-sends its patch on every event costs one apply per frame.
+ *
+ * ObjectLookupCache remembers where an object path was found. A hit is only
+ * returned if the caller's check still accepts the object at its recorded
+ * object-array index (it may have been collected and the slot reused); a
+ * failed check or a miss falls through to the real lookup. Paths that are not
+ * found are not remembered, as the object may simply not be loaded yet.
+ *
+ * Utf8ToWide converts the UTF-8 strings Lua passes in (names, object paths,
+ * patch text) to the engine's wide strings.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace StackBoost
+{
+    // UTF-16 where wchar_t is 16 bits (Windows), UTF-32 elsewhere. Each byte of a
+    // malformed sequence (overlong, surrogate, truncated) becomes U+FFFD.
+    inline std::wstring Utf8ToWide(std::string_view text)
+    {
+        static constexpr uint32_t MinCodePoint[5] = {0, 0, 0x80, 0x800, 0x10000}; // Per sequence length
+
+        std::wstring wide;
+        wide.reserve(text.size());
+        for (size_t i = 0; i < text.size();)
+        {
+            unsigned char lead = static_cast<unsigned char>(text[i]);
+            size_t length = lead < 0x80 ? 1 : (lead >> 5) == 0x6 ? 2 : (lead >> 4) == 0xE ? 3 : (lead >> 3) == 0x1E ? 4 : 0;
+            uint32_t codePoint = length == 1 ? lead : lead & (0x7F >> length);
+            bool valid = length != 0 && i + length <= text.size();
+            for (size_t k = 1; valid && k < length; ++k)
+            {
+                unsigned char next = static_cast<unsigned char>(text[i + k]);
+                valid = (next & 0xC0) == 0x80;
+                codePoint = (codePoint << 6) | (next & 0x3F);
+            }
+            valid = valid && codePoint >= MinCodePoint[length] && codePoint <= 0x10FFFF && (codePoint < 0xD800 || codePoint > 0xDFFF);
+            if (!valid)
+            {
+                wide.push_back(static_cast<wchar_t>(0xFFFD));
+                ++i;
+                continue;
+            }
+
+            i += length;
+            if (sizeof(wchar_t) == 2 && codePoint >= 0x10000)
+            {
+                codePoint -= 0x10000;
+                wide.push_back(static_cast<wchar_t>(0xD800 + (codePoint >> 10)));
+                wide.push_back(static_cast<wchar_t>(0xDC00 + (codePoint & 0x3FF)));
+            }
+            else
+            {
+                wide.push_back(static_cast<wchar_t>(codePoint));
+            }
+        }
+        return wide;
+    }
+
+    template <typename Request>
+    class KeyedRequestQueue
+    {
+    public:
+        // Returns false if a pending request for the key was replaced instead
+        bool Push(std::wstring key, Request request)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (std::pair<std::wstring, Request>& pending : m_pending)
+            {
+                if (pending.first == key)
+                {
+                    pending.second = std::move(request);
+                    m_replaced++;
+                    return false;
+                }
+            }
+            m_pending.emplace_back(std::move(key), std::move(request));
+            return true;
+        }
+
+        // Requests in the order their keys were first queued
+        std::vector<std::pair<std::wstring, Request>> Drain()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return std::exchange(m_pending, {});
+        }
+
+        size_t Replaced() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_replaced;
+        }
+
+    private:
+        mutable std::mutex m_mutex;
+        std::vector<std::pair<std::wstring, Request>> m_pending;
+        size_t m_replaced = 0;
+    };
+
+    template <typename Object>
+    class ObjectLookupCache
+    {
+    public:
+        struct Counters
+        {
+            uint64_t Hits = 0;
+            uint64_t Misses = 0;
+            uint64_t Stale = 0; // Remembered objects the check rejected
+        };
+
+        // isAlive(Object*, uint32_t index) -> bool validates a remembered object;
+        // find(const std::wstring&, uint32_t& index) -> Object* is the real lookup.
+        // find runs under the cache lock.
+        template <typename IsAlive, typename Find>
+        Object* Get(const std::wstring& path, IsAlive&& isAlive, Find&& find)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto entry = m_entries.find(path);
+            if (entry != m_entries.end())
+            {
+                if (isAlive(entry->second.Pointer, entry->second.Index))
+                {
+                    m_counters.Hits++;
+                    return entry->second.Pointer;
+                }
+                m_counters.Stale++;
+                m_entries.erase(entry);
+            }
+
+            m_counters.Misses++;
+            uint32_t index = 0;
+            Object* object = find(path, index);
+            if (object)
+            {
+                m_entries.emplace(path, Entry{object, index});
+            }
+            return object;
+        }
+
+        void Clear()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_entries.clear();
+        }
+
+        Counters GetCounters() const
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            return m_counters;
+        }
+
+    private:
+        struct Entry
+        {
+            Object* Pointer;
+            uint32_t Index;
+        };
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<std::wstring, Entry> m_entries;
+        Counters m_counters;
+    };
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+/**
+ * ModPaths - locates the mod's own folder on disk
+ *
+ * UE4SS loads the mod from Mods/<ModName>/dlls/main.dll; files the mod writes
+ * (stats dumps and the like) go in Mods/<ModName>/ next to enabled.txt. The
+ * game executable is located too, to fingerprint the installed build.
+ * Windows only: included by dllmain.cpp, not by the host build.
+ */
+
+#include <filesystem>
+#include <Windows.h>
+
+namespace StackBoost
+{
+    // Folder containing the DLL's dlls/ directory, or empty if it can't be determined
+    inline std::filesystem::path ModDirectory()
+    {
+        static const int anchor = 0;
+
+        HMODULE module = nullptr;
+        if (!GetModuleHandleExW(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS | GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                                reinterpret_cast<LPCWSTR>(&anchor), &module))
+        {
+            return {};
+        }
+
+        wchar_t modulePath[MAX_PATH];
+        DWORD length = GetModuleFileNameW(module, modulePath, MAX_PATH);
+        if (length == 0 || length == MAX_PATH)
+        {
+            return {};
+        }
+
+        // <mod>/dlls/main.dll -> <mod>
+        return std::filesystem::path(modulePath).parent_path().parent_path();
+    }
+
+    // The game's executable (the process image), or empty if it can't be determined
+    inline std::filesystem::path GameExecutablePath()
+    {
+        wchar_t executablePath[MAX_PATH];
+        DWORD length = GetModuleFileNameW(nullptr, executablePath, MAX_PATH);
+        if (length == 0 || length == MAX_PATH)
+        {
+            return {};
+        }
+        return std::filesystem::path(executablePath);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+/**
+ * ObjectArrayScan - ParallelScan over GUObjectArray
+ *
+ * For the full walks discovery still needs (first launch, cache miss). The
+ * caller blocks until the scan is done, so the game thread - and with it
+ * garbage collection - is held for the duration; objects constructed on the
+ * loading thread meanwhile may or may not be seen, as with ForEachUObject,
+ * and are reported by the construct callback anyway.
+ *
+ * visit(UObject*, size_t index) runs on several threads at once and must only
+ * compare pointers and FNames and publish results atomically.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <Unreal/UObject.hpp>
+#include <Unreal/UObjectArray.hpp>
+#include "ParallelScan.hpp"
+
+namespace StackBoost
+{
+    using namespace RC;
+    using namespace RC::Unreal;
+
+    // Returns true if visit stopped the scan early
+    template <typename Visit>
+    bool ScanObjectArray(Visit&& visit)
+    {
+        static const ParallelScan scan;
+        int32 count = UObjectArray::GetNumElements();
+        if (count <= 0)
+        {
+            return false;
+        }
+
+        std::atomic<bool> stopped{false};
+        scan.Run(static_cast<size_t>(count), [&](size_t begin, size_t end) {
+            for (size_t index = begin; index < end; ++index)
+            {
+                FUObjectItem* item = UObjectArray::IndexToObject(static_cast<int32>(index));
+                UObject* object = item ? item->GetUObject() : nullptr;
+                if (object && visit(object, index))
+                {
+                    stopped.store(true, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        });
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+    inline UObject* ObjectAtIndex(size_t index)
+    {
+        FUObjectItem* item = UObjectArray::IndexToObject(static_cast<int32>(index));
+        return item ? item->GetUObject() : nullptr;
+    }
+}
@@ -0,0 +1,192 @@
+#pragma once
+
+/**
+ * ObjectDiscovery - event-driven lookup of well-known UObjects
+ *
+ * Instead of polling FindAllOf() and comparing names as strings, callers
+ * register (class, FName) pairs up front. A StaticConstructObject post-callback
+ * then matches every newly constructed object against those pairs using only
+ * pointer and FName index comparisons, and publishes the first match.
+ * Objects that already exist when Start() is called are picked up by a single
+ * parallel scan of the object array (see ObjectArrayScan.hpp) that stops once
+ * every watch is satisfied, unless they were all supplied with Offer().
+ */
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <Unreal/UObjectGlobals.hpp>
+#include <Unreal/UObject.hpp>
+#include <Unreal/NameTypes.hpp>
+#include <Unreal/Hooks.hpp>
+#include "ObjectArrayScan.hpp"
+
+namespace StackBoost
+{
+    using namespace RC;
+    using namespace RC::Unreal;
+
+    class ObjectDiscovery
+    {
+    public:
+        static constexpr size_t MaxWatches = 8;
+        static constexpr size_t InvalidWatch = static_cast<size_t>(-1);
+
+        ObjectDiscovery() = default;
+        ObjectDiscovery(const ObjectDiscovery&) = delete;
+        ObjectDiscovery& operator=(const ObjectDiscovery&) = delete;
+
+        ~ObjectDiscovery()
+        {
+            // The construct callback outlives us (UE4SS has no per-callback removal
+            // on every version), so detach it from this instance instead.
+            ObjectDiscovery* self = this;
+            s_active.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+        }
+
+        // Registers an object to watch for. Must be called before Start().
+        // Returns a handle for Get(), or InvalidWatch if the class is unknown
+        // or the watch table is full.
+        size_t Watch(UClass* objectClass, FName objectName)
+        {
+            if (!objectClass || m_watchCount >= MaxWatches)
+            {
+                return InvalidWatch;
+            }
+
+            WatchEntry& entry = m_watches[m_watchCount];
+            entry.Class = objectClass;
+            entry.Name = objectName;
+            entry.Found.store(nullptr, std::memory_order_relaxed);
+            m_pending.fetch_add(1, std::memory_order_relaxed);
+            return m_watchCount++;
+        }
+
+        // Publishes object for a watch if it is the watched class and name, e.g. one
+        // fetched by its cached path. Call before Start(), which then skips the
+        // object-array walk when every watch has been satisfied this way.
+        bool Offer(size_t watch, UObject* object)
+        {
+            if (watch >= m_watchCount || !object)
+            {
+                return false;
+            }
+
+            WatchEntry& entry = m_watches[watch];
+            if (object->GetClassPrivate() != entry.Class || object->GetNamePrivate() != entry.Name)
+            {
+                return false;
+            }
+
+            UObject* expected = nullptr;
+            if (entry.Found.compare_exchange_strong(expected, object, std::memory_order_acq_rel))
+            {
+                m_pending.fetch_sub(1, std::memory_order_relaxed);
+            }
+            return true;
+        }
+
+        // Subscribes to object construction and resolves anything already loaded.
+        void Start()
+        {
+            s_active.store(this, std::memory_order_release);
+
+            static bool s_callbackRegistered = false;
+            if (!s_callbackRegistered)
+            {
+                s_callbackRegistered = true;
+                Hook::RegisterStaticConstructObjectPostCallback(
+                    [](const FStaticConstructObjectParameters&, UObject* constructedObject) -> UObject* {
+                        if (ObjectDiscovery* discovery = s_active.load(std::memory_order_acquire))
+                        {
+                            discovery->OnObjectConstructed(constructedObject);
+                        }
+                        return constructedObject;
+                    });
+            }
+
+            if (m_pending.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+
+            // OnObjectConstructed already publishes atomically, so it can run on every scan thread
+            ScanObjectArray([this](UObject* object, size_t) {
+                OnObjectConstructed(object);
+                return m_pending.load(std::memory_order_relaxed) == 0;
+            });
+        }
+
+        // Returns the discovered object for a watch, or nullptr if it has not appeared yet.
+        UObject* Get(size_t watch) const
+        {
+            if (watch >= m_watchCount)
+            {
+                return nullptr;
+            }
+            return m_watches[watch].Found.load(std::memory_order_acquire);
+        }
+
+        // Drops a result (e.g. the object was found to be unusable) so the next
+        // construction of a matching object is reported again.
+        void Reset(size_t watch)
+        {
+            if (watch >= m_watchCount)
+            {
+                return;
+            }
+            if (m_watches[watch].Found.exchange(nullptr, std::memory_order_acq_rel))
+            {
+                m_pending.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        bool HasPending() const
+        {
+            return m_pending.load(std::memory_order_relaxed) != 0;
+        }
+
+    private:
+        struct WatchEntry
+        {
+            UClass* Class = nullptr;
+            FName Name;
+            std::atomic<UObject*> Found{nullptr};
+        };
+
+        // May run on the async loading thread, so results are published atomically.
+        void OnObjectConstructed(UObject* object)
+        {
+            if (!object || m_pending.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+
+            UClass* objectClass = object->GetClassPrivate();
+            for (size_t i = 0; i < m_watchCount; ++i)
+            {
+                WatchEntry& entry = m_watches[i];
+                if (entry.Class != objectClass || entry.Found.load(std::memory_order_relaxed))
+                {
+                    continue;
+                }
+                if (object->GetNamePrivate() != entry.Name)
+                {
+                    continue;
+                }
+
+                UObject* expected = nullptr;
+                if (entry.Found.compare_exchange_strong(expected, object, std::memory_order_acq_rel))
+                {
+                    m_pending.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        std::array<WatchEntry, MaxWatches> m_watches{};
+        size_t m_watchCount = 0;
+        std::atomic<size_t> m_pending{0};
+
+        static inline std::atomic<ObjectDiscovery*> s_active{nullptr};
+    };
+}
@@ -0,0 +1,164 @@
+#pragma once
+
+/**
+ * ParallelScan - chunked scan of an index range on a few threads
+ *
+ * Run() splits [0, count) into fixed-size chunks that the calling thread and
+ * up to Workers() - 1 helper threads claim in increasing order from a shared
+ * cursor. A chunk callback returns true once the caller has what it wants;
+ * no new chunks are claimed after that, but chunks already started run to
+ * the end, so every index below the stopping chunk has been visited. With
+ * FirstMatchSet recording the lowest matching index per target, the result
+ * is the same as a serial walk that stops at its last first match.
+ *
+ * Helpers are started per Run and joined before it returns: scans happen a
+ * handful of times per session, and no thread outlives the call (nothing to
+ * shut down when the DLL is unloaded). No more helpers are started than there
+ * are chunks beyond the first, so a range of one chunk stays on the caller.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace StackBoost
+{
+    class ParallelScan
+    {
+    public:
+        static constexpr size_t DefaultChunkSize = 16384;
+        static constexpr size_t MaxWorkers = 8;
+
+        // workers == 0 picks one per hardware thread, up to MaxWorkers
+        explicit ParallelScan(size_t workers = 0, size_t chunkSize = DefaultChunkSize)
+            : m_workers(workers ? workers : DefaultWorkers()), m_chunkSize(std::max<size_t>(chunkSize, 1))
+        {
+        }
+
+        static size_t DefaultWorkers()
+        {
+            size_t hardware = std::thread::hardware_concurrency();
+            return std::clamp<size_t>(hardware, 1, MaxWorkers);
+        }
+
+        size_t Workers() const { return m_workers; }
+        size_t ChunkSize() const { return m_chunkSize; }
+
+        // scanChunk(size_t begin, size_t end) -> bool stop; must be safe to call concurrently.
+        // Returns the number of chunks scanned.
+        template <typename ScanChunk>
+        size_t Run(size_t count, ScanChunk&& scanChunk) const
+        {
+            size_t chunks = (count + m_chunkSize - 1) / m_chunkSize;
+            std::atomic<size_t> cursor{0};
+            std::atomic<bool> stop{false};
+            std::atomic<size_t> scanned{0};
+
+            auto work = [&] {
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    size_t chunk = cursor.fetch_add(1, std::memory_order_relaxed);
+                    if (chunk >= chunks)
+                    {
+                        return;
+                    }
+                    size_t begin = chunk * m_chunkSize;
+                    scanned.fetch_add(1, std::memory_order_relaxed);
+                    if (scanChunk(begin, std::min(begin + m_chunkSize, count)))
+                    {
+                        stop.store(true, std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            size_t helpers = std::min(m_workers, chunks) - (chunks > 0 ? 1 : 0);
+            std::vector<std::thread> threads;
+            threads.reserve(helpers);
+            for (size_t i = 0; i < helpers; ++i)
+            {
+                threads.emplace_back(work);
+            }
+            work();
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            return scanned.load(std::memory_order_relaxed);
+        }
+
+    private:
+        size_t m_workers;
+        size_t m_chunkSize;
+    };
+
+    // Lowest matching index per target, recorded from any thread
+    template <size_t MaxTargets>
+    class FirstMatchSet
+    {
+    public:
+        static constexpr size_t NotFound = SIZE_MAX;
+
+        explicit FirstMatchSet(size_t targets = MaxTargets)
+            : m_targets(std::min(targets, MaxTargets))
+        {
+            for (std::atomic<size_t>& match : m_matches)
+            {
+                match.store(NotFound, std::memory_order_relaxed);
+            }
+            m_missing.store(m_targets, std::memory_order_relaxed);
+        }
+
+        // Keeps the lower of index and any earlier match. Returns true once every target has one.
+        bool Record(size_t target, size_t index)
+        {
+            if (target >= m_targets)
+            {
+                return AllFound();
+            }
+            std::atomic<size_t>& match = m_matches[target];
+            size_t current = match.load(std::memory_order_relaxed);
+            while (index < current)
+            {
+                if (match.compare_exchange_weak(current, index, std::memory_order_relaxed))
+                {
+                    if (current == NotFound)
+                    {
+                        return m_missing.fetch_sub(1, std::memory_order_acq_rel) == 1;
+                    }
+                    break;
+                }
+            }
+            return AllFound();
+        }
+
+        // For targets resolved some other way before the scan
+        void Exclude(size_t target)
+        {
+            Record(target, 0);
+        }
+
+        bool Found(size_t target) const
+        {
+            return Get(target) != NotFound;
+        }
+
+        size_t Get(size_t target) const
+        {
+            return target < m_targets ? m_matches[target].load(std::memory_order_acquire) : NotFound;
+        }
+
+        bool AllFound() const
+        {
+            return m_missing.load(std::memory_order_acquire) == 0;
+        }
+
+    private:
+        std::array<std::atomic<size_t>, MaxTargets> m_matches;
+        std::atomic<size_t> m_missing{0};
+        size_t m_targets;
+    };
+}
@@ -0,0 +1,620 @@
+#pragma once
+
+/**
+ * PatchEngine - declarative DataTable edits from table_patches.ini
+ *
+ *   [DT_Enemies]
+ *   Item_Gold.SellPrice *= 2            ; multiply
+ *   Potion_*.Weight += -0.5             ; add
+ *   *.MaximumStack = clamp(1, 9999)     ; clamp into a range
+ *   Item_Key.SellCanStack = true        ; set
+ *
+ * Each section names a table; each line is "<row pattern>.<field> <op> <value>"
+ * where the row pattern is an exact name, a prefix or a wildcard (RowPattern).
+ * Edits on the same row field compose in file order.
+ *
+ * Specs are grouped per table. TablePatch compiles one group against a table:
+ * fields are resolved through the row struct's FieldLayout once, row patterns
+ * are matched once, and the result is a flat list of rows, each with the
+ * fields it changes and the ops to run on them. Apply is then one sweep over
+ * that list, however many specs the group holds, writing through a
+ * PatchJournal layer that reverts it.
+ *
+ * A section named by an object path instead patches a Blueprint component
+ * template, which every instance of the component is copied from:
+ *
+ *   [/Game/Blueprints/Buildings/BP_Cannon.BP_Cannon_C:CannonFacility_GEN_VARIABLE]
+ *   CatapultMaxDistance = 99999.0
+ *
+ * Its lines name fields directly. ObjectPatch resolves the new values from the
+ * template once and writes the same bytes into instances that already exist.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ConfigText.hpp"
+#include "FieldLayout.hpp"
+#include "PatchJournal.hpp"
+#include "RowPattern.hpp"
+
+namespace StackBoost
+{
+    enum class PatchOp : uint8_t
+    {
+        Set,
+        Mul,
+        Add,
+        Clamp, // A = min, B = max
+    };
+
+    struct PatchSpec
+    {
+        std::wstring Table;
+        std::wstring Rows;
+        std::wstring Field;
+        PatchOp Op = PatchOp::Set;
+        double A = 0.0;
+        double B = 0.0;
+        int Line = 0;
+    };
+
+    // Object sections start with '/'; table names never do
+    inline bool IsObjectPatchSection(const std::wstring& section)
+    {
+        return !section.empty() && section[0] == L'/';
+    }
+
+    // "/Game/Path/BP_X.BP_X_C:Component_GEN_VARIABLE" -> "BP_X_C", the Blueprint
+    // class the template belongs to. Empty if the path does not have that shape.
+    inline std::wstring TemplateOwnerClassName(const std::wstring& objectPath)
+    {
+        size_t colon = objectPath.find(L':');
+        size_t dot = objectPath.rfind(L'.', colon);
+        if (colon == std::wstring::npos || dot == std::wstring::npos || colon == dot + 1 || colon + 1 == objectPath.size())
+        {
+            return {};
+        }
+        return objectPath.substr(dot + 1, colon - dot - 1);
+    }
+
+    // Specs for one table (or one object, see IsObject), in file order
+    struct PatchGroup
+    {
+        std::wstring Table; // Table name, or object path for an object section
+        std::vector<PatchSpec> Specs;
+
+        bool IsObject() const { return IsObjectPatchSection(Table); }
+    };
+
+    namespace Detail
+    {
+        inline bool ParsePatchNumber(const std::wstring& text, double& out)
+        {
+            if (text == L"true") { out = 1.0; return true; }
+            if (text == L"false") { out = 0.0; return true; }
+            if (text.empty()) return false;
+
+            size_t consumed = 0;
+            try
+            {
+                out = std::stod(text, &consumed);
+            }
+            catch (...)
+            {
+                return false;
+            }
+            return consumed == text.size() && std::isfinite(out);
+        }
+
+        inline bool IsIntegerField(FieldType type)
+        {
+            return type >= FieldType::Int8 && type <= FieldType::UInt64;
+        }
+
+        inline size_t PatchFieldSize(FieldType type)
+        {
+            switch (type)
+            {
+            case FieldType::Int8: case FieldType::UInt8: case FieldType::Bool: return 1;
+            case FieldType::Int16: case FieldType::UInt16: return 2;
+            case FieldType::Int32: case FieldType::UInt32: case FieldType::Float: return 4;
+            default: return 8;
+            }
+        }
+
+        // The spec's field if it can be patched; otherwise reports why and returns nullptr
+        inline const FieldInfo* ResolvePatchField(const FieldLayout& layout, const PatchSpec& spec, std::vector<ConfigError>* errors)
+        {
+            const FieldInfo* field = layout.Find(spec.Field);
+            bool numeric = field && (IsIntegerField(field->Type) || field->Type == FieldType::Float ||
+                                     field->Type == FieldType::Double || field->Type == FieldType::Bool);
+            if (!numeric)
+            {
+                if (errors)
+                {
+                    errors->push_back({spec.Line, field ? L"field '" + spec.Field + L"' is " + FieldTypeName(field->Type) + L", not a number or bool"
+                                                        : L"no field '" + spec.Field + L"' in " + spec.Table});
+                }
+                return nullptr;
+            }
+            if (field->Type == FieldType::Bool && spec.Op != PatchOp::Set)
+            {
+                if (errors) errors->push_back({spec.Line, L"bool field '" + spec.Field + L"' can only be set"});
+                return nullptr;
+            }
+            return field;
+        }
+
+        template <typename T>
+        double ReadAs(const unsigned char* field)
+        {
+            T value;
+            std::memcpy(&value, field, sizeof(T));
+            return static_cast<double>(value);
+        }
+
+        template <typename T>
+        void WriteAs(unsigned char* field, double value)
+        {
+            T stored;
+            if constexpr (std::is_integral_v<T>)
+            {
+                // Round, then saturate to the field's range instead of wrapping
+                double rounded = std::round(value);
+                double lowest = static_cast<double>(std::numeric_limits<T>::lowest());
+                double highest = static_cast<double>(std::numeric_limits<T>::max());
+                stored = rounded <= lowest ? std::numeric_limits<T>::lowest()
+                       : rounded >= highest ? std::numeric_limits<T>::max()
+                       : static_cast<T>(rounded);
+            }
+            else
+            {
+                stored = static_cast<T>(value);
+            }
+            std::memcpy(field, &stored, sizeof(T));
+        }
+
+        // A bool is tested through its FieldMask (FieldInfo), at the byte holding it
+        inline double ReadField(const unsigned char* field, FieldType type, uint8_t fieldMask = 0xFF)
+        {
+            switch (type)
+            {
+            case FieldType::Int8: return ReadAs<int8_t>(field);
+            case FieldType::Int16: return ReadAs<int16_t>(field);
+            case FieldType::Int32: return ReadAs<int32_t>(field);
+            case FieldType::Int64: return ReadAs<int64_t>(field);
+            case FieldType::UInt8: return ReadAs<uint8_t>(field);
+            case FieldType::UInt16: return ReadAs<uint16_t>(field);
+            case FieldType::UInt32: return ReadAs<uint32_t>(field);
+            case FieldType::UInt64: return ReadAs<uint64_t>(field);
+            case FieldType::Float: return ReadAs<float>(field);
+            case FieldType::Double: return ReadAs<double>(field);
+            case FieldType::Bool: return (*field & fieldMask) != 0 ? 1.0 : 0.0;
+            default: return 0.0;
+            }
+        }
+
+        // field must hold the current bytes: a bool only changes its own bits of the byte
+        inline void WriteField(unsigned char* field, FieldType type, double value, uint8_t fieldMask = 0xFF, uint8_t byteMask = 1)
+        {
+            switch (type)
+            {
+            case FieldType::Int8: WriteAs<int8_t>(field, value); break;
+            case FieldType::Int16: WriteAs<int16_t>(field, value); break;
+            case FieldType::Int32: WriteAs<int32_t>(field, value); break;
+            case FieldType::Int64: WriteAs<int64_t>(field, value); break;
+            case FieldType::UInt8: WriteAs<uint8_t>(field, value); break;
+            case FieldType::UInt16: WriteAs<uint16_t>(field, value); break;
+            case FieldType::UInt32: WriteAs<uint32_t>(field, value); break;
+            case FieldType::UInt64: WriteAs<uint64_t>(field, value); break;
+            case FieldType::Float: WriteAs<float>(field, value); break;
+            case FieldType::Double: WriteAs<double>(field, value); break;
+            case FieldType::Bool: *field = static_cast<unsigned char>((*field & ~fieldMask) | (value != 0.0 ? byteMask : 0)); break;
+            default: break;
+            }
+        }
+    }
+
+    inline double ApplyPatchOp(PatchOp op, double a, double b, double value)
+    {
+        switch (op)
+        {
+        case PatchOp::Set: return a;
+        case PatchOp::Mul: return value * a;
+        case PatchOp::Add: return value + a;
+        case PatchOp::Clamp: return std::min(std::max(value, a), b);
+        }
+        return value;
+    }
+
+    // Parses table_patches.ini into per-table groups (in order of first appearance)
+    inline std::vector<PatchGroup> ParsePatchSpecs(const std::wstring& text, std::vector<ConfigError>* errors = nullptr)
+    {
+        std::vector<PatchGroup> groups;
+        auto report = [&](int line, std::wstring message) {
+            if (errors) errors->push_back({line, std::move(message)});
+        };
+
+        std::wistringstream stream(text);
+        std::wstring rawLine;
+        std::wstring section;
+        int lineNumber = 0;
+        while (std::getline(stream, rawLine))
+        {
+            ++lineNumber;
+            std::wstring line;
+            if (!SplitConfigLine(rawLine, line))
+            {
+                continue;
+            }
+            if (IsConfigSection(line, section))
+            {
+                if (IsObjectPatchSection(section) && TemplateOwnerClassName(section).empty())
+                {
+                    report(lineNumber, L"[" + section + L"] is not '<package>.<Blueprint class>:<component template>'");
+                }
+                continue;
+            }
+            if (section.empty())
+            {
+                report(lineNumber, L"patch outside a [Table] section");
+                continue;
+            }
+
+            size_t equals = line.find(L'=');
+            if (equals == std::wstring::npos || equals == 0)
+            {
+                report(lineNumber, L"expected '<rows>.<field> = value', '*= factor', '+= amount' or '= clamp(min, max)'");
+                continue;
+            }
+
+            PatchSpec spec;
+            spec.Table = section;
+            spec.Line = lineNumber;
+            size_t keyEnd = equals;
+            if (line[equals - 1] == L'*' || line[equals - 1] == L'+')
+            {
+                spec.Op = line[equals - 1] == L'*' ? PatchOp::Mul : PatchOp::Add;
+                keyEnd = equals - 1;
+            }
+            std::wstring key = TrimConfigText(line.substr(0, keyEnd));
+            std::wstring value = TrimConfigText(line.substr(equals + 1));
+
+            size_t dot = key.rfind(L'.');
+            if (IsObjectPatchSection(section))
+            {
+                if (key.empty() || dot != std::wstring::npos)
+                {
+                    report(lineNumber, L"'" + key + L"' is not a field name");
+                    continue;
+                }
+                spec.Field = key;
+            }
+            else if (dot == std::wstring::npos || dot == 0 || dot + 1 == key.size())
+            {
+                report(lineNumber, L"'" + key + L"' is not '<rows>.<field>'");
+                continue;
+            }
+            else
+            {
+                spec.Rows = key.substr(0, dot);
+                spec.Field = key.substr(dot + 1);
+            }
+
+            bool valid = false;
+            if (spec.Op == PatchOp::Set && value.rfind(L"clamp(", 0) == 0 && value.back() == L')')
+            {
+                std::wstring range = value.substr(6, value.size() - 7);
+                size_t comma = range.find(L',');
+                spec.Op = PatchOp::Clamp;
+                valid = comma != std::wstring::npos &&
+                        Detail::ParsePatchNumber(TrimConfigText(range.substr(0, comma)), spec.A) &&
+                        Detail::ParsePatchNumber(TrimConfigText(range.substr(comma + 1)), spec.B) && spec.A <= spec.B;
+            }
+            else
+            {
+                valid = Detail::ParsePatchNumber(value, spec.A);
+            }
+            if (!valid)
+            {
+                report(lineNumber, L"bad value '" + value + L"' for " + key);
+                continue;
+            }
+
+            auto group = std::find_if(groups.begin(), groups.end(), [&](const PatchGroup& g) { return g.Table == section; });
+            if (group == groups.end())
+            {
+                groups.push_back({section, {}});
+                group = groups.end() - 1;
+            }
+            group->Specs.push_back(std::move(spec));
+        }
+        return groups;
+    }
+
+    inline std::vector<PatchGroup> LoadPatchSpecs(const std::filesystem::path& path, std::vector<ConfigError>* errors = nullptr)
+    {
+        std::wstring text;
+        ReadConfigText(path, text, errors);
+        return ParsePatchSpecs(text, errors);
+    }
+
+    // One table's specs compiled against its current rows
+    class TablePatch
+    {
+    public:
+        struct CompileResult
+        {
+            size_t Rows = 0;   // Rows with at least one edit
+            size_t Fields = 0; // Row fields edited
+        };
+
+        // rowName(key) converts a row map key to std::wstring. Specs whose field is
+        // missing or not numeric are reported and skipped.
+        template <typename RowMap, typename RowName>
+        CompileResult Compile(const void* table, const RowMap& rowMap, const FieldLayout& layout,
+                              const std::vector<PatchSpec>& specs, RowName&& rowName, std::vector<ConfigError>* errors = nullptr)
+        {
+            Clear();
+
+            // Resolve each spec's field once
+            struct ResolvedSpec
+            {
+                const PatchSpec* Spec;
+                uint32_t Offset; // Of the byte holding a bool
+                FieldType Type;
+                uint8_t FieldMask;
+                uint8_t ByteMask;
+            };
+            std::vector<ResolvedSpec> resolved;
+            for (const PatchSpec& spec : specs)
+            {
+                if (const FieldInfo* field = Detail::ResolvePatchField(layout, spec, errors))
+                {
+                    resolved.push_back({&spec, field->Offset + field->ByteOffset, field->Type, field->FieldMask, field->ByteMask});
+                }
+            }
+
+            // Match row patterns once, building the flat row -> slot -> op lists
+            for (const auto& pair : rowMap)
+            {
+                unsigned char* rowData = pair.Value;
+                if (!rowData || resolved.empty()) continue;
+
+                std::wstring name = rowName(pair.Key);
+                uint32_t firstSlot = static_cast<uint32_t>(m_slots.size());
+                for (const ResolvedSpec& spec : resolved)
+                {
+                    if (!MatchRowPattern(spec.Spec->Rows, name))
+                    {
+                        continue;
+                    }
+
+                    Slot* slot = nullptr;
+                    for (size_t s = firstSlot; s < m_slots.size(); ++s)
+                    {
+                        // Bitfield bools sharing a byte are separate slots
+                        if (m_slots[s].Offset == spec.Offset && m_slots[s].FieldMask == spec.FieldMask) slot = &m_slots[s];
+                    }
+                    if (!slot)
+                    {
+                        m_slots.push_back({spec.Offset, spec.Type, spec.FieldMask, spec.ByteMask, {}});
+                        slot = &m_slots.back();
+                    }
+                    slot->Ops.push_back({spec.Spec->Op, spec.Spec->A, spec.Spec->B});
+                }
+
+                if (m_slots.size() > firstSlot)
+                {
+                    m_rows.push_back({rowData, firstSlot, static_cast<uint32_t>(m_slots.size() - firstSlot)});
+                }
+            }
+
+            m_table = table;
+            m_rowCount = rowMap.Num();
+            m_firstRow = rowMap.Num() > 0 ? (*rowMap.begin()).Value : nullptr;
+            return {m_rows.size(), m_slots.size()};
+        }
+
+        // Same identity check as StackPatchCore: a reloaded table reallocates its rows
+        template <typename RowMap>
+        bool IsCurrent(const void* table, const RowMap& rowMap) const
+        {
+            if (m_table != table || m_rowCount != rowMap.Num())
+            {
+                return false;
+            }
+            return rowMap.Num() == 0 || (*rowMap.begin()).Value == m_firstRow;
+        }
+
+        // Writes every edit in one sweep, starting from the fields' current values, through
+        // a journal layer, which records originals and reverts (PatchJournal::Revert).
+        // Returns fields changed.
+        size_t Apply(PatchJournal& journal, PatchJournal::LayerId layer) const
+        {
+            size_t changed = 0;
+            for (const Row& row : m_rows)
+            {
+                for (uint32_t s = row.FirstSlot; s < row.FirstSlot + row.SlotCount; ++s)
+                {
+                    const Slot& slot = m_slots[s];
+                    unsigned char* field = row.Data + slot.Offset;
+
+                    double value = Detail::ReadField(field, slot.Type, slot.FieldMask);
+                    for (const Op& op : slot.Ops)
+                    {
+                        value = ApplyPatchOp(op.Kind, op.A, op.B, value);
+                    }
+
+                    uint64_t bytes = 0;
+                    size_t size = FieldSize(slot.Type);
+                    std::memcpy(&bytes, field, size);
+                    Detail::WriteField(reinterpret_cast<unsigned char*>(&bytes), slot.Type, value, slot.FieldMask, slot.ByteMask);
+                    changed += journal.Write(layer, field, &bytes, static_cast<uint8_t>(size));
+                }
+            }
+            return changed;
+        }
+
+        void Clear()
+        {
+            m_rows.clear();
+            m_slots.clear();
+            m_table = nullptr;
+            m_rowCount = 0;
+            m_firstRow = nullptr;
+        }
+
+        size_t RowCount() const { return m_rows.size(); }
+        size_t FieldCount() const { return m_slots.size(); }
+
+    private:
+        struct Op
+        {
+            PatchOp Kind;
+            double A;
+            double B;
+        };
+
+        struct Slot
+        {
+            uint32_t Offset;
+            FieldType Type;
+            uint8_t FieldMask; // Bool only, see FieldInfo
+            uint8_t ByteMask;
+            std::vector<Op> Ops; // Usually one
+        };
+
+        struct Row
+        {
+            unsigned char* Data;
+            uint32_t FirstSlot;
+            uint32_t SlotCount;
+        };
+
+        static size_t FieldSize(FieldType type)
+        {
+            return Detail::PatchFieldSize(type);
+        }
+
+        std::vector<Row> m_rows;
+        std::vector<Slot> m_slots;
+        const void* m_table = nullptr;
+        int32_t m_rowCount = 0;
+        unsigned char* m_firstRow = nullptr;
+    };
+
+    // One object section compiled against the template's class. The template is
+    // written through the journal; instances copied from it before the patch get
+    // the same resolved bytes, so one pass brings them all to the new defaults.
+    class ObjectPatch
+    {
+    public:
+        // Returns the number of fields that will be edited; bad specs are reported and skipped
+        size_t Compile(const FieldLayout& layout, const std::vector<PatchSpec>& specs, std::vector<ConfigError>* errors = nullptr)
+        {
+            m_fields.clear();
+            for (const PatchSpec& spec : specs)
+            {
+                const FieldInfo* info = Detail::ResolvePatchField(layout, spec, errors);
+                if (!info)
+                {
+                    continue;
+                }
+                uint32_t offset = info->Offset + info->ByteOffset;
+                auto field = std::find_if(m_fields.begin(), m_fields.end(), [&](const Field& f) {
+                    return f.Offset == offset && f.FieldMask == info->FieldMask; // Bitfield bools sharing a byte stay apart
+                });
+                if (field == m_fields.end())
+                {
+                    m_fields.push_back({offset, info->Type, info->FieldMask, info->ByteMask, 0, {}});
+                    field = m_fields.end() - 1;
+                }
+                field->Ops.push_back({spec.Op, spec.A, spec.B});
+            }
+            return m_fields.size();
+        }
+
+        // Resolves each field from the template's current value and writes it
+        // through a journal layer. Returns fields changed.
+        size_t ApplyTemplate(PatchJournal& journal, PatchJournal::LayerId layer, unsigned char* object)
+        {
+            size_t changed = 0;
+            for (Field& field : m_fields)
+            {
+                double value = Detail::ReadField(object + field.Offset, field.Type, field.FieldMask);
+                for (const Op& op : field.Ops)
+                {
+                    value = ApplyPatchOp(op.Kind, op.A, op.B, value);
+                }
+                size_t size = Detail::PatchFieldSize(field.Type);
+                field.Value = 0;
+                std::memcpy(&field.Value, object + field.Offset, size);
+                Detail::WriteField(reinterpret_cast<unsigned char*>(&field.Value), field.Type, value, field.FieldMask, field.ByteMask);
+                changed += journal.Write(layer, object + field.Offset, &field.Value, static_cast<uint8_t>(size));
+            }
+            return changed;
+        }
+
+        // Writes the values the last ApplyTemplate resolved into an object of the
+        // template's class; a bool gets only its own bits, since the instance's other
+        // flags in that byte may differ from the template's. Returns fields changed.
+        size_t ApplyInstance(unsigned char* object) const
+        {
+            size_t changed = 0;
+            for (const Field& field : m_fields)
+            {
+                if (field.Type == FieldType::Bool)
+                {
+                    unsigned char* byte = object + field.Offset;
+                    unsigned char bits = static_cast<unsigned char>((*byte & ~field.FieldMask) | (field.Value & field.FieldMask));
+                    if (bits != *byte)
+                    {
+                        *byte = bits;
+                        ++changed;
+                    }
+                    continue;
+                }
+                size_t size = Detail::PatchFieldSize(field.Type);
+                if (std::memcmp(object + field.Offset, &field.Value, size) != 0)
+                {
+                    std::memcpy(object + field.Offset, &field.Value, size);
+                    ++changed;
+                }
+            }
+            return changed;
+        }
+
+        size_t FieldCount() const { return m_fields.size(); }
+
+    private:
+        struct Op
+        {
+            PatchOp Kind;
+            double A;
+            double B;
+        };
+
+        struct Field
+        {
+            uint32_t Offset; // Of the byte holding a bool
+            FieldType Type;
+            uint8_t FieldMask; // Bool only, see FieldInfo
+            uint8_t ByteMask;
+            uint64_t Value; // Resolved by ApplyTemplate
+            std::vector<Op> Ops;
+        };
+
+        std::vector<Field> m_fields;
+    };
+}
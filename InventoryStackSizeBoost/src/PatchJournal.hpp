@@ -0,0 +1,403 @@
+#pragma once
+
+/**
+ * PatchJournal - layered, revertible record of memory edits
+ *
+ * Every patch set (manual stack patch, an exchange, a table's patches) is a
+ * layer. Writing through a layer records (address, before, after) only when
+ * the bytes actually change. Edits to the same address from different layers
+ * form a chain ordered by when they were made, so layers can be reverted in
+ * any order:
+ *
+ *   - reverting the newest edit on an address writes its "before" back;
+ *   - reverting an older one writes nothing and hands its "before" to the
+ *     edit above it, so that later revert lands on the right value.
+ *
+ * Revert touches only the layer's own entries. Before writing, the current
+ * bytes are compared with what the journal last wrote; a mismatch means
+ * something else (the game, another mod) changed the field, and by default
+ * that value is left alone and reported as a conflict instead of being
+ * clobbered with a stale original.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace StackBoost
+{
+    class PatchJournal
+    {
+    public:
+        using LayerId = uint32_t;
+        static constexpr LayerId InvalidLayer = UINT32_MAX;
+
+        enum class RevertMode
+        {
+            SkipModified, // Leave externally modified fields as they are
+            Force,        // Write the originals regardless
+        };
+
+        struct RevertResult
+        {
+            size_t Restored = 0;   // Originals written back
+            size_t Superseded = 0; // Handed down to a newer layer's edit
+            size_t Conflicts = 0;  // Modified externally since the journal wrote them
+        };
+
+        LayerId Begin(std::wstring name)
+        {
+            LayerId id;
+            if (!m_freeLayers.empty())
+            {
+                id = m_freeLayers.back();
+                m_freeLayers.pop_back();
+            }
+            else
+            {
+                id = static_cast<LayerId>(m_layers.size());
+                m_layers.emplace_back();
+            }
+            Layer& layer = m_layers[id];
+            layer.Name = std::move(name);
+            layer.Entries.clear();
+            layer.Active = true;
+            return id;
+        }
+
+        // Writes size bytes (at most 8) of value to address through the layer.
+        // Returns false, recording nothing, if the bytes already hold the value.
+        // tag is handed back to Revert's callback (e.g. a row index for logging).
+        bool Write(LayerId layerId, void* address, const void* value, uint8_t size, uint32_t tag = 0)
+        {
+            if (!IsActive(layerId) || size == 0 || size > sizeof(uint64_t))
+            {
+                return false;
+            }
+
+            unsigned char* bytes = static_cast<unsigned char*>(address);
+            uint64_t current = Load(bytes, size);
+            uint64_t next = Load(static_cast<const unsigned char*>(value), size);
+            if (current == next)
+            {
+                return false; // Most rows of a sweep; no lookup needed
+            }
+
+            uint32_t& top = m_top.FindOrAdd(bytes);
+            if (top != NoEntry && m_entries[top].Layer == layerId)
+            {
+                // Same layer again: the existing entry keeps its original "before"
+                Entry& entry = m_entries[top];
+                std::memcpy(bytes, value, size);
+                entry.After = next;
+                entry.Tag = tag;
+                return true;
+            }
+
+            uint32_t index = AllocateEntry();
+            m_entries[index] = {bytes, current, next, layerId, tag, top, NoEntry, size};
+            if (top != NoEntry)
+            {
+                m_entries[top].Next = index;
+            }
+            top = index;
+            m_layers[layerId].Entries.push_back(index);
+
+            std::memcpy(bytes, value, size);
+            return true;
+        }
+
+        template <typename T>
+        bool Write(LayerId layerId, T* address, T value, uint32_t tag = 0)
+        {
+            static_assert(sizeof(T) <= sizeof(uint64_t), "journal entries hold at most 8 bytes");
+            return Write(layerId, static_cast<void*>(address), &value, static_cast<uint8_t>(sizeof(T)), tag);
+        }
+
+        // Entries of the layer whose field no longer holds what the journal
+        // wrote there (only the newest edit on an address can be checked)
+        size_t Verify(LayerId layerId) const
+        {
+            if (!IsActive(layerId))
+            {
+                return 0;
+            }
+            size_t modified = 0;
+            for (uint32_t index : m_layers[layerId].Entries)
+            {
+                const Entry& entry = m_entries[index];
+                modified += entry.Next == NoEntry && Load(entry.Address, entry.Size) != entry.After;
+            }
+            return modified;
+        }
+
+        // Undoes the layer. onRestored(uint32_t tag, uint64_t from, uint64_t to) is
+        // called for each field actually written back.
+        template <typename OnRestored>
+        RevertResult Revert(LayerId layerId, RevertMode mode, OnRestored&& onRestored)
+        {
+            return RevertNewest(layerId, SIZE_MAX, mode, onRestored);
+        }
+
+        RevertResult Revert(LayerId layerId, RevertMode mode = RevertMode::SkipModified)
+        {
+            return Revert(layerId, mode, [](uint32_t, uint64_t, uint64_t) {});
+        }
+
+        // Undoes up to count of the layer's newest edits, for reverts spread over
+        // several frames; the layer stays active until its last edit is undone.
+        // Reverting all of a layer in steps gives the same result as one Revert,
+        // as long as nothing else writes through the journal in between.
+        template <typename OnRestored>
+        RevertResult RevertNewest(LayerId layerId, size_t count, RevertMode mode, OnRestored&& onRestored)
+        {
+            RevertResult result;
+            if (!IsActive(layerId))
+            {
+                return result;
+            }
+
+            std::vector<uint32_t>& entries = m_layers[layerId].Entries;
+            size_t stop = entries.size() - std::min(count, entries.size());
+            for (size_t i = entries.size(); i-- > stop;)
+            {
+                Entry& entry = m_entries[entries[i]];
+                if (entry.Next != NoEntry)
+                {
+                    m_entries[entry.Next].Before = entry.Before;
+                    result.Superseded++;
+                }
+                else
+                {
+                    uint64_t current = Load(entry.Address, entry.Size);
+                    if (current != entry.After && mode == RevertMode::SkipModified)
+                    {
+                        result.Conflicts++;
+                    }
+                    else
+                    {
+                        onRestored(entry.Tag, current, entry.Before);
+                        std::memcpy(entry.Address, &entry.Before, entry.Size);
+                        result.Restored++;
+                    }
+                }
+                Unlink(entries[i]);
+            }
+            entries.resize(stop);
+            if (entries.empty())
+            {
+                Release(layerId);
+            }
+            return result;
+        }
+
+        // Forgets the layer without touching memory (its rows were freed or reallocated)
+        void Discard(LayerId layerId)
+        {
+            if (!IsActive(layerId))
+            {
+                return;
+            }
+            std::vector<uint32_t>& entries = m_layers[layerId].Entries;
+            for (size_t i = entries.size(); i-- > 0;)
+            {
+                Entry& entry = m_entries[entries[i]];
+                if (entry.Next != NoEntry)
+                {
+                    m_entries[entry.Next].Before = entry.Before;
+                }
+                Unlink(entries[i]);
+            }
+            Release(layerId);
+        }
+
+        bool IsActive(LayerId layerId) const
+        {
+            return layerId < m_layers.size() && m_layers[layerId].Active;
+        }
+
+        size_t Changes(LayerId layerId) const
+        {
+            return IsActive(layerId) ? m_layers[layerId].Entries.size() : 0;
+        }
+
+        const std::wstring& Name(LayerId layerId) const
+        {
+            static const std::wstring none;
+            return IsActive(layerId) ? m_layers[layerId].Name : none;
+        }
+
+        // Addresses currently patched by at least one layer
+        size_t PatchedAddresses() const { return m_top.Size(); }
+
+    private:
+        static constexpr uint32_t NoEntry = UINT32_MAX;
+
+        struct Entry
+        {
+            unsigned char* Address;
+            uint64_t Before; // Value to restore (updated when an older layer below is reverted)
+            uint64_t After;  // Value the journal wrote
+            LayerId Layer;
+            uint32_t Tag;
+            uint32_t Prev;   // Older edit on the same address
+            uint32_t Next;   // Newer edit on the same address
+            uint8_t Size;
+        };
+
+        struct Layer
+        {
+            std::wstring Name;
+            std::vector<uint32_t> Entries;
+            bool Active = false;
+        };
+
+        static uint64_t Load(const unsigned char* bytes, uint8_t size)
+        {
+            uint64_t value = 0;
+            std::memcpy(&value, bytes, size);
+            return value;
+        }
+
+        uint32_t AllocateEntry()
+        {
+            if (!m_freeEntries.empty())
+            {
+                uint32_t index = m_freeEntries.back();
+                m_freeEntries.pop_back();
+                return index;
+            }
+            m_entries.emplace_back();
+            return static_cast<uint32_t>(m_entries.size() - 1);
+        }
+
+        void Unlink(uint32_t index)
+        {
+            Entry& entry = m_entries[index];
+            if (entry.Prev != NoEntry)
+            {
+                m_entries[entry.Prev].Next = entry.Next;
+            }
+            if (entry.Next != NoEntry)
+            {
+                m_entries[entry.Next].Prev = entry.Prev;
+            }
+            else if (entry.Prev != NoEntry)
+            {
+                m_top.FindOrAdd(entry.Address) = entry.Prev;
+            }
+            else
+            {
+                m_top.Erase(entry.Address);
+            }
+            m_freeEntries.push_back(index);
+        }
+
+        void Release(LayerId layerId)
+        {
+            Layer& layer = m_layers[layerId];
+            layer.Entries.clear();
+            layer.Active = false;
+            m_freeLayers.push_back(layerId);
+        }
+
+        // Address -> newest entry, open addressing with linear probing. Patched
+        // fields number in the thousands and churn on every exchange fallback,
+        // so this avoids a node allocation per write.
+        class AddressIndex
+        {
+        public:
+            // The slot for address, inserted as NoEntry if absent. Valid until the next call.
+            uint32_t& FindOrAdd(const unsigned char* address)
+            {
+                if ((m_size + 1) * 2 > m_slots.size())
+                {
+                    Grow();
+                }
+                size_t i = SlotFor(address);
+                while (m_slots[i].Address && m_slots[i].Address != address)
+                {
+                    i = (i + 1) & (m_slots.size() - 1);
+                }
+                if (!m_slots[i].Address)
+                {
+                    m_slots[i] = {address, NoEntry};
+                    m_size++;
+                }
+                return m_slots[i].Index;
+            }
+
+            void Erase(const unsigned char* address)
+            {
+                if (m_slots.empty())
+                {
+                    return;
+                }
+                size_t mask = m_slots.size() - 1;
+                size_t i = SlotFor(address);
+                while (m_slots[i].Address != address)
+                {
+                    if (!m_slots[i].Address)
+                    {
+                        return;
+                    }
+                    i = (i + 1) & mask;
+                }
+
+                // Backward-shift deletion keeps probe chains intact without tombstones
+                for (size_t next = (i + 1) & mask; m_slots[next].Address; next = (next + 1) & mask)
+                {
+                    size_t home = SlotFor(m_slots[next].Address);
+                    if (((next - home) & mask) >= ((next - i) & mask))
+                    {
+                        m_slots[i] = m_slots[next];
+                        i = next;
+                    }
+                }
+                m_slots[i] = {};
+                m_size--;
+            }
+
+            size_t Size() const { return m_size; }
+
+        private:
+            struct Slot
+            {
+                const unsigned char* Address = nullptr;
+                uint32_t Index = NoEntry;
+            };
+
+            size_t SlotFor(const unsigned char* address) const
+            {
+                uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address)) * 0x9E3779B97F4A7C15ull;
+                return static_cast<size_t>(key >> 32) & (m_slots.size() - 1);
+            }
+
+            void Grow()
+            {
+                std::vector<Slot> old = std::move(m_slots);
+                m_slots.assign(old.empty() ? 64 : old.size() * 2, Slot{});
+                m_size = 0;
+                for (const Slot& slot : old)
+                {
+                    if (slot.Address)
+                    {
+                        FindOrAdd(slot.Address) = slot.Index;
+                    }
+                }
+            }
+
+            std::vector<Slot> m_slots;
+            size_t m_size = 0;
+        };
+
+        std::vector<Entry> m_entries;
+        std::vector<uint32_t> m_freeEntries;
+        std::vector<Layer> m_layers;
+        std::vector<LayerId> m_freeLayers;
+        AddressIndex m_top; // Newest edit per address
+    };
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+ * PatchStateMachine - who may write DT_Enemies (and the journal) right now
+ *
+ * One atomic word holds whether the manual stack patch (Shift+J) is on, which
+ * operation currently owns the rows, and an epoch that counts finished
+ * operations. Every writer - the exchange hooks, the J/K actions, config and
+ * table patch reloads - takes ownership with TryBegin and hands it back with
+ * End. Nothing waits: TryBegin either wins the word or reports why not, and
+ * the caller skips (a hook) or retries on a later frame (an action).
+ *
+ * The exchange hooks' fast path is IsPatched(), a single acquire load. Since
+ * only the owner touches the snapshot, it is built at most once per table
+ * load, however many threads try to patch at the same time.
+ */
+
+#include <atomic>
+#include <cstdint>
+
+namespace StackBoost
+{
+    class PatchStateMachine
+    {
+    public:
+        enum class Op : uint8_t
+        {
+            None,
+            Exchange,    // Transient patch around one TryExchangeInventorySlot call; needs stacks unpatched
+            Patch,       // Manual patch; needs stacks unpatched
+            Restore,     // Manual restore; needs stacks patched
+            Maintenance, // Config/table patch reload; either state
+        };
+
+        enum class Result : uint8_t
+        {
+            Began,
+            Busy,           // Another operation owns the rows
+            AlreadyPatched, // Exchange or Patch while the manual patch is on
+            NotPatched,     // Restore while it is off
+        };
+
+        struct State
+        {
+            bool Patched;
+            Op Owner;
+            uint32_t Epoch;
+        };
+
+        State Load() const
+        {
+            return Unpack(m_word.load(std::memory_order_acquire));
+        }
+
+        bool IsPatched() const
+        {
+            return (m_word.load(std::memory_order_acquire) & PATCHED_BIT) != 0;
+        }
+
+        uint32_t Epoch() const
+        {
+            return Load().Epoch;
+        }
+
+        // Retries only when another operation ended between the load and the
+        // exchange, never while one is running
+        Result TryBegin(Op op)
+        {
+            uint64_t word = m_word.load(std::memory_order_acquire);
+            for (;;)
+            {
+                State state = Unpack(word);
+                if (state.Owner != Op::None)
+                {
+                    return Result::Busy;
+                }
+                if ((op == Op::Exchange || op == Op::Patch) && state.Patched)
+                {
+                    return Result::AlreadyPatched;
+                }
+                if (op == Op::Restore && !state.Patched)
+                {
+                    return Result::NotPatched;
+                }
+                if (m_word.compare_exchange_weak(word, Pack(state.Patched, op, state.Epoch), std::memory_order_acquire,
+                                                 std::memory_order_acquire))
+                {
+                    return Result::Began;
+                }
+            }
+        }
+
+        // Owner only. patched is whether the manual patch is on afterwards.
+        void End(bool patched)
+        {
+            State state = Load();
+            m_word.store(Pack(patched, Op::None, state.Epoch + 1), std::memory_order_release);
+        }
+
+        // Keeps the manual patch state as it was
+        void End()
+        {
+            End(IsPatched());
+        }
+
+    private:
+        static constexpr uint64_t PATCHED_BIT = 1;
+        static constexpr int OWNER_SHIFT = 1;
+        static constexpr uint64_t OWNER_MASK = 0x7;
+        static constexpr int EPOCH_SHIFT = 32;
+
+        static uint64_t Pack(bool patched, Op owner, uint32_t epoch)
+        {
+            return (patched ? PATCHED_BIT : 0) | (static_cast<uint64_t>(owner) << OWNER_SHIFT) |
+                   (static_cast<uint64_t>(epoch) << EPOCH_SHIFT);
+        }
+
+        static State Unpack(uint64_t word)
+        {
+            return {(word & PATCHED_BIT) != 0, static_cast<Op>((word >> OWNER_SHIFT) & OWNER_MASK),
+                    static_cast<uint32_t>(word >> EPOCH_SHIFT)};
+        }
+
+        std::atomic<uint64_t> m_word{0};
+    };
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+/**
+ * PeriodicWorker - runs a callback on its own thread at a fixed interval
+ *
+ * For background chores (file polling, periodic dumps) that must not cost
+ * the game or update thread anything. Stop() wakes the thread immediately.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace StackBoost
+{
+    class PeriodicWorker
+    {
+    public:
+        ~PeriodicWorker()
+        {
+            Stop();
+        }
+
+        void Start(std::chrono::milliseconds interval, std::function<void()> tick)
+        {
+            Stop();
+            m_interval = interval;
+            m_tick = std::move(tick);
+            m_stopping = false;
+            m_thread = std::thread([this] { Run(); });
+        }
+
+        void Stop()
+        {
+            if (!m_thread.joinable())
+            {
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopping = true;
+            }
+            m_wake.notify_all();
+            m_thread.join();
+        }
+
+        bool Running() const { return m_thread.joinable(); }
+
+    private:
+        void Run()
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_wake.wait_for(lock, m_interval, [this] { return m_stopping; }))
+            {
+                lock.unlock();
+                m_tick();
+                lock.lock();
+            }
+        }
+
+        std::chrono::milliseconds m_interval{1000};
+        std::function<void()> m_tick;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stopping = false;
+    };
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+ * RetryScheduler - wall-clock retries with exponential backoff
+ *
+ * Each task is an attempt function that returns true once it has succeeded.
+ * A failed attempt doubles the task's delay up to its maximum, so work that
+ * depends on the game reaching some state (objects loaded, functions
+ * registered) is retried quickly at first and rarely afterwards, independent
+ * of frame rate. A task with an attempt limit is given up once it has failed
+ * that many times. Finished tasks are dropped; an empty scheduler costs
+ * nothing, and NextDue() says when the caller next needs to run it.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cwchar>
+#include <functional>
+#include <vector>
+
+namespace StackBoost
+{
+    class RetryScheduler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // The first attempt runs on the next RunDue. maxAttempts 0 retries forever.
+        void Add(const wchar_t* name, std::chrono::milliseconds initialDelay, std::chrono::milliseconds maxDelay,
+                 std::function<bool()> attempt, unsigned maxAttempts = 0)
+        {
+            m_tasks.push_back({name, std::move(attempt), initialDelay, maxDelay, Clock::time_point::min(), 0, maxAttempts});
+        }
+
+        // Runs every task that is due. Returns true while unfinished tasks remain.
+        bool RunDue(Clock::time_point now)
+        {
+            return RunDue(now, [](const wchar_t*, unsigned) {});
+        }
+
+        // Same; onGiveUp(const wchar_t* name, unsigned attempts) is called for each
+        // task dropped at its attempt limit
+        template <typename OnGiveUp>
+        bool RunDue(Clock::time_point now, OnGiveUp&& onGiveUp)
+        {
+            for (size_t i = 0; i < m_tasks.size();)
+            {
+                Task& task = m_tasks[i];
+                if (now < task.NextDue)
+                {
+                    ++i;
+                    continue;
+                }
+
+                task.Attempts++;
+                bool succeeded = task.Attempt();
+                if (succeeded || task.Attempts == task.MaxAttempts)
+                {
+                    if (!succeeded)
+                    {
+                        onGiveUp(task.Name, task.Attempts);
+                    }
+                    m_tasks.erase(m_tasks.begin() + static_cast<std::ptrdiff_t>(i));
+                    continue;
+                }
+
+                // First retry waits the initial delay; every later one twice as long as the last
+                if (task.Attempts > 1)
+                {
+                    task.Delay = std::min(task.Delay * 2, task.MaxDelay);
+                }
+                task.NextDue = now + task.Delay;
+                ++i;
+            }
+            return !m_tasks.empty();
+        }
+
+        bool Empty() const { return m_tasks.empty(); }
+
+        // Earliest time any task is due, or time_point::max() when there are none
+        Clock::time_point NextDue() const
+        {
+            Clock::time_point next = Clock::time_point::max();
+            for (const Task& task : m_tasks)
+            {
+                next = std::min(next, task.NextDue);
+            }
+            return next;
+        }
+
+        bool Contains(const wchar_t* name) const
+        {
+            for (const Task& task : m_tasks)
+            {
+                if (std::wcscmp(task.Name, name) == 0) return true;
+            }
+            return false;
+        }
+
+        // Attempts made so far by the named task, or 0 if it has finished or never existed
+        unsigned Attempts(const wchar_t* name) const
+        {
+            for (const Task& task : m_tasks)
+            {
+                if (std::wcscmp(task.Name, name) == 0) return task.Attempts;
+            }
+            return 0;
+        }
+
+    private:
+        struct Task
+        {
+            const wchar_t* Name;
+            std::function<bool()> Attempt;
+            std::chrono::milliseconds Delay;
+            std::chrono::milliseconds MaxDelay;
+            Clock::time_point NextDue;
+            unsigned Attempts;
+            unsigned MaxAttempts;
+        };
+
+        std::vector<Task> m_tasks;
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+/**
+ * RowPattern - DataTable row selectors used by the config files
+ *
+ * A pattern is an exact row name, a prefix ("Potion_*") or a general
+ * wildcard with '*' (any run) and '?' (any one character). Matching is only
+ * done when rules are compiled against a table, never per patch.
+ */
+
+#include <string>
+
+namespace StackBoost
+{
+    enum class RowPatternKind
+    {
+        Exact,
+        Prefix,
+        Wildcard,
+    };
+
+    inline RowPatternKind ClassifyRowPattern(const std::wstring& pattern)
+    {
+        size_t special = pattern.find_first_of(L"*?");
+        if (special == std::wstring::npos)
+        {
+            return RowPatternKind::Exact;
+        }
+        if (special == pattern.size() - 1 && pattern.back() == L'*')
+        {
+            return RowPatternKind::Prefix;
+        }
+        return RowPatternKind::Wildcard;
+    }
+
+    // '*' matches any run, '?' any single character
+    inline bool WildcardMatch(const wchar_t* pattern, const wchar_t* text)
+    {
+        const wchar_t* starPattern = nullptr;
+        const wchar_t* starText = nullptr;
+        while (*text)
+        {
+            if (*pattern == L'?' || *pattern == *text)
+            {
+                ++pattern;
+                ++text;
+            }
+            else if (*pattern == L'*')
+            {
+                starPattern = pattern++;
+                starText = text;
+            }
+            else if (starPattern)
+            {
+                pattern = starPattern + 1;
+                text = ++starText;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        while (*pattern == L'*') ++pattern;
+        return *pattern == 0;
+    }
+
+    inline bool MatchRowPattern(const std::wstring& pattern, const std::wstring& rowName)
+    {
+        switch (ClassifyRowPattern(pattern))
+        {
+        case RowPatternKind::Exact: return pattern == rowName;
+        case RowPatternKind::Prefix: return rowName.compare(0, pattern.size() - 1, pattern, 0, pattern.size() - 1) == 0;
+        default: return WildcardMatch(pattern.c_str(), rowName.c_str());
+        }
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+/**
+ * RowStructLayout - reflection walk that fills FieldLayout tables
+ *
+ * Each UScriptStruct is walked once; later requests for the same struct are
+ * served from a small flat cache.
+ */
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <Unreal/UObject.hpp>
+#include <Unreal/UScriptStruct.hpp>
+#include <Unreal/CoreUObject/UObject/UnrealType.hpp>
+#include <Unreal/Property/FBoolProperty.hpp>
+#include "FieldLayout.hpp"
+
+namespace StackBoost
+{
+    using namespace RC;
+    using namespace RC::Unreal;
+
+    // Collects the struct's own properties and those of its super structs
+    inline FieldLayout BuildFieldLayout(UStruct* ownerStruct)
+    {
+        FieldLayout layout;
+        for (UStruct* current = ownerStruct; current; current = current->GetSuperStruct())
+        {
+            for (FProperty* prop = current->GetFirstProperty(); prop; prop = prop->GetNextFieldAsProperty())
+            {
+                FieldInfo field;
+                field.Name = prop->GetName();
+                field.Offset = static_cast<uint32_t>(prop->GetOffset_Internal());
+                field.Size = static_cast<uint32_t>(prop->GetSize());
+                field.Type = FieldTypeFromPropertyClass(prop->GetClass().GetName());
+                if (field.Type == FieldType::Bool)
+                {
+                    FBoolProperty* boolProp = static_cast<FBoolProperty*>(prop);
+                    field.ByteOffset = boolProp->GetByteOffset();
+                    field.FieldMask = boolProp->GetFieldMask();
+                    field.ByteMask = boolProp->GetByteMask();
+                }
+                layout.Add(std::move(field));
+            }
+        }
+        return layout;
+    }
+
+    class RowStructLayoutCache
+    {
+    public:
+        // Returns the cached layout for a struct, walking its properties on first use
+        const FieldLayout& Get(UStruct* ownerStruct)
+        {
+            for (const auto& [cachedStruct, layout] : m_entries)
+            {
+                if (cachedStruct == ownerStruct)
+                {
+                    return *layout;
+                }
+            }
+
+            m_entries.emplace_back(ownerStruct, std::make_unique<FieldLayout>(BuildFieldLayout(ownerStruct)));
+            return *m_entries.back().second;
+        }
+
+    private:
+        // unique_ptr keeps returned references stable as the cache grows
+        std::vector<std::pair<UStruct*, std::unique_ptr<FieldLayout>>> m_entries;
+    };
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+/**
+ * StackCompactor - merges partial stacks of the same item up to its limit
+ *
+ * One pass over the slots with a hash map from item to the earliest slot of
+ * that item that still has room. Each partial stack met later pours into it;
+ * when it fills up, the remainder stays where it is and becomes the slot with
+ * room. The result is what filling every item's earliest slots first would
+ * give, computed without grouping or sorting.
+ *
+ * Only the plan is computed here: Writes() lists each slot whose count changes,
+ * once, with its final count (0 = the slot is emptied). Full stacks, stacks
+ * above the limit (e.g. after the limits were lowered) and items whose limit
+ * is 1 or less are never touched.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "InventorySorter.hpp"
+
+namespace StackBoost
+{
+    struct SlotCountWrite
+    {
+        uint32_t Slot;
+        int32_t Count; // 0 empties the slot
+    };
+
+    class StackCompactor
+    {
+    public:
+        // keys[i] is slot i's item (EmptySlotKey for none), counts[i] its stack size.
+        // limitFor(size_t slot) -> int32_t is asked once per distinct item, for its first slot.
+        template <typename LimitFor>
+        const std::vector<SlotCountWrite>& Plan(const uint64_t* keys, const int32_t* counts, size_t count, LimitFor&& limitFor)
+        {
+            m_writes.clear();
+            m_open.clear();
+            m_counts.assign(counts, counts + count);
+            m_emptied = 0;
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (keys[i] == EmptySlotKey || m_counts[i] <= 0)
+                {
+                    continue;
+                }
+
+                auto [entry, inserted] = m_open.try_emplace(keys[i], Open{NoSlot, 0});
+                Open& open = entry->second;
+                if (inserted)
+                {
+                    open.Limit = limitFor(i);
+                }
+                if (open.Limit <= 1 || m_counts[i] >= open.Limit)
+                {
+                    continue;
+                }
+                if (open.Slot == NoSlot)
+                {
+                    open.Slot = static_cast<uint32_t>(i);
+                    continue;
+                }
+
+                int32_t moved = std::min(open.Limit - m_counts[open.Slot], m_counts[i]);
+                m_counts[open.Slot] += moved;
+                m_counts[i] -= moved;
+                if (m_counts[i] == 0)
+                {
+                    m_emptied++;
+                }
+                if (m_counts[open.Slot] == open.Limit)
+                {
+                    open.Slot = m_counts[i] > 0 ? static_cast<uint32_t>(i) : NoSlot;
+                }
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (m_counts[i] != counts[i] && keys[i] != EmptySlotKey)
+                {
+                    m_writes.push_back({static_cast<uint32_t>(i), m_counts[i]});
+                }
+            }
+            return m_writes;
+        }
+
+        const std::vector<SlotCountWrite>& Writes() const { return m_writes; }
+        size_t Emptied() const { return m_emptied; }
+
+    private:
+        static constexpr uint32_t NoSlot = UINT32_MAX;
+
+        struct Open
+        {
+            uint32_t Slot; // Earliest slot of the item with room left
+            int32_t Limit;
+        };
+
+        std::unordered_map<uint64_t, Open> m_open;
+        std::vector<int32_t> m_counts;
+        std::vector<SlotCountWrite> m_writes;
+        size_t m_emptied = 0;
+    };
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+/**
+ * StackConfig - stack size rules read from stack_config.ini
+ *
+ *   # Global cap: stackable rows (MaximumStack > 0) below it are raised to it
+ *   MaxStack = 1000
+ *   # Keep the player inventory sorted natively on every inventory update
+ *   AutoSort = false
+ *   # Answer stack limits from the GetItemTotalStack hook instead of patching DT_Enemies
+ *   VirtualStacks = false
+ *   # DataTables written to exports/ on Shift+E (names or patterns, comma separated)
+ *   ExportTables = DT_Enemies
+ *   # Microseconds per frame the Shift+J/K patch and restore may use (0 = all in one frame)
+ *   PatchFrameBudget = 2000
+ *
+ *   [Overrides]
+ *   Item_Gold   = 5000   ; exact row name
+ *   Potion_*    = 200    ; prefix
+ *   *_Ore_?     = 500    ; wildcard (* and ?)
+ *   Item_Key    = keep   ; never touched
+ *
+ * An override sets MaximumStack for a stackable row to its value (raising or
+ * lowering it). Exact names beat prefixes, longer prefixes beat shorter ones,
+ * and wildcards are tried last in file order.
+ *
+ * Rules are never matched at patch time: StackRuleTable compiles them against
+ * the snapshot's row names into one target value per row, so applying them is
+ * the same linear sweep as a single global cap.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ConfigText.hpp"
+#include "RowPattern.hpp"
+#include "StackPatchCore.hpp"
+
+namespace StackBoost
+{
+    enum class StackRuleKind : uint8_t
+    {
+        Set,  // Stackable rows get exactly Value
+        Keep, // Row is left as the game shipped it
+    };
+
+    struct StackOverride
+    {
+        std::wstring Pattern;
+        StackRuleKind Kind = StackRuleKind::Set;
+        int32_t Value = 0;
+    };
+
+    struct StackConfig
+    {
+        int32_t MaxStack = 1000;
+        bool AutoSort = false;
+        bool VirtualStacks = false;
+        std::vector<std::wstring> ExportTables = {L"DT_Enemies"};
+        int32_t PatchFrameBudget = 2000; // Microseconds; 0 = unlimited
+        std::vector<StackOverride> Overrides;
+    };
+
+    using StackConfigError = ConfigError;
+
+    namespace Detail
+    {
+        inline bool ParseInt32(const std::wstring& text, int32_t& out)
+        {
+            if (text.empty())
+            {
+                return false;
+            }
+            size_t consumed = 0;
+            long long value = 0;
+            try
+            {
+                value = std::stoll(text, &consumed);
+            }
+            catch (...)
+            {
+                return false;
+            }
+            if (consumed != text.size() || value < 0 || value > INT32_MAX)
+            {
+                return false;
+            }
+            out = static_cast<int32_t>(value);
+            return true;
+        }
+    }
+
+    // Parses config text. Bad lines are reported and skipped; the rest still applies.
+    inline StackConfig ParseStackConfig(const std::wstring& text, int32_t defaultMaxStack, std::vector<StackConfigError>* errors = nullptr)
+    {
+        StackConfig config;
+        config.MaxStack = defaultMaxStack;
+
+        auto report = [&](int line, std::wstring message) {
+            if (errors) errors->push_back({line, std::move(message)});
+        };
+
+        std::wistringstream stream(text);
+        std::wstring rawLine;
+        std::wstring section;
+        int lineNumber = 0;
+        while (std::getline(stream, rawLine))
+        {
+            ++lineNumber;
+            std::wstring line;
+            if (!SplitConfigLine(rawLine, line))
+            {
+                continue;
+            }
+
+            if (IsConfigSection(line, section))
+            {
+                if (section != L"Overrides")
+                {
+                    report(lineNumber, L"unknown section [" + section + L"]");
+                }
+                continue;
+            }
+
+            size_t equals = line.find(L'=');
+            if (equals == std::wstring::npos)
+            {
+                report(lineNumber, L"expected 'key = value'");
+                continue;
+            }
+            std::wstring key = TrimConfigText(line.substr(0, equals));
+            std::wstring value = TrimConfigText(line.substr(equals + 1));
+
+            if (section.empty())
+            {
+                if (key == L"MaxStack")
+                {
+                    if (!Detail::ParseInt32(value, config.MaxStack) || config.MaxStack == 0)
+                    {
+                        report(lineNumber, L"MaxStack must be a positive integer");
+                        config.MaxStack = defaultMaxStack;
+                    }
+                }
+                else if (key == L"AutoSort")
+                {
+                    if (value != L"true" && value != L"false")
+                    {
+                        report(lineNumber, L"AutoSort must be true or false");
+                    }
+                    config.AutoSort = value == L"true";
+                }
+                else if (key == L"VirtualStacks")
+                {
+                    if (value != L"true" && value != L"false")
+                    {
+                        report(lineNumber, L"VirtualStacks must be true or false");
+                    }
+                    config.VirtualStacks = value == L"true";
+                }
+                else if (key == L"PatchFrameBudget")
+                {
+                    if (!Detail::ParseInt32(value, config.PatchFrameBudget) || config.PatchFrameBudget < 0)
+                    {
+                        report(lineNumber, L"PatchFrameBudget must be 0 or a positive number of microseconds");
+                        config.PatchFrameBudget = StackConfig{}.PatchFrameBudget;
+                    }
+                }
+                else if (key == L"ExportTables")
+                {
+                    config.ExportTables.clear();
+                    std::wistringstream names(value);
+                    std::wstring name;
+                    while (std::getline(names, name, L','))
+                    {
+                        name = TrimConfigText(name);
+                        if (!name.empty()) config.ExportTables.push_back(name);
+                    }
+                }
+                else
+                {
+                    report(lineNumber, L"unknown setting '" + key + L"'");
+                }
+                continue;
+            }
+            if (section != L"Overrides")
+            {
+                continue;
+            }
+
+            StackOverride rule;
+            rule.Pattern = key;
+            if (key.empty())
+            {
+                report(lineNumber, L"override with an empty row name");
+                continue;
+            }
+            if (value == L"keep")
+            {
+                rule.Kind = StackRuleKind::Keep;
+            }
+            else if (!Detail::ParseInt32(value, rule.Value) || rule.Value == 0)
+            {
+                report(lineNumber, L"override for '" + key + L"' must be a positive integer or 'keep'");
+                continue;
+            }
+            config.Overrides.push_back(std::move(rule));
+        }
+        return config;
+    }
+
+    // Missing file yields the defaults; an unreadable one is reported as line 0
+    inline StackConfig LoadStackConfig(const std::filesystem::path& path, int32_t defaultMaxStack, std::vector<StackConfigError>* errors = nullptr)
+    {
+        std::wstring text;
+        ReadConfigText(path, text, errors);
+        return ParseStackConfig(text, defaultMaxStack, errors);
+    }
+
+    // Config rules compiled against one snapshot: one rule per snapshot entry,
+    // in the same order. Targets() holds the result for the captured originals;
+    // Target() applies an entry's rule to whatever value the row holds now.
+    class StackRuleTable
+    {
+    public:
+        static constexpr int32_t RuleGlobal = -1; // Global cap
+        static constexpr int32_t RuleKeep = -2;   // Leave as is; any positive rule is a Set value
+        // rowName(i) returns the name of snapshot entry i as a std::wstring
+        template <typename RowName>
+        void Compile(const StackConfig& config, const std::vector<StackSnapshotEntry>& entries, RowName&& rowName)
+        {
+            m_targets.clear();
+            m_targets.reserve(entries.size());
+            m_rules.clear();
+            m_rules.reserve(entries.size());
+            m_byField.clear();
+            m_maxStack = config.MaxStack;
+            m_overrideCount = 0;
+
+            std::unordered_map<std::wstring, const StackOverride*> exact;
+            std::vector<const StackOverride*> prefixes;
+            std::vector<const StackOverride*> wildcards;
+            for (const StackOverride& rule : config.Overrides)
+            {
+                RowPatternKind kind = ClassifyRowPattern(rule.Pattern);
+                if (kind == RowPatternKind::Exact)
+                {
+                    exact.emplace(rule.Pattern, &rule); // First definition wins
+                }
+                else if (kind == RowPatternKind::Prefix)
+                {
+                    prefixes.push_back(&rule);
+                }
+                else
+                {
+                    wildcards.push_back(&rule);
+                }
+            }
+            std::stable_sort(prefixes.begin(), prefixes.end(), [](const StackOverride* a, const StackOverride* b) {
+                return a->Pattern.size() > b->Pattern.size();
+            });
+
+            for (size_t i = 0; i < entries.size(); ++i)
+            {
+                const StackOverride* rule = nullptr;
+                if (!config.Overrides.empty())
+                {
+                    std::wstring name = rowName(i);
+                    auto found = exact.find(name);
+                    if (found != exact.end())
+                    {
+                        rule = found->second;
+                    }
+                    for (size_t p = 0; !rule && p < prefixes.size(); ++p)
+                    {
+                        const std::wstring& pattern = prefixes[p]->Pattern;
+                        if (name.compare(0, pattern.size() - 1, pattern, 0, pattern.size() - 1) == 0)
+                        {
+                            rule = prefixes[p];
+                        }
+                    }
+                    for (size_t w = 0; !rule && w < wildcards.size(); ++w)
+                    {
+                        if (WildcardMatch(wildcards[w]->Pattern.c_str(), name.c_str()))
+                        {
+                            rule = wildcards[w];
+                        }
+                    }
+                }
+
+                int32_t encoded = !rule ? RuleGlobal : rule->Kind == StackRuleKind::Keep ? RuleKeep : rule->Value;
+                m_rules.push_back(encoded);
+                m_targets.push_back(Resolve(encoded, entries[i].OriginalValue));
+                if (rule)
+                {
+                    m_overrideCount++;
+                    m_byField.push_back({entries[i].MaxStack, encoded});
+                }
+            }
+
+            std::sort(m_byField.begin(), m_byField.end());
+        }
+
+        void Clear()
+        {
+            m_targets.clear();
+            m_rules.clear();
+            m_byField.clear();
+            m_overrideCount = 0;
+        }
+
+        // Target for a row located by its MaximumStack field, for the few rows an
+        // exchange touches. Rows without an override follow the global cap.
+        int32_t TargetFor(int32_t* maxStackField, int32_t currentValue) const
+        {
+            if (!m_byField.empty())
+            {
+                auto found = std::lower_bound(m_byField.begin(), m_byField.end(), std::make_pair(maxStackField, INT32_MIN));
+                if (found != m_byField.end() && found->first == maxStackField)
+                {
+                    return Resolve(found->second, currentValue);
+                }
+            }
+            return ApplyMaxStackRule(currentValue, m_maxStack);
+        }
+
+        // Target for snapshot entry i given the value its row holds now
+        int32_t Target(size_t entry, int32_t currentValue) const
+        {
+            return Resolve(m_rules[entry], currentValue);
+        }
+
+        const std::vector<int32_t>& Targets() const { return m_targets; }
+        size_t OverrideCount() const { return m_overrideCount; }
+        int32_t MaxStack() const { return m_maxStack; }
+
+    private:
+        int32_t Resolve(int32_t rule, int32_t value) const
+        {
+            if (rule == RuleGlobal) return ApplyMaxStackRule(value, m_maxStack);
+            if (rule == RuleKeep || value <= 0) return value;
+            return rule;
+        }
+
+        std::vector<int32_t> m_targets;                     // Parallel to the snapshot entries
+        std::vector<int32_t> m_rules;                       // Parallel to the snapshot entries
+        std::vector<std::pair<int32_t*, int32_t>> m_byField; // Overridden rows only (rule), sorted by field address
+        int32_t m_maxStack = 1000;
+        size_t m_overrideCount = 0;
+    };
+}
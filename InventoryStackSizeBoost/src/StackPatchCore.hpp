@@ -0,0 +1,161 @@
+#pragma once
+
+/**
+ * StackPatchCore - MaximumStack snapshot and patch rules
+ *
+ * The snapshot lists every row's MaximumStack field and its original value;
+ * patches and restores are written through a PatchJournal layer over it.
+ * Header-only and templated over the row map, so the same code runs against
+ * UE4SS's TMap<FName, unsigned char*> in game and against the mock types in
+ * host/ for tests and benchmarks. A RowMap only needs Num(), begin()/end()
+ * and elements with Key/Value members.
+ */
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "FieldLayout.hpp"
+#include "PatchJournal.hpp"
+
+namespace StackBoost
+{
+    struct StackSnapshotEntry
+    {
+        int32_t* MaxStack;     // Field inside the row data
+        int32_t OriginalValue; // Value before the mod touched the row
+    };
+
+    // Target MaximumStack for a row: stackable items below the cap are raised to it,
+    // everything else (non-stackable, already larger) keeps its original value
+    inline int32_t ApplyMaxStackRule(int32_t originalValue, int32_t maxStack)
+    {
+        return (originalValue > 0 && originalValue < maxStack) ? maxStack : originalValue;
+    }
+
+    template <typename RowMap>
+    class StackPatchCore
+    {
+    public:
+        using KeyType = std::remove_cv_t<std::remove_reference_t<decltype((*std::declval<const RowMap&>().begin()).Key)>>;
+
+        // Identifies the row set the snapshot was built from. A reloaded or
+        // re-imported table reallocates its rows, so the first row pointer changes.
+        bool IsCurrent(const void* table, const RowMap& rowMap) const
+        {
+            if (m_entries.empty() || m_table != table || m_rowCount != rowMap.Num())
+            {
+                return false;
+            }
+            return rowMap.Num() == 0 || (*rowMap.begin()).Value == m_firstRow;
+        }
+
+        // Captures every row's current MaximumStack as its original value, in one pass
+        void Build(const void* table, const RowMap& rowMap, FieldAccessor<int32_t> maxStackField)
+        {
+            Clear();
+            m_entries.reserve(rowMap.Num());
+            m_keys.reserve(rowMap.Num());
+
+            for (const auto& pair : rowMap)
+            {
+                unsigned char* rowData = pair.Value;
+                if (!rowData) continue;
+
+                int32_t* maxStackPtr = maxStackField.Ptr(rowData);
+                m_entries.push_back({maxStackPtr, *maxStackPtr});
+                m_keys.push_back(pair.Key);
+            }
+
+            m_table = table;
+            m_rowCount = rowMap.Num();
+            m_firstRow = rowMap.Num() > 0 ? (*rowMap.begin()).Value : nullptr;
+        }
+
+        void Clear()
+        {
+            m_entries.clear();
+            m_keys.clear();
+            m_table = nullptr;
+            m_rowCount = 0;
+            m_firstRow = nullptr;
+        }
+
+        bool Empty() const { return m_entries.empty(); }
+        size_t Size() const { return m_entries.size(); }
+        const std::vector<StackSnapshotEntry>& Entries() const { return m_entries; }
+        const std::vector<KeyType>& Keys() const { return m_keys; }
+
+    private:
+        std::vector<StackSnapshotEntry> m_entries;
+        std::vector<KeyType> m_keys; // Parallel to m_entries, kept out of the hot sweep
+        const void* m_table = nullptr;
+        int32_t m_rowCount = 0;
+        unsigned char* m_firstRow = nullptr;
+    };
+
+    // Raises MaximumStack for a handful of rows (the items of one inventory exchange)
+    // through a journal layer, so reverting the layer puts exactly those rows back.
+    template <size_t MaxRows>
+    class TargetedStackPatch
+    {
+    public:
+        // Looks up each key and raises its row in layer. Returns false if any key
+        // is not a row of the table; the caller should then revert the layer and
+        // fall back to a full pass. Keys equal to skipKey (empty slots) are ignored.
+        template <typename RowMap, typename KeyType>
+        bool Patch(PatchJournal& journal, PatchJournal::LayerId layer, RowMap& rowMap, const KeyType* keys, size_t keyCount,
+                   const KeyType& skipKey, FieldAccessor<int32_t> maxStackField, int32_t maxStack)
+        {
+            return PatchWithTargets(journal, layer, rowMap, keys, keyCount, skipKey, maxStackField,
+                                    [maxStack](int32_t*, int32_t originalValue) { return ApplyMaxStackRule(originalValue, maxStack); });
+        }
+
+        // Same, with the per-row target supplied by targetFor(int32_t* field, int32_t original)
+        template <typename RowMap, typename KeyType, typename TargetFor>
+        bool PatchWithTargets(PatchJournal& journal, PatchJournal::LayerId layer, RowMap& rowMap, const KeyType* keys,
+                              size_t keyCount, const KeyType& skipKey, FieldAccessor<int32_t> maxStackField, TargetFor&& targetFor)
+        {
+            m_count = 0;
+            for (size_t k = 0; k < keyCount; ++k)
+            {
+                if (keys[k] == skipKey)
+                {
+                    continue;
+                }
+
+                unsigned char** rowDataPtr = rowMap.Find(keys[k]);
+                if (!rowDataPtr || !*rowDataPtr)
+                {
+                    return false;
+                }
+
+                int32_t* maxStackPtr = maxStackField.Ptr(*rowDataPtr);
+                bool alreadyTouched = false;
+                for (size_t i = 0; i < m_count; ++i)
+                {
+                    alreadyTouched |= m_rows[i] == maxStackPtr;
+                }
+                if (alreadyTouched || m_count == MaxRows)
+                {
+                    continue;
+                }
+
+                if (journal.Write(layer, maxStackPtr, targetFor(maxStackPtr, *maxStackPtr)))
+                {
+                    m_rows[m_count++] = maxStackPtr;
+                }
+            }
+            return true;
+        }
+
+        // Rows written by the last Patch
+        size_t Count() const { return m_count; }
+
+    private:
+        std::array<int32_t*, MaxRows> m_rows{};
+        size_t m_count = 0;
+    };
+}
@@ -0,0 +1,577 @@
+#pragma once
+
+/**
+ * TableExport - streams a DataTable's rows to disk and diffs two dumps
+ *
+ * The writer takes rows one at a time and never holds more than one block of
+ * them, so a table of any size is dumped in bounded memory. The schema (every
+ * reflected field with its offset, size and type) is written first; values
+ * follow as blocks of BlockRows rows, each stored column by column:
+ *
+ *   Header   "ISBT", version, table name, row struct name
+ *   Schema   field count, then per field: name, offset, size, type, exported
+ *   Block*   row count (0 ends the file), row names, one column per exported field
+ *   Trailer  total row count
+ *
+ * Strings are UTF-16 code units with a 16-bit length, so dumps made on Windows
+ * read the same on Linux. Numeric and bool columns are the field's raw bytes;
+ * Name columns are the name text. Struct and other fields are listed in the
+ * schema but not exported.
+ *
+ * CSV output is the same rows as text (exported fields only, no schema), for
+ * spreadsheets. Only binary dumps can be read back.
+ *
+ * TableDump and DiffTableDumps are the reading side, used by the host diff
+ * tool: fields are matched by name, so a field that moved between game builds
+ * is reported as moved and its values are still compared.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "FieldLayout.hpp"
+
+namespace StackBoost
+{
+    enum class TableExportFormat : uint8_t
+    {
+        Binary,
+        Csv,
+    };
+
+    namespace Detail
+    {
+        constexpr char TableExportMagic[4] = {'I', 'S', 'B', 'T'};
+        constexpr uint32_t TableExportVersion = 1;
+
+        inline bool IsExportedField(FieldType type)
+        {
+            return (type >= FieldType::Int8 && type <= FieldType::Bool) || type == FieldType::Name;
+        }
+
+        inline void AppendBytes(std::vector<unsigned char>& out, const void* data, size_t size)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            out.insert(out.end(), bytes, bytes + size);
+        }
+
+        inline void AppendExportString(std::vector<unsigned char>& out, std::wstring_view text)
+        {
+            uint16_t length = static_cast<uint16_t>(std::min<size_t>(text.size(), UINT16_MAX));
+            AppendBytes(out, &length, sizeof(length));
+            for (size_t i = 0; i < length; ++i)
+            {
+                uint16_t unit = static_cast<uint16_t>(text[i]);
+                AppendBytes(out, &unit, sizeof(unit));
+            }
+        }
+
+        // Shortest text that reads back as the same value
+        inline std::wstring FormatExportValue(FieldType type, const unsigned char* bytes)
+        {
+            auto read = [bytes](auto value) {
+                std::memcpy(&value, bytes, sizeof(value));
+                return value;
+            };
+            char text[40];
+            switch (type)
+            {
+            case FieldType::Int8: std::snprintf(text, sizeof(text), "%d", read(int8_t{})); break;
+            case FieldType::Int16: std::snprintf(text, sizeof(text), "%d", read(int16_t{})); break;
+            case FieldType::Int32: std::snprintf(text, sizeof(text), "%d", read(int32_t{})); break;
+            case FieldType::Int64: std::snprintf(text, sizeof(text), "%lld", static_cast<long long>(read(int64_t{}))); break;
+            case FieldType::UInt8: std::snprintf(text, sizeof(text), "%u", read(uint8_t{})); break;
+            case FieldType::UInt16: std::snprintf(text, sizeof(text), "%u", read(uint16_t{})); break;
+            case FieldType::UInt32: std::snprintf(text, sizeof(text), "%u", read(uint32_t{})); break;
+            case FieldType::UInt64: std::snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(read(uint64_t{}))); break;
+            case FieldType::Float: std::snprintf(text, sizeof(text), "%.9g", read(float{})); break;
+            case FieldType::Double: std::snprintf(text, sizeof(text), "%.17g", read(double{})); break;
+            case FieldType::Bool: return bytes[0] != 0 ? L"true" : L"false";
+            default: return {};
+            }
+            return std::wstring(text, text + std::strlen(text));
+        }
+
+        // Row and field names are ASCII; anything else is narrowed as-is
+        inline void AppendCsvText(std::string& out, std::wstring_view text)
+        {
+            bool quote = text.find_first_of(L",\"\r\n") != std::wstring_view::npos;
+            if (quote) out += '"';
+            for (wchar_t c : text)
+            {
+                if (c == L'"') out += '"';
+                out += static_cast<char>(c);
+            }
+            if (quote) out += '"';
+        }
+    }
+
+    class TableExportWriter
+    {
+    public:
+        static constexpr size_t BlockRows = 256;
+
+        // Turns the FName at a Name field into text; unused if the struct has no Name fields
+        using NameText = std::function<std::wstring(const unsigned char* field)>;
+
+        bool Open(const std::filesystem::path& path, TableExportFormat format, std::wstring_view table,
+                  std::wstring_view rowStruct, const FieldLayout& layout, NameText nameText = {})
+        {
+            m_format = format;
+            m_nameText = std::move(nameText);
+            m_rows = 0;
+            m_pendingRows = 0;
+            m_fields = layout.Fields();
+            m_columns.clear();
+            for (size_t i = 0; i < m_fields.size(); ++i)
+            {
+                if (Detail::IsExportedField(m_fields[i].Type) && (m_fields[i].Type != FieldType::Name || m_nameText))
+                {
+                    m_columns.push_back({i, {}});
+                }
+            }
+
+            m_file.open(path, std::ios::binary | std::ios::trunc);
+            if (!m_file)
+            {
+                return false;
+            }
+
+            if (m_format == TableExportFormat::Csv)
+            {
+                std::string line = "Row";
+                for (const Column& column : m_columns)
+                {
+                    line += ',';
+                    Detail::AppendCsvText(line, m_fields[column.Field].Name);
+                }
+                line += '\n';
+                m_file.write(line.data(), static_cast<std::streamsize>(line.size()));
+                return static_cast<bool>(m_file);
+            }
+
+            std::vector<unsigned char> header;
+            Detail::AppendBytes(header, Detail::TableExportMagic, sizeof(Detail::TableExportMagic));
+            Detail::AppendBytes(header, &Detail::TableExportVersion, sizeof(Detail::TableExportVersion));
+            Detail::AppendExportString(header, table);
+            Detail::AppendExportString(header, rowStruct);
+            uint32_t fieldCount = static_cast<uint32_t>(m_fields.size());
+            Detail::AppendBytes(header, &fieldCount, sizeof(fieldCount));
+            for (size_t i = 0; i < m_fields.size(); ++i)
+            {
+                const FieldInfo& field = m_fields[i];
+                uint8_t type = static_cast<uint8_t>(field.Type);
+                uint8_t exported = std::any_of(m_columns.begin(), m_columns.end(), [i](const Column& c) { return c.Field == i; });
+                Detail::AppendExportString(header, field.Name);
+                Detail::AppendBytes(header, &field.Offset, sizeof(field.Offset));
+                Detail::AppendBytes(header, &field.Size, sizeof(field.Size));
+                Detail::AppendBytes(header, &type, sizeof(type));
+                Detail::AppendBytes(header, &exported, sizeof(exported));
+            }
+            Write(header);
+            return static_cast<bool>(m_file);
+        }
+
+        void AddRow(std::wstring_view rowName, const unsigned char* row)
+        {
+            ++m_rows;
+            if (m_format == TableExportFormat::Csv)
+            {
+                m_line.clear();
+                Detail::AppendCsvText(m_line, rowName);
+                for (const Column& column : m_columns)
+                {
+                    const FieldInfo& field = m_fields[column.Field];
+                    m_line += ',';
+                    if (field.Type == FieldType::Name)
+                    {
+                        Detail::AppendCsvText(m_line, m_nameText(row + field.Offset));
+                    }
+                    else if (field.Type == FieldType::Bool)
+                    {
+                        Detail::AppendCsvText(m_line, ReadBoolField(field, row) ? L"true" : L"false");
+                    }
+                    else
+                    {
+                        Detail::AppendCsvText(m_line, Detail::FormatExportValue(field.Type, row + field.Offset));
+                    }
+                }
+                m_line += '\n';
+                m_file.write(m_line.data(), static_cast<std::streamsize>(m_line.size()));
+                return;
+            }
+
+            Detail::AppendExportString(m_rowNames, rowName);
+            for (Column& column : m_columns)
+            {
+                const FieldInfo& field = m_fields[column.Field];
+                if (field.Type == FieldType::Name)
+                {
+                    Detail::AppendExportString(column.Bytes, m_nameText(row + field.Offset));
+                }
+                else if (field.Type == FieldType::Bool)
+                {
+                    // Stored as 0 or 1, without the other bits of a bitfield bool's byte
+                    uint64_t value = ReadBoolField(field, row) ? 1 : 0;
+                    Detail::AppendBytes(column.Bytes, &value, std::min<size_t>(field.Size, sizeof(value)));
+                }
+                else
+                {
+                    Detail::AppendBytes(column.Bytes, row + field.Offset, field.Size);
+                }
+            }
+            if (++m_pendingRows == BlockRows)
+            {
+                FlushBlock();
+            }
+        }
+
+        // Writes the last block and the trailer. Returns false if any write failed.
+        bool Close()
+        {
+            if (!m_file.is_open())
+            {
+                return false;
+            }
+            if (m_format == TableExportFormat::Binary)
+            {
+                FlushBlock();
+                uint32_t end = 0;
+                uint32_t total = static_cast<uint32_t>(m_rows);
+                m_file.write(reinterpret_cast<const char*>(&end), sizeof(end));
+                m_file.write(reinterpret_cast<const char*>(&total), sizeof(total));
+            }
+            bool ok = static_cast<bool>(m_file);
+            m_file.close();
+            return ok;
+        }
+
+        size_t Rows() const { return m_rows; }
+        size_t ExportedFields() const { return m_columns.size(); }
+
+    private:
+        struct Column
+        {
+            size_t Field; // Index into m_fields
+            std::vector<unsigned char> Bytes;
+        };
+
+        void FlushBlock()
+        {
+            if (m_pendingRows == 0)
+            {
+                return;
+            }
+            uint32_t rows = static_cast<uint32_t>(m_pendingRows);
+            m_file.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+            Write(m_rowNames);
+            m_rowNames.clear();
+            for (Column& column : m_columns)
+            {
+                Write(column.Bytes);
+                column.Bytes.clear();
+            }
+            m_pendingRows = 0;
+        }
+
+        void Write(const std::vector<unsigned char>& bytes)
+        {
+            m_file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        }
+
+        std::ofstream m_file;
+        TableExportFormat m_format = TableExportFormat::Binary;
+        NameText m_nameText;
+        std::vector<FieldInfo> m_fields;
+        std::vector<Column> m_columns;
+        std::vector<unsigned char> m_rowNames;
+        std::string m_line;
+        size_t m_rows = 0;
+        size_t m_pendingRows = 0;
+    };
+
+    // A binary dump read back whole (host tools only)
+    struct TableDump
+    {
+        struct Column
+        {
+            size_t Field; // Index into Layout.Fields()
+            std::vector<unsigned char> Bytes; // Numeric and bool fields: Size bytes per row
+            std::vector<std::wstring> Names;  // Name fields: one per row
+        };
+
+        std::wstring Table;
+        std::wstring RowStruct;
+        FieldLayout Layout;
+        std::vector<std::wstring> RowNames;
+        std::vector<Column> Columns;
+
+        const Column* FindColumn(std::wstring_view field) const
+        {
+            for (const Column& column : Columns)
+            {
+                if (Layout.Fields()[column.Field].Name == field) return &column;
+            }
+            return nullptr;
+        }
+
+        std::wstring Value(const Column& column, size_t row) const
+        {
+            const FieldInfo& field = Layout.Fields()[column.Field];
+            if (field.Type == FieldType::Name)
+            {
+                return column.Names[row];
+            }
+            return Detail::FormatExportValue(field.Type, column.Bytes.data() + row * field.Size);
+        }
+    };
+
+    namespace Detail
+    {
+        class ExportReader
+        {
+        public:
+            explicit ExportReader(std::ifstream& file) : m_file(file) {}
+
+            template <typename T>
+            bool Read(T& value)
+            {
+                return static_cast<bool>(m_file.read(reinterpret_cast<char*>(&value), sizeof(T)));
+            }
+
+            bool ReadString(std::wstring& text)
+            {
+                uint16_t length = 0;
+                if (!Read(length)) return false;
+                text.resize(length);
+                for (uint16_t i = 0; i < length; ++i)
+                {
+                    uint16_t unit = 0;
+                    if (!Read(unit)) return false;
+                    text[i] = static_cast<wchar_t>(unit);
+                }
+                return true;
+            }
+
+            bool ReadBytes(std::vector<unsigned char>& out, size_t size)
+            {
+                size_t start = out.size();
+                out.resize(start + size);
+                return size == 0 || static_cast<bool>(m_file.read(reinterpret_cast<char*>(out.data() + start), static_cast<std::streamsize>(size)));
+            }
+
+        private:
+            std::ifstream& m_file;
+        };
+    }
+
+    inline bool ReadTableDump(const std::filesystem::path& path, TableDump& dump, std::wstring* error = nullptr)
+    {
+        auto fail = [error](const wchar_t* message) {
+            if (error) *error = message;
+            return false;
+        };
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return fail(L"cannot open file");
+        }
+        Detail::ExportReader reader(file);
+
+        char magic[4] = {};
+        uint32_t version = 0;
+        if (!reader.Read(magic) || std::memcmp(magic, Detail::TableExportMagic, sizeof(magic)) != 0)
+        {
+            return fail(L"not a table dump");
+        }
+        if (!reader.Read(version) || version != Detail::TableExportVersion)
+        {
+            return fail(L"unsupported dump version");
+        }
+
+        dump = {};
+        uint32_t fieldCount = 0;
+        if (!reader.ReadString(dump.Table) || !reader.ReadString(dump.RowStruct) || !reader.Read(fieldCount))
+        {
+            return fail(L"truncated header");
+        }
+        for (uint32_t i = 0; i < fieldCount; ++i)
+        {
+            FieldInfo field;
+            uint8_t type = 0;
+            uint8_t exported = 0;
+            if (!reader.ReadString(field.Name) || !reader.Read(field.Offset) || !reader.Read(field.Size) ||
+                !reader.Read(type) || !reader.Read(exported))
+            {
+                return fail(L"truncated schema");
+            }
+            field.Type = static_cast<FieldType>(type);
+            if (exported)
+            {
+                dump.Columns.push_back({i, {}, {}});
+            }
+            dump.Layout.Add(std::move(field));
+        }
+
+        for (;;)
+        {
+            uint32_t rows = 0;
+            if (!reader.Read(rows))
+            {
+                return fail(L"truncated block");
+            }
+            if (rows == 0)
+            {
+                break;
+            }
+            for (uint32_t r = 0; r < rows; ++r)
+            {
+                dump.RowNames.emplace_back();
+                if (!reader.ReadString(dump.RowNames.back())) return fail(L"truncated row names");
+            }
+            for (TableDump::Column& column : dump.Columns)
+            {
+                const FieldInfo& field = dump.Layout.Fields()[column.Field];
+                if (field.Type == FieldType::Name)
+                {
+                    for (uint32_t r = 0; r < rows; ++r)
+                    {
+                        column.Names.emplace_back();
+                        if (!reader.ReadString(column.Names.back())) return fail(L"truncated name column");
+                    }
+                }
+                else if (!reader.ReadBytes(column.Bytes, static_cast<size_t>(rows) * field.Size))
+                {
+                    return fail(L"truncated column");
+                }
+            }
+        }
+
+        uint32_t total = 0;
+        if (!reader.Read(total) || total != dump.RowNames.size())
+        {
+            return fail(L"row count does not match the trailer");
+        }
+        return true;
+    }
+
+    struct TableDumpDiff
+    {
+        struct FieldChange
+        {
+            std::wstring Name;
+            const FieldInfo* Old = nullptr; // Null if added
+            const FieldInfo* New = nullptr; // Null if removed
+        };
+        struct ValueChange
+        {
+            std::wstring Row;
+            std::wstring Field;
+            std::wstring Old;
+            std::wstring New;
+        };
+
+        std::vector<FieldChange> Fields; // Added, removed, moved or retyped
+        std::vector<std::wstring> RowsAdded;
+        std::vector<std::wstring> RowsRemoved;
+        std::vector<ValueChange> Values;
+        size_t FieldsCompared = 0;
+
+        bool Empty() const { return Fields.empty() && RowsAdded.empty() && RowsRemoved.empty() && Values.empty(); }
+    };
+
+    // Compares two dumps of the same table. Fields are matched by name and rows by
+    // row name; only rows and fields present in both have their values compared.
+    // fieldFilter (if not empty) limits value comparison to those fields.
+    inline TableDumpDiff DiffTableDumps(const TableDump& before, const TableDump& after,
+                                        const std::vector<std::wstring>& fieldFilter = {})
+    {
+        TableDumpDiff diff;
+        for (const FieldInfo& field : before.Layout.Fields())
+        {
+            const FieldInfo* other = after.Layout.Find(field.Name);
+            if (!other || other->Offset != field.Offset || other->Size != field.Size || other->Type != field.Type)
+            {
+                diff.Fields.push_back({field.Name, &field, other});
+            }
+        }
+        for (const FieldInfo& field : after.Layout.Fields())
+        {
+            if (!before.Layout.Find(field.Name))
+            {
+                diff.Fields.push_back({field.Name, nullptr, &field});
+            }
+        }
+
+        std::unordered_map<std::wstring, size_t> afterRows;
+        afterRows.reserve(after.RowNames.size());
+        for (size_t i = 0; i < after.RowNames.size(); ++i)
+        {
+            afterRows.emplace(after.RowNames[i], i);
+        }
+
+        // Columns comparable by value: same name, same type and size on both sides
+        struct Pair
+        {
+            const TableDump::Column* Before;
+            const TableDump::Column* After;
+            const FieldInfo* Field;
+        };
+        std::vector<Pair> pairs;
+        for (const TableDump::Column& column : before.Columns)
+        {
+            const FieldInfo& field = before.Layout.Fields()[column.Field];
+            if (!fieldFilter.empty() && std::find(fieldFilter.begin(), fieldFilter.end(), field.Name) == fieldFilter.end())
+            {
+                continue;
+            }
+            const TableDump::Column* other = after.FindColumn(field.Name);
+            if (other && after.Layout.Fields()[other->Field].Type == field.Type && after.Layout.Fields()[other->Field].Size == field.Size)
+            {
+                pairs.push_back({&column, other, &field});
+            }
+        }
+        diff.FieldsCompared = pairs.size();
+
+        std::vector<uint8_t> matched(after.RowNames.size(), 0);
+        for (size_t row = 0; row < before.RowNames.size(); ++row)
+        {
+            auto found = afterRows.find(before.RowNames[row]);
+            if (found == afterRows.end())
+            {
+                diff.RowsRemoved.push_back(before.RowNames[row]);
+                continue;
+            }
+            size_t otherRow = found->second;
+            matched[otherRow] = 1;
+            for (const Pair& pair : pairs)
+            {
+                bool same = pair.Field->Type == FieldType::Name
+                    ? pair.Before->Names[row] == pair.After->Names[otherRow]
+                    : std::memcmp(pair.Before->Bytes.data() + row * pair.Field->Size,
+                                  pair.After->Bytes.data() + otherRow * pair.Field->Size, pair.Field->Size) == 0;
+                if (!same)
+                {
+                    diff.Values.push_back({before.RowNames[row], pair.Field->Name,
+                                           before.Value(*pair.Before, row), after.Value(*pair.After, otherRow)});
+                }
+            }
+        }
+        for (size_t row = 0; row < after.RowNames.size(); ++row)
+        {
+            if (!matched[row]) diff.RowsAdded.push_back(after.RowNames[row]);
+        }
+        return diff;
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+/**
+ * VirtualStackLimits - stack limits served from hooks instead of DT_Enemies
+ *
+ * The effective MaximumStack of every overridden row is kept in a dense array
+ * indexed by the row name's FName comparison index (offset by the smallest
+ * one, so the array only spans the table's names). A limit query is one
+ * subtraction, one bounds check and one load; the table itself is never
+ * written, so there is nothing to restore and nothing left behind if the mod
+ * unloads in the middle of anything.
+ *
+ * Each Build produces a new immutable array. Patching publishes it with one
+ * atomic pointer store and restoring publishes null, so readers on any thread
+ * see either the old or the new limits, never a mix. Arrays are kept until the
+ * object is destroyed (a config reload adds one), so a reader that loaded a
+ * pointer just before a swap can still use it.
+ *
+ * Row names that differ only in their FName number (Item_1, Item_2) share a
+ * comparison index; those slots point into a small sorted side table instead.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace StackBoost
+{
+    class VirtualStackLimits
+    {
+    public:
+        static constexpr int32_t NoOverride = INT32_MIN;
+        // Name spans larger than this (16 MB of limits) are refused rather than allocated
+        static constexpr size_t MaxDenseSpan = size_t{1} << 22;
+
+        class Limits
+        {
+        public:
+            // The limit for a row name, or NoOverride if the game's own value stands
+            int32_t Find(uint32_t comparisonIndex, uint32_t number) const
+            {
+                uint32_t slot = comparisonIndex - m_base;
+                if (slot >= m_values.size())
+                {
+                    return NoOverride;
+                }
+                int32_t value = m_values[slot];
+                return value == Shared ? FindShared(comparisonIndex, number) : value;
+            }
+
+            size_t Overrides() const { return m_overrides; }
+            size_t Span() const { return m_values.size(); }
+
+        private:
+            friend class VirtualStackLimits;
+            static constexpr int32_t Shared = INT32_MIN + 1;
+
+            int32_t FindShared(uint32_t comparisonIndex, uint32_t number) const
+            {
+                uint64_t key = (uint64_t{comparisonIndex} << 32) | number;
+                auto found = std::lower_bound(m_shared.begin(), m_shared.end(), std::make_pair(key, INT32_MIN));
+                return found != m_shared.end() && found->first == key ? found->second : NoOverride;
+            }
+
+            uint32_t m_base = 0;
+            std::vector<int32_t> m_values;
+            std::vector<std::pair<uint64_t, int32_t>> m_shared; // Sorted by (comparison index, number)
+            size_t m_overrides = 0;
+        };
+
+        // keys[i] is the row name of entries with originals[i] and targets[i] (parallel
+        // to the patch snapshot). Rows whose target equals the original are left out.
+        // Returns false, keeping the previous build, if the names are too sparse.
+        template <typename KeyType>
+        bool Build(const std::vector<KeyType>& keys, const std::vector<int32_t>& originals, const std::vector<int32_t>& targets)
+        {
+            size_t count = std::min({keys.size(), originals.size(), targets.size()});
+            uint32_t lowest = UINT32_MAX;
+            uint32_t highest = 0;
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (targets[i] == originals[i]) continue;
+                lowest = std::min<uint32_t>(lowest, keys[i].GetComparisonIndex());
+                highest = std::max<uint32_t>(highest, keys[i].GetComparisonIndex());
+            }
+
+            auto limits = std::make_unique<Limits>();
+            if (lowest <= highest)
+            {
+                if (size_t{highest} - lowest + 1 > MaxDenseSpan)
+                {
+                    return false;
+                }
+                limits->m_base = lowest;
+                limits->m_values.assign(size_t{highest} - lowest + 1, NoOverride);
+            }
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (targets[i] == originals[i]) continue;
+                uint32_t comparisonIndex = keys[i].GetComparisonIndex();
+                uint64_t key = (uint64_t{comparisonIndex} << 32) | static_cast<uint32_t>(keys[i].GetNumber());
+                int32_t& slot = limits->m_values[comparisonIndex - lowest];
+                limits->m_shared.emplace_back(key, targets[i]);
+                slot = slot == NoOverride ? targets[i] : Limits::Shared;
+                limits->m_overrides++;
+            }
+
+            // Only names that share a slot need the side table
+            limits->m_shared.erase(std::remove_if(limits->m_shared.begin(), limits->m_shared.end(),
+                                                  [&](const std::pair<uint64_t, int32_t>& entry) {
+                                                      return limits->m_values[(entry.first >> 32) - lowest] != Limits::Shared;
+                                                  }),
+                                   limits->m_shared.end());
+            std::sort(limits->m_shared.begin(), limits->m_shared.end());
+
+            bool active = Active() != nullptr;
+            m_built.push_back(std::move(limits));
+            if (active)
+            {
+                Activate(); // A rebuild while patched takes effect at once
+            }
+            return true;
+        }
+
+        // Publishes the latest build; false if nothing has been built yet
+        bool Activate()
+        {
+            if (m_built.empty())
+            {
+                return false;
+            }
+            m_active.store(m_built.back().get(), std::memory_order_release);
+            return true;
+        }
+
+        void Deactivate()
+        {
+            m_active.store(nullptr, std::memory_order_release);
+        }
+
+        // Null when limits are off; safe from any thread
+        const Limits* Active() const
+        {
+            return m_active.load(std::memory_order_acquire);
+        }
+
+        bool IsActive() const { return Active() != nullptr; }
+        bool HasBuild() const { return !m_built.empty(); }
+        const Limits* Latest() const { return m_built.empty() ? nullptr : m_built.back().get(); }
+
+    private:
+        std::vector<std::unique_ptr<Limits>> m_built; // Built on one thread (the update/patch owner)
+        std::atomic<const Limits*> m_active{nullptr};
+    };
+}
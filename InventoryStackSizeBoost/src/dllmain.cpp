@@ -4,9 +4,15 @@
  * This mod patches the EnemyConfig DataTable to increase MaximumStack for all items.
  */
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <string>
-#include <unordered_map>
 #define NOMINMAX  // Prevent Windows.h from defining min/max macros
 #include <Windows.h>
 #include <Mod/CppUserModBase.hpp>
@@ -21,21 +27,164 @@
 #include <Unreal/CoreUObject/UObject/Class.hpp>
 #include <Unreal/UScriptStruct.hpp>
 #include <Unreal/UFunctionStructs.hpp>
+#include <Unreal/Property/FStructProperty.hpp>
+#include <Unreal/Property/FArrayProperty.hpp>
+#include <Input/Handler.hpp>
+#include <LuaMadeSimple/LuaMadeSimple.hpp>
+#include <Unreal/Hooks.hpp>
+#include <LuaType/LuaUObject.hpp>
+#include "ObjectDiscovery.hpp"
+#include "FunctionResolver.hpp"
+#include "RowStructLayout.hpp"
+#include "StackPatchCore.hpp"
+#include "AsyncLog.hpp"
+#include "HookStats.hpp"
+#include "ModPaths.hpp"
+#include "StackConfig.hpp"
+#include "FileWatcher.hpp"
+#include "PeriodicWorker.hpp"
+#include "RetryScheduler.hpp"
+#include "PatchEngine.hpp"
+#include "PatchJournal.hpp"
+#include "PatchState.hpp"
+#include "VirtualStackLimits.hpp"
+#include "DiscoveryCache.hpp"
+#include "InventorySorter.hpp"
+#include "StackCompactor.hpp"
+#include "FrameScheduler.hpp"
+#include "TableExport.hpp"
+#include "LuaBridge.hpp"
+#include "IncrementalSweep.hpp"
 
 using namespace RC;
 using namespace RC::Unreal;
+using StackBoost::ObjectDiscovery;
+using StackBoost::FunctionResolver;
+using StackBoost::FieldAccessor;
+using StackBoost::FieldCheck;
+using StackBoost::FieldExpectation;
+using StackBoost::RowField;
+using StackBoost::FieldLayout;
+using StackBoost::FieldType;
+using StackBoost::RowStructLayoutCache;
+using StackBoost::StackPatchCore;
+using StackBoost::PatchStateMachine;
+using StackBoost::VirtualStackLimits;
+using StackBoost::AsyncLog;
+using StackBoost::AsyncLogEventSpec;
+using StackBoost::AsyncLogLevel;
+using StackBoost::HookStats;
+using StackBoost::ScopedHookTimer;
+using StackBoost::StatsRegistry;
+using StackBoost::StackConfig;
+using StackBoost::StackRuleTable;
+using StackBoost::FileWatcher;
+using StackBoost::PeriodicWorker;
+using StackBoost::RetryScheduler;
+using StackBoost::PatchGroup;
+using StackBoost::TablePatch;
+using StackBoost::ObjectPatch;
+using StackBoost::PatchJournal;
+using StackBoost::DiscoveryCache;
+using StackBoost::IncrementalSlotSorter;
+using StackBoost::StackCompactor;
+using StackBoost::FrameScheduler;
+using StackBoost::TableExportWriter;
+using StackBoost::TableExportFormat;
+using StackBoost::KeyedRequestQueue;
+using StackBoost::ObjectLookupCache;
+using StackBoost::IncrementalSweep;
 
 // =============================================================================
 // Configuration
 // =============================================================================
 
+// Stack rules are read from <mod folder>/stack_config.ini and reloaded when it
+// changes; MAX_STACK is only the fallback when the file is missing or invalid
 constexpr int32_t MAX_STACK = 1000;
+constexpr const wchar_t* CONFIG_FILE_NAME = STR("stack_config.ini");
+constexpr int CONFIG_POLL_INTERVAL_MS = 1000;
+
+// Declarative edits to any DataTable (see PatchEngine.hpp), applied as each table loads
+constexpr const wchar_t* PATCHES_FILE_NAME = STR("table_patches.ini");
+
+// Where DT_Enemies, the hook targets and patched tables were found, reused on
+// the next launch while the game executable and paks are unchanged
+constexpr const wchar_t* DISCOVERY_CACHE_FILE_NAME = STR("discovery_cache.bin");
+
+// Discovery retries back off exponentially in wall time, not frames, and run until
+// they succeed (the player may sit in the main menu for any length of time). Patch
+// sections whose table or class never loads stop after about ten minutes; saving
+// table_patches.ini, or a Lua mod sending its patch again, schedules them again.
+constexpr std::chrono::milliseconds TABLE_RETRY_INITIAL{100};
+constexpr std::chrono::milliseconds TABLE_RETRY_MAX{2000};
+constexpr unsigned TABLE_PATCH_RETRY_ATTEMPTS = 300;
+constexpr std::chrono::milliseconds HOOK_RETRY_INITIAL{500};
+constexpr std::chrono::milliseconds HOOK_RETRY_MAX{8000};
+
+// Game-thread work posted from hooks, keybinds and Lua runs at the start of the
+// next frame, once per (target, action) however often it was posted. A full
+// RearrangePlayerInventory additionally waits this long after the previous one.
+constexpr std::chrono::milliseconds REARRANGE_INTERVAL{350};
+
+// Hook statistics are written to <mod folder>/hook_stats.txt on Shift+L and
+// every STATS_DUMP_INTERVAL_SECONDS (0 = hotkey only)
+constexpr int STATS_DUMP_INTERVAL_SECONDS = 300;
+constexpr const wchar_t* STATS_FILE_NAME = STR("hook_stats.txt");
+
+// Shift+E writes the tables named by ExportTables in stack_config.ini to
+// <mod folder>/exports as <table>-<build>.isbt (for host/TableDiff) and .csv
+constexpr const wchar_t* EXPORT_DIRECTORY_NAME = STR("exports");
 
-// FBeltTDEnemyConfig struct layout (discovered via runtime analysis):
-// MaximumStack @ offset 0x5C (size 4) - the item's max stack size
-// SellCanStack @ offset 0x99 (size 1) - whether item can stack
-constexpr size_t OFFSET_MAXIMUM_STACK = 0x5C;
-constexpr size_t OFFSET_SELL_CAN_STACK = 0x99;
+// FBeltTDEnemyConfig struct layout (discovered via runtime analysis).
+// The real offsets are resolved from reflection when DT_Enemies is found;
+// these are only checked against it so layout changes get reported.
+// `InventoryStackSizeBoostTableDiff <dump> --expectations` prints these lines.
+namespace EnemyConfig
+{
+    constexpr RowField<int32_t, 0x5C> MaximumStack{STR("MaximumStack")}; // The item's max stack size
+    constexpr RowField<bool, 0x99> SellCanStack{STR("SellCanStack")};    // Whether the item can stack
+}
+
+constexpr auto ENEMY_CONFIG_FIELDS = StackBoost::RowExpectations(EnemyConfig::MaximumStack, EnemyConfig::SellCanStack);
+static_assert(StackBoost::RowFieldsDisjoint(ENEMY_CONFIG_FIELDS), "FBeltTDEnemyConfig fields overlap");
+
+// Hot-path log events. Hooks record these as binary records; the log thread
+// formats them. Order must match LOG_EVENTS.
+enum LogEvent : uint16_t
+{
+    LOG_ITEM_TOTAL_STACK,
+    LOG_EXCHANGE_PRE_SKIPPED,
+    LOG_EXCHANGE_POST_SKIPPED,
+    LOG_EXCHANGE_BUSY,
+    LOG_EXCHANGE_FALLBACK,
+    LOG_EXCHANGE_ROWS_TOUCHED,
+    LOG_STACKS_PATCHED_QUIET,
+    LOG_STACKS_RESTORED_QUIET,
+    LOG_RESTORING_ROW,
+    LOG_INVENTORY_SORTED,
+    LOG_INVENTORY_COMPACTED,
+    LOG_STACK_PATCH_PROGRESS,
+    LOG_STACK_RESTORE_PROGRESS,
+    LOG_EVENT_COUNT
+};
+
+constexpr AsyncLogEventSpec LOG_EVENTS[LOG_EVENT_COUNT] = {
+    // LOG_ITEM_TOTAL_STACK: fires on every inventory UI refresh, so verbose only and rate limited
+    {STR("[InventoryStackSizeBoost] GetItemTotalStack called on {} -> ReturnValue: {}\n"), "xd", AsyncLogLevel::Verbose, 1, 10},
+    {STR("[InventoryStackSizeBoost] TryExchangeInventorySlot pre-hook: Skipping (manual patch active)\n"), "", AsyncLogLevel::Verbose, 1, 10},
+    {STR("[InventoryStackSizeBoost] TryExchangeInventorySlot post-hook: Skipping restore (manual patch active)\n"), "", AsyncLogLevel::Verbose, 1, 10},
+    {STR("[InventoryStackSizeBoost] TryExchangeInventorySlot pre-hook: Skipping (rows busy with another update, {} so far)\n"), "u", AsyncLogLevel::Verbose, 1, 10},
+    {STR("[InventoryStackSizeBoost] TryExchangeInventorySlot pre-hook: Item not identified, patching all stacks...\n"), "", AsyncLogLevel::Verbose, 1, 10},
+    {STR("[InventoryStackSizeBoost] TryExchangeInventorySlot: {} row(s) touched this call ({} total over {} calls, {} full-table fallbacks)\n"), "uuuu", AsyncLogLevel::Verbose, 1, 20},
+    {STR("[InventoryStackSizeBoost] Patched {} items to configured stack sizes\n"), "d", AsyncLogLevel::Verbose, 1, 20},
+    {STR("[InventoryStackSizeBoost] Restored {} items to default\n"), "d", AsyncLogLevel::Verbose, 1, 20},
+    {STR("[InventoryStackSizeBoost] Restoring '{}': {} -> {}\n"), "ndd", AsyncLogLevel::Verbose, 1, 0},
+    {STR("[InventoryStackSizeBoost] Inventory sorted: {} slot(s) changed, {} of {} moved\n"), "uuu", AsyncLogLevel::Verbose, 1, 20},
+    {STR("[InventoryStackSizeBoost] Inventory compacted: {} slot(s) written, {} emptied\n"), "uu", AsyncLogLevel::Default, 1, 0},
+    {STR("[InventoryStackSizeBoost] Patching stacks: {} of {} rows done\n"), "uu", AsyncLogLevel::Verbose, 1, 0},
+    {STR("[InventoryStackSizeBoost] Restoring stacks: {} of {} fields done\n"), "uu", AsyncLogLevel::Verbose, 1, 0},
+};
 
 // =============================================================================
 // Mod Class
@@ -44,8 +193,6 @@ constexpr size_t OFFSET_SELL_CAN_STACK = 0x99;
 class InventoryStackSizeBoost : public CppUserModBase
 {
 public:
-    bool m_patched = false;
-    int m_update_count = 0;
     bool m_hook_registered = false;
     std::pair<int, int> m_hook_ids = {-1, -1};
     UFunction* m_getItemTotalStackFunction = nullptr;
@@ -55,13 +202,211 @@ public:
     std::pair<int, int> m_tryExchange_hook_ids = {-1, -1};
     UFunction* m_tryExchangeFunction = nullptr;
     
+    // Targeted exchange patching: only the rows of the items being exchanged are touched
+    enum class ExchangePatchMode { None, Targeted, Full };
+    struct ExchangeCounters
+    {
+        uint64_t Calls = 0;
+        uint64_t FallbackCalls = 0;
+        uint64_t RowsTouched = 0;
+        uint32_t LastRowsTouched = 0;
+    };
+    static constexpr size_t MAX_EXCHANGE_ITEMS = 8;
+    std::vector<uint32_t> m_exchangeItemNameOffsets; // FName locations in the parameter block
+    StackBoost::TargetedStackPatch<MAX_EXCHANGE_ITEMS> m_exchangePatch;
+    ExchangePatchMode m_exchangeMode = ExchangePatchMode::None;
+    ExchangeCounters m_exchangeCounters;              // Owner of the exchange only
+    std::atomic<uint64_t> m_exchangeBusyCalls{0};     // Exchanges that found the rows owned by someone else
+    
+    // All hook targets are matched in one object-array walk
+    FunctionResolver m_functionResolver;
+    size_t m_getItemTotalStackTarget = FunctionResolver::InvalidTarget;
+    size_t m_tryExchangeTarget = FunctionResolver::InvalidTarget;
+    size_t m_inventoryUpdateTarget = FunctionResolver::InvalidTarget;
+    std::vector<std::wstring> m_hookTargetKeys; // Discovery cache key per resolver target
+    
+    // Native auto-sort (AutoSort in stack_config.ini): the OnInventoryUpdate
+    // pre-hook re-sorts only the slots that changed since the last update
+    struct InventorySlotAccess
+    {
+        UClass* ControllerClass = nullptr;
+        size_t InventoryOffset = 0; // PlayerInventory on the controller
+        UClass* InventoryClass = nullptr;
+        size_t SlotsOffset = 0;     // Slot TArray on the inventory component
+        size_t SlotSize = 0;
+        size_t ItemNameOffset = 0;  // Item FName inside a slot
+        size_t CountOffset = 0;     // Stack size inside a slot, if HasCount
+        bool HasCount = false;
+        bool Valid = false;
+    };
+    struct ScriptArrayView
+    {
+        unsigned char* Data;
+        int32_t Num;
+        int32_t Max;
+    };
+    bool m_inventoryUpdate_hook_registered = false;
+    std::pair<int, int> m_inventoryUpdate_hook_ids = {-1, -1};
+    UFunction* m_inventoryUpdateFunction = nullptr;
+    InventorySlotAccess m_inventorySlots;
+    UObject* m_sortedInventory = nullptr;
+    IncrementalSlotSorter m_inventorySorter;
+    std::unordered_map<uint64_t, uint32_t> m_itemSortRanks; // DT_Enemies row order by packed item FName
+    std::vector<uint64_t> m_slotKeys;
+    std::vector<unsigned char> m_slotScratch;
+    std::vector<uint8_t> m_slotPlaced;
+    StackCompactor m_stackCompactor;
+    std::vector<int32_t> m_slotCounts;
+    
+    // Paths found on the last launch of this game build; lets startup use
+    // StaticFindObject instead of walking the object array
+    DiscoveryCache m_discoveryCache;
+    std::filesystem::path m_discoveryCachePath;
+    uint64_t m_buildKey = 0;
+    
     UDataTable* m_enemyDataTable = nullptr;
     
-    // Store original MaximumStack values for restoration
-    std::unordered_map<FName, int32_t> m_originalStackValues;
-    bool m_stacksArePatched = false; // Track if stacks are currently patched
-    bool m_jKeyPressed = false; // Track J key state to detect press
-    bool m_kKeyPressed = false; // Track K key state to detect press
+    // DT_Enemies is reported by the construct callback instead of being polled for
+    ObjectDiscovery m_discovery;
+    size_t m_enemyTableWatch = ObjectDiscovery::InvalidWatch;
+    
+    // Row struct fields, resolved once per UScriptStruct
+    RowStructLayoutCache m_rowLayouts;
+    FieldAccessor<int32_t> m_maxStackField;
+    
+    // Snapshot of every row's MaximumStack, built in one pass on first patch.
+    // Patch and restore sweep it directly instead of hashing row names.
+    StackPatchCore<TMap<FName, unsigned char*>> m_stackCore;
+    
+    // Every write to game memory goes through the journal, one layer per patch
+    // set, so each can be undone on its own without restoring stale values
+    PatchJournal m_journal;
+
+    // Patches sent by Lua mods (StackBoostPatch/StackBoostRevert), one journal
+    // layer per patch name. Queued from the Lua threads, applied on the game thread.
+    struct LuaPatchRequest
+    {
+        std::vector<PatchGroup> Groups; // Empty with Revert
+        bool Revert = false;
+    };
+    struct LuaPatchedObject
+    {
+        std::wstring Path;
+        UObject* Object;
+        bool IsTable = false;
+        TablePatch Table; // Tells whether the table's rows were replaced since
+    };
+    struct LuaPatchLayer
+    {
+        PatchJournal::LayerId Layer = PatchJournal::InvalidLayer;
+        std::vector<LuaPatchedObject> Objects;
+        std::vector<PatchGroup> Waiting; // Template sections whose class hasn't loaded yet
+    };
+    KeyedRequestQueue<LuaPatchRequest> m_luaPatchRequests;
+    std::unordered_map<std::wstring, LuaPatchLayer> m_luaPatchLayers;
+    ObjectLookupCache<UObject> m_luaObjects; // StackBoostFindObject and Lua patch targets
+    PatchJournal::LayerId m_stackLayer = PatchJournal::InvalidLayer;    // Manual patch (J)
+    PatchJournal::LayerId m_exchangeLayer = PatchJournal::InvalidLayer; // Targeted exchange rows or the full fallback
+    
+    // Exactly one writer at a time: the exchange hooks, J/K or the update action.
+    // The journal, the snapshot and m_config are only touched by the owner.
+    PatchStateMachine m_patchState;
+    static inline thread_local int t_exchangeDepth = 0;     // TryExchangeInventorySlot nesting on this thread
+    static inline thread_local bool t_exchangeOwner = false; // The outermost call on this thread owns the rows
+    
+    // VirtualStacks: J publishes the compiled targets for the GetItemTotalStack hook
+    // to answer from, K unpublishes them; DT_Enemies itself is not written
+    struct ItemInstanceAccess
+    {
+        UClass* InstanceClass = nullptr;
+        size_t ItemNameOffset = 0; // Item FName on the inventory instance
+        bool Valid = false;
+    };
+    VirtualStackLimits m_virtualLimits;
+    bool m_virtualLimitsCurrent = false; // Built from the current snapshot and rules
+    ItemInstanceAccess m_itemInstance;
+    
+    // Config rules, compiled to one target per snapshot entry whenever the
+    // snapshot is rebuilt or the config file changes
+    StackConfig m_config;
+    StackRuleTable m_stackRules;
+    bool m_stackRulesCurrent = false;
+    FileWatcher m_configWatcher;
+    
+    // table_patches.ini, one entry per [Table] or [/Game/...] template section.
+    // A template section watches for its Blueprint class instead of a table.
+    struct PatchTarget
+    {
+        PatchGroup Group;
+        size_t Watch = ObjectDiscovery::InvalidWatch;
+        UDataTable* Table = nullptr;
+        TablePatch Patch;
+        UObject* Template = nullptr;
+        ObjectPatch Object;
+        PatchJournal::LayerId Layer = PatchJournal::InvalidLayer;
+    };
+    std::vector<PatchTarget> m_patchTargets;
+    FileWatcher m_patchesWatcher;
+    
+    // Formats and writes hook-path log lines off the calling thread
+    AsyncLog m_log;
+    
+    // Per-entry-point call counts and latency histograms (dumped with Shift+L)
+    HookStats m_statsItemTotalStack{STR("GetItemTotalStack.post")};
+    HookStats m_statsExchangePre{STR("TryExchangeInventorySlot.pre")};
+    HookStats m_statsExchangePost{STR("TryExchangeInventorySlot.post")};
+    HookStats m_statsInventoryUpdate{STR("OnInventoryUpdate.pre")};
+    HookStats m_statsUpdate{STR("update")};
+    HookStats m_statsFrame{STR("frame actions")};
+    StatsRegistry m_statsRegistry;
+    PeriodicWorker m_statsDumper;
+    std::mutex m_statsDumpMutex; // Hotkey and timer dumps can overlap
+    
+    // Everything that touches game memory outside a hook runs as a frame action
+    // on the game thread. The engine tick drains the queue; until the first tick
+    // is seen on_update does instead, so work is never stranded.
+    FrameScheduler m_frames;
+    FrameScheduler::ActionId m_updateAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_patchStacksAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_restoreStacksAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_sortInventoryAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_rearrangeInventoryAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_exportTablesAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_compactInventoryAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_luaPatchesAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_stackSweepAction = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId m_reapplyStacksAction = FrameScheduler::InvalidAction;
+
+    // The J/K patch and restore run as a sweep over the rows, PatchFrameBudget
+    // microseconds per frame. The Patch/Restore ownership is held from the first
+    // batch to the last, so no other writer sees a half-patched table. A config
+    // reload re-applies a patch as a Reapply: the restore sweep, then the patch
+    // sweep with the new rules, under the one ownership.
+    enum class StackSweep { None, Patch, Restore, Reapply };
+    StackSweep m_stackSweepKind = StackSweep::None;
+    IncrementalSweep m_stackSweep;
+    bool m_stackSweepFirstPatch = false;
+    int m_stackSweepModified = 0;
+    PatchJournal::RevertResult m_stackSweepReverted;
+    std::atomic<bool> m_engineTickSeen{false};
+    UFunction* m_rearrangeFunction = nullptr;
+    std::vector<unsigned char> m_callParams; // Zeroed parameter block for ProcessEvent calls
+
+    // Engine callbacks cannot be unregistered; they reach the mod through this
+    static inline std::atomic<InventoryStackSizeBoost*> s_instance{nullptr};
+
+    // Work for the next update action. The config watcher sets bits and posts the
+    // action; pending retries post it for when the earliest one is due. With
+    // neither it is never queued.
+    enum UpdateWork : uint32_t
+    {
+        UPDATE_START_RETRIES = 1 << 0,
+        UPDATE_RETRIES = 1 << 1,
+        UPDATE_RELOAD_CONFIG = 1 << 2,
+        UPDATE_RELOAD_PATCHES = 1 << 3,
+    };
+    std::atomic<uint32_t> m_updateWork{0};
+    RetryScheduler m_retries; // Only touched from the update action
 
     InventoryStackSizeBoost() : CppUserModBase()
     {
@@ -70,274 +415,1543 @@ public:
         ModDescription = STR("Increases inventory stack sizes by patching the EnemyConfig DataTable");
         ModAuthors = STR("Local");
 
+        m_log.Start(LOG_EVENTS, LOG_EVENT_COUNT, &WriteLogLine, [](uint64_t packedName) {
+            return AsyncLog::UnpackName<FName>(packedName).ToString();
+        });
+
+        m_statsRegistry.Add(m_statsItemTotalStack);
+        m_statsRegistry.Add(m_statsExchangePre);
+        m_statsRegistry.Add(m_statsExchangePost);
+        m_statsRegistry.Add(m_statsInventoryUpdate);
+        m_statsRegistry.Add(m_statsUpdate);
+        m_statsRegistry.Add(m_statsFrame);
+        if (STATS_DUMP_INTERVAL_SECONDS > 0)
+        {
+            // Counters are atomics, so the dump can run off the update thread
+            m_statsDumper.Start(std::chrono::seconds(STATS_DUMP_INTERVAL_SECONDS), [this] { DumpHookStats(); });
+        }
+
+        RegisterFrameActions();
+        LoadConfig();
+
+        // Keybinds only queue the action; it runs on the game thread at the start of the next frame
+        register_keydown_event(Input::Key::J, {Input::ModifierKey::SHIFT}, [this] { m_frames.Post(m_patchStacksAction); });
+        register_keydown_event(Input::Key::K, {Input::ModifierKey::SHIFT}, [this] { m_frames.Post(m_restoreStacksAction); });
+        register_keydown_event(Input::Key::E, {Input::ModifierKey::SHIFT}, [this] { m_frames.Post(m_exportTablesAction); });
+        register_keydown_event(Input::Key::C, {Input::ModifierKey::SHIFT}, [this] { m_frames.Post(m_compactInventoryAction); });
+        register_keydown_event(Input::Key::L, {Input::ModifierKey::SHIFT}, [this] { DumpHookStats(); });
+
         Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Mod constructed\n"));
     }
 
-    ~InventoryStackSizeBoost() override = default;
+    ~InventoryStackSizeBoost() override
+    {
+        InventoryStackSizeBoost* self = this;
+        s_instance.compare_exchange_strong(self, nullptr, std::memory_order_acq_rel);
+        m_statsDumper.Stop();
+        m_patchesWatcher.Stop();
+        m_configWatcher.Stop();
+        m_log.Stop();
+    }
+
+    static void WriteLogLine(AsyncLogLevel level, const std::wstring& line)
+    {
+        switch (level)
+        {
+        case AsyncLogLevel::Verbose: Output::send<LogLevel::Verbose>(STR("{}"), line); break;
+        case AsyncLogLevel::Warning: Output::send<LogLevel::Warning>(STR("{}"), line); break;
+        case AsyncLogLevel::Error: Output::send<LogLevel::Error>(STR("{}"), line); break;
+        default: Output::send<LogLevel::Default>(STR("{}"), line); break;
+        }
+    }
 
     auto on_unreal_init() -> void override
     {
         Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] on_unreal_init called\n"));
+        LoadDiscoveryCache();
         // Still need to find DataTable for hooks (but don't patch it)
-        TryPatchDataTable();
-        TryHookGetItemTotalStack();
-        // TryHookTryExchangeInventorySlot();
+        StartDataTableDiscovery();
+        DeclareHookTargets();
+        StartFrameHook();
+        RequestUpdateWork(UPDATE_START_RETRIES);
     }
 
     auto on_update() -> void override
     {
-        // Keep trying to find DataTable until we succeed (needed for exchange hook)
-        if (!m_patched)
+        // Fallback drain until the engine tick callback has fired
+        if (!m_engineTickSeen.load(std::memory_order_relaxed))
         {
-            m_update_count++;
-            // Only try every 100 updates to avoid spam
-            if (m_update_count % 100 == 0)
-            {
-                TryPatchDataTable();
-            }
+            RunFrameActions();
         }
-        
-        // Try to hook GetItemTotalStack if not already hooked
-        if (!m_hook_registered)
+    }
+
+    // Native functions for Lua mods (see "Lua functions" in the README):
+    //   StackBoostPost(action), StackBoostPatch(name, patches), StackBoostRevert(name),
+    //   StackBoostFindObject(path)
+    auto on_lua_start(StringViewType, LuaMadeSimple::Lua& lua, LuaMadeSimple::Lua&, LuaMadeSimple::Lua& async_lua,
+                      std::vector<LuaMadeSimple::Lua*>&) -> void override
+    {
+        for (LuaMadeSimple::Lua* state : {&lua, &async_lua})
+        {
+            state->register_function("StackBoostPost", &LuaPostFrameAction);
+            state->register_function("StackBoostPatch", &LuaPatch);
+            state->register_function("StackBoostRevert", &LuaRevert);
+        }
+        // Looks objects up where it is called, so never on the async keybind state
+        lua.register_function("StackBoostFindObject", &LuaFindObject);
+    }
+
+private:
+    void RegisterFrameActions()
+    {
+        using std::chrono::milliseconds;
+        m_updateAction = m_frames.RegisterAction(STR("update"), milliseconds(0), [this](void*) { RunUpdateWork(); },
+                                                 FrameScheduler::ReentrantPost::Queue);
+        // While an exchange owns the rows these try again on the next frame
+        m_patchStacksAction = m_frames.RegisterAction(STR("patch_stacks"), milliseconds(0), [this](void*) { PatchAllStacksToMax(); },
+                                                      FrameScheduler::ReentrantPost::Queue);
+        m_restoreStacksAction = m_frames.RegisterAction(STR("restore_stacks"), milliseconds(0), [this](void*) { RestoreAllStacksToDefault(); },
+                                                        FrameScheduler::ReentrantPost::Queue);
+        m_sortInventoryAction = m_frames.RegisterAction(STR("sort_inventory"), milliseconds(0), [this](void* controller) {
+            SortInventoryAction(static_cast<UObject*>(controller));
+        });
+        m_rearrangeInventoryAction = m_frames.RegisterAction(STR("rearrange_inventory"), REARRANGE_INTERVAL, [this](void* controller) {
+            RearrangeInventoryAction(static_cast<UObject*>(controller));
+        });
+        m_exportTablesAction = m_frames.RegisterAction(STR("export_tables"), milliseconds(0), [this](void*) { ExportTables(); });
+        m_compactInventoryAction = m_frames.RegisterAction(STR("compact_inventory"), milliseconds(0), [this](void* controller) {
+            CompactInventoryAction(static_cast<UObject*>(controller));
+        });
+        m_luaPatchesAction = m_frames.RegisterAction(STR("lua_patches"), milliseconds(0), [this](void*) { RunLuaPatches(); },
+                                                     FrameScheduler::ReentrantPost::Queue);
+        m_stackSweepAction = m_frames.RegisterAction(STR("stack_sweep"), milliseconds(0), [this](void*) { RunStackSweep(); },
+                                                     FrameScheduler::ReentrantPost::Queue);
+        m_reapplyStacksAction = m_frames.RegisterAction(STR("reapply_stacks"), milliseconds(0), [this](void*) { ReapplyStacks(); },
+                                                        FrameScheduler::ReentrantPost::Queue);
+    }
+
+    void StartFrameHook()
+    {
+        s_instance.store(this, std::memory_order_release);
+
+        static bool s_callbackRegistered = false;
+        if (s_callbackRegistered)
         {
-            m_update_count++;
-            // Only try every 100 updates to avoid spam
-            if (m_update_count % 100 == 0)
+            return;
+        }
+        s_callbackRegistered = true;
+        Hook::RegisterEngineTickPreCallback([](auto*, float) {
+            if (InventoryStackSizeBoost* mod = s_instance.load(std::memory_order_acquire))
             {
-                TryHookGetItemTotalStack();
+                mod->m_engineTickSeen.store(true, std::memory_order_relaxed);
+                mod->RunFrameActions();
             }
+        });
+    }
+
+    void RunFrameActions()
+    {
+        // Idle frames, and frames before the next delayed action is due, cost two loads
+        if (!m_frames.HasDue())
+        {
+            return;
         }
-        
-        // Try to hook TryExchangeInventorySlot function if not already hooked
-        // if (!m_tryExchange_hook_registered)
-        // {
-        //     m_update_count++;
-        //     // Only try every 100 updates to avoid spam
-        //     if (m_update_count % 100 == 0)
-        //     {
-        //         TryHookTryExchangeInventorySlot();
-        //     }
-        // }
-        
-        // Check for keyboard input (J and K keys)
-        if (m_enemyDataTable)
+
+        ScopedHookTimer timer(m_statsFrame);
+        timer.SetRowsTouched(static_cast<uint32_t>(m_frames.RunFrame()));
+    }
+
+    static int LuaPostFrameAction(const LuaMadeSimple::Lua& lua)
+    {
+        if (!lua.is_string())
+        {
+            lua.throw_error("StackBoostPost(action): action must be a string");
+        }
+        std::string_view name = lua.get_string();
+
+        InventoryStackSizeBoost* mod = s_instance.load(std::memory_order_acquire);
+        if (!mod)
+        {
+            lua.set_bool(false);
+            return 1;
+        }
+
+        FrameScheduler::ActionId action = mod->m_frames.FindAction(std::wstring(name.begin(), name.end()));
+        if (action == FrameScheduler::InvalidAction)
         {
-            CheckKeyboardInput();
+            lua.throw_error("StackBoostPost: unknown action '" + std::string(name) + "'");
         }
+        lua.set_bool(mod->m_frames.Post(action));
+        return 1;
     }
 
-private:
-    void TryPatchDataTable()
+    static std::wstring LuaWideString(const LuaMadeSimple::Lua& lua)
     {
-        // DISABLED: Testing exchange hook approach instead
-        // Still need to find the DataTable for the exchange hook though
-        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Searching for DataTable (for exchange hook)...\n"));
-        
-        // Approach: Find all DataTable objects and look for one with "Enemy" or "Config" in the name
-        UDataTable* targetDataTable = nullptr;
-        int dataTableCount = 0;
-        
-        // Use FindAllOf to get all DataTable objects
-        std::vector<UObject*> dataTables;
-        UObjectGlobals::FindAllOf(STR("DataTable"), dataTables);
-        
-        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Found {} DataTable objects\n"), dataTables.size());
-        
-        for (UObject* obj : dataTables)
+        return StackBoost::Utf8ToWide(lua.get_string());
+    }
+
+    // StackBoostPatch(name, patches): patches is table_patches.ini text, any number of
+    // [Table] and [/Game/...] sections. Applied as one layer at the start of the next
+    // frame, replacing the previous patch of that name. Syntax errors are raised here.
+    // Returns false if a not yet applied patch of the same name was replaced.
+    static int LuaPatch(const LuaMadeSimple::Lua& lua)
+    {
+        if (!lua.is_string())
         {
-            if (!obj) continue;
-            
-            dataTableCount++;
-            StringType name = obj->GetName();
-            StringType fullName = obj->GetFullName();
-            
-            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost]   DataTable: {}\n"), fullName);
-            
-            // Try DT_Enemies - the actual item/enemy config table
-            if (name == STR("DT_Enemies"))
-            {
-                targetDataTable = static_cast<UDataTable*>(obj);
-                m_enemyDataTable = targetDataTable; // Store for exchange hook
-                Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Selected DataTable: {} (stored for exchange hook)\n"), fullName);
-                break; // Found it, stop searching
-            }
+            lua.throw_error("StackBoostPatch(name, patches): name must be a string");
         }
-        
-        if (dataTableCount == 0)
+        std::wstring name = LuaWideString(lua);
+        if (!lua.is_string())
         {
-            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] No DataTables found yet, will retry...\n"));
-            return; // Will retry
+            lua.throw_error("StackBoostPatch(name, patches): patches must be a string");
         }
-        
-        if (!targetDataTable)
+        std::vector<StackBoost::ConfigError> errors;
+        std::vector<PatchGroup> groups = StackBoost::ParsePatchSpecs(LuaWideString(lua), &errors);
+        if (!errors.empty())
         {
-            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] DT_Enemies not found among {} tables, will retry...\n"), dataTableCount);
-            return; // Will retry
+            const StackBoost::ConfigError& error = errors.front();
+            lua.throw_error("StackBoostPatch: line " + std::to_string(error.Line) + ": " +
+                            std::string(error.Message.begin(), error.Message.end()));
         }
-        
-        // DISABLED: Testing OnInventoryUpdate hook approach instead
-        // PatchDataTableRows(targetDataTable);
-        m_patched = true; // Mark as "done" so we don't keep retrying
-        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] DataTable found and stored (patching disabled for OnInventoryUpdate hook testing)\n"));
+
+        InventoryStackSizeBoost* mod = s_instance.load(std::memory_order_acquire);
+        if (!mod)
+        {
+            lua.set_bool(false);
+            return 1;
+        }
+        bool queued = mod->m_luaPatchRequests.Push(std::move(name), {std::move(groups), false});
+        mod->m_frames.Post(mod->m_luaPatchesAction);
+        lua.set_bool(queued);
+        return 1;
     }
 
-    void PatchDataTableRows(UDataTable* dataTable)
+    // StackBoostRevert(name): undoes a StackBoostPatch at the start of the next frame
+    static int LuaRevert(const LuaMadeSimple::Lua& lua)
     {
-        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Patching DataTable: {}\n"), dataTable->GetFullName());
-        
-        // Get the row struct to find property offsets
-        UScriptStruct* rowStruct = dataTable->GetRowStruct();
-        if (rowStruct)
+        if (!lua.is_string())
         {
-            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] RowStruct: {}\n"), rowStruct->GetFullName());
-            
-            // Enumerate properties to find MaximumStack offset
-            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Struct properties:\n"));
-            for (FProperty* prop = rowStruct->GetFirstProperty(); prop; prop = prop->GetNextFieldAsProperty())
-            {
-                Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost]   {} @ offset 0x{:X} (size {})\n"), 
-                    prop->GetName(), prop->GetOffset_Internal(), prop->GetSize());
-            }
+            lua.throw_error("StackBoostRevert(name): name must be a string");
         }
-        
-        // GetRowMap returns TMap<FName, unsigned char*>
-        // Note: GetRowMap() returns const reference, but we need to modify values
-        // The actual data is mutable, so we can cast away const
-        TMap<FName, unsigned char*>& rowMap = const_cast<TMap<FName, unsigned char*>&>(dataTable->GetRowMap());
-        
-        int32_t numRows = rowMap.Num();
-        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] DataTable has {} rows\n"), numRows);
+        std::wstring name = LuaWideString(lua);
 
-        if (numRows == 0)
+        InventoryStackSizeBoost* mod = s_instance.load(std::memory_order_acquire);
+        if (!mod)
         {
-            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] DataTable is empty!\n"));
-            return;
+            lua.set_bool(false);
+            return 1;
+        }
+        bool queued = mod->m_luaPatchRequests.Push(std::move(name), {{}, true});
+        mod->m_frames.Post(mod->m_luaPatchesAction);
+        lua.set_bool(queued);
+        return 1;
+    }
+
+    // StackBoostFindObject(path): StaticFindObject that remembers what it found;
+    // returns the object, or nil if it isn't loaded (or isn't valid any more)
+    static int LuaFindObject(const LuaMadeSimple::Lua& lua)
+    {
+        if (!lua.is_string())
+        {
+            lua.throw_error("StackBoostFindObject(path): path must be a string");
         }
+        std::wstring path = LuaWideString(lua);
 
-        int patchedCount = 0;
-        int skippedCount = 0;
-        for (auto& pair : rowMap)
+        InventoryStackSizeBoost* mod = s_instance.load(std::memory_order_acquire);
+        UObject* object = mod ? mod->FindObjectCached(path) : nullptr;
+        if (object)
         {
-            unsigned char* rowData = pair.Value;
-            if (!rowData) continue;
-            
-            // MaximumStack is at offset 0x5C
-            int32_t* maxStackPtr = reinterpret_cast<int32_t*>(rowData + OFFSET_MAXIMUM_STACK);
-            int32_t oldMaxStack = *maxStackPtr;
-            
-            // Patch ALL items that have a positive stack limit less than our target
-            // (removed SellCanStack check - it was filtering out most items)
-            if (oldMaxStack > 0 && oldMaxStack < MAX_STACK)
-            {
-                *maxStackPtr = MAX_STACK;
-                patchedCount++;
-                
-                // Log first few patches for verification
-                if (patchedCount <= 10)
+            LuaType::auto_construct_object(lua, object);
+        }
+        else
+        {
+            lua.set_nil();
+        }
+        return 1;
+    }
+
+    // A remembered object is only handed out while its object-array slot still holds it
+    UObject* FindObjectCached(const std::wstring& path)
+    {
+        return m_luaObjects.Get(
+            path,
+            [](UObject* object, uint32_t index) {
+                return StackBoost::ObjectAtIndex(index) == object && !object->IsUnreachable();
+            },
+            [](const std::wstring& key, uint32_t& index) {
+                UObject* object = UObjectGlobals::StaticFindObject<UObject*>(nullptr, nullptr, StringType(key));
+                if (!object || object->IsUnreachable())
                 {
-                    Output::send<LogLevel::Verbose>(
-                        STR("[InventoryStackSizeBoost] Patched '{}': MaxStack {} -> {}\n"),
-                        pair.Key.ToString(), oldMaxStack, MAX_STACK);
+                    return static_cast<UObject*>(nullptr);
                 }
-            }
-            else if (oldMaxStack == 0)
-            {
-                skippedCount++;
-            }
+                index = object->GetInternalIndex();
+                return object;
+            });
+    }
+
+    void RunUpdateWork()
+    {
+        ScopedHookTimer timer(m_statsUpdate);
+        if (m_patchState.TryBegin(PatchStateMachine::Op::Maintenance) != PatchStateMachine::Result::Began)
+        {
+            // An exchange is in flight; the bits stay set for the next frame
+            m_frames.Post(m_updateAction);
+            return;
         }
-        
-        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Skipped {} items with MaxStack=0 (non-stackable)\n"), skippedCount);
+        uint32_t work = m_updateWork.exchange(0, std::memory_order_acquire);
 
-        Output::send<LogLevel::Default>(
-            STR("[InventoryStackSizeBoost] SUCCESS: Patched {} items to MaxStack={}\n"),
-            patchedCount, MAX_STACK);
-        
-        m_patched = true;
+        if (work & UPDATE_START_RETRIES)
+        {
+            // Waits for the construct callback to report DT_Enemies with its rows loaded (needed for exchange hook)
+            m_retries.Add(STR("DT_Enemies"), TABLE_RETRY_INITIAL, TABLE_RETRY_MAX, [this] { return TryAcceptDataTable(); });
+            m_retries.Add(STR("hook targets"), HOOK_RETRY_INITIAL, HOOK_RETRY_MAX, [this] { return ResolveHookTargets(); });
+            ScheduleTablePatches();
+        }
+        if (work & UPDATE_RELOAD_CONFIG)
+        {
+            ReloadConfig();
+        }
+        if (work & UPDATE_RELOAD_PATCHES)
+        {
+            ReloadTablePatches();
+        }
+
+        bool retrying = m_retries.RunDue(std::chrono::steady_clock::now(), [](const wchar_t* name, unsigned attempts) {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Gave up waiting for {} after {} attempts\n"), name, attempts);
+        });
+        if (retrying)
+        {
+            // Wake up for the earliest retry; the frames in between cost nothing
+            m_frames.PostAt(m_updateAction, m_retries.NextDue());
+        }
+        EndPatchState();
     }
 
-    void TryHookGetItemTotalStack()
+    void EndPatchState()
+    {
+        m_patchState.End(m_journal.IsActive(m_stackLayer));
+    }
+
+    void LoadConfig()
     {
-        if (m_hook_registered)
+        m_config.MaxStack = MAX_STACK;
+
+        std::filesystem::path modDirectory = StackBoost::ModDirectory();
+        if (modDirectory.empty())
         {
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] Mod folder not found, using MAX_STACK={} without a config file\n"), MAX_STACK);
             return;
         }
 
-        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Attempting to hook GetItemTotalStack...\n"));
+        m_configWatcher.Start(modDirectory / CONFIG_FILE_NAME, std::chrono::milliseconds(CONFIG_POLL_INTERVAL_MS),
+                              [this] { RequestUpdateWork(UPDATE_RELOAD_CONFIG); });
+        ReadConfigFile();
 
-        // Skip StaticFindObject path searches as they can cause fatal errors with invalid paths
-        // Instead, search all functions directly
-        Output::send<LogLevel::Verbose>(
-            STR("[InventoryStackSizeBoost] Searching for function by name...\n"));
-        
-        std::vector<UObject*> allFunctions;
-        UObjectGlobals::FindAllOf(STR("Function"), allFunctions);
-        
-        Output::send<LogLevel::Verbose>(
-            STR("[InventoryStackSizeBoost] Found {} Function objects to search\n"), allFunctions.size());
-        
-        for (UObject* obj : allFunctions)
+        m_patchesWatcher.Start(modDirectory / PATCHES_FILE_NAME, std::chrono::milliseconds(CONFIG_POLL_INTERVAL_MS),
+                               [this] { RequestUpdateWork(UPDATE_RELOAD_PATCHES); });
+        for (PatchGroup& group : ReadPatchesFile())
         {
-            if (!obj) continue;
-            
-            StringType name = obj->GetName();
-            StringType fullName = obj->GetFullName();
-            
-            // Check if name contains "GetItemTotalStack" and fullName contains "BeltTDInventoryInstance"
-            // StringType is std::wstring, so we can use find() directly
-            if (name.find(STR("GetItemTotalStack")) != StringType::npos &&
-                fullName.find(STR("BeltTDInventoryInstance")) != StringType::npos)
-            {
-                Output::send<LogLevel::Default>(
-                    STR("[InventoryStackSizeBoost] Found matching function: {}\n"), fullName);
-                m_getItemTotalStackFunction = static_cast<UFunction*>(obj);
-                break;
-            }
+            m_patchTargets.push_back({std::move(group)});
         }
+    }
+
+    // Safe from any thread
+    void RequestUpdateWork(uint32_t work)
+    {
+        m_updateWork.fetch_or(work, std::memory_order_release);
+        m_frames.Post(m_updateAction);
+    }
+
+    void ReadConfigFile()
+    {
+        std::vector<StackBoost::StackConfigError> errors;
+        m_config = StackBoost::LoadStackConfig(m_configWatcher.Path(), MAX_STACK, &errors);
+        m_stackRulesCurrent = false;
 
-        if (!m_getItemTotalStackFunction)
+        for (const StackBoost::StackConfigError& error : errors)
         {
-            Output::send<LogLevel::Verbose>(
-                STR("[InventoryStackSizeBoost] GetItemTotalStack function not found yet, will retry...\n"));
-            return;
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] {} line {}: {}\n"),
+                CONFIG_FILE_NAME, error.Line, error.Message);
         }
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Config: MaxStack={}, {} override(s)\n"),
+            m_config.MaxStack, m_config.Overrides.size());
+    }
 
-        // Register post-hook to capture return value
-        auto postHook = [](UnrealScriptFunctionCallableContext& Context, void* CustomData) -> void {
-            InventoryStackSizeBoost* mod = static_cast<InventoryStackSizeBoost*>(CustomData);
-            
-            // Get the return value (assuming it's an int32)
-            int32_t returnValue = *static_cast<int32_t*>(Context.RESULT_DECL);
-            
-            // Try to get function parameters to see what was passed in
-            Output::send<LogLevel::Default>(
-                STR("[InventoryStackSizeBoost] GetItemTotalStack called on {} -> ReturnValue: {}\n"),
-                Context.Context->GetFullName(), returnValue);
-        };
+    void ReloadConfig()
+    {
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] {} changed, reloading\n"), CONFIG_FILE_NAME);
+        ReadConfigFile();
 
-        try
+        // Exchange patches are transient; only a manual patch needs re-applying,
+        // spread over frames like Shift + K then J
+        if (StacksArePatched())
         {
-            m_hook_ids = UObjectGlobals::RegisterHook(
-                m_getItemTotalStackFunction,
-                nullptr, // Pre-hook (nullptr = no pre-hook)
-                postHook,
-                this // CustomData
-            );
-            
+            m_frames.Post(m_reapplyStacksAction);
+        }
+        if (m_virtualLimits.IsActive() && !m_config.VirtualStacks)
+        {
+            m_virtualLimits.Deactivate();
+            Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] VirtualStacks turned off: virtual stack limits off\n"));
+        }
+        else if (m_virtualLimits.IsActive() && m_enemyDataTable)
+        {
+            BuildVirtualLimits();
+        }
+    }
+
+    std::vector<PatchGroup> ReadPatchesFile()
+    {
+        std::vector<StackBoost::ConfigError> errors;
+        std::vector<PatchGroup> groups = StackBoost::LoadPatchSpecs(m_patchesWatcher.Path(), &errors);
+        for (const StackBoost::ConfigError& error : errors)
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] {} line {}: {}\n"),
+                PATCHES_FILE_NAME, error.Line, error.Message);
+        }
+        return groups;
+    }
+
+    void ScheduleTablePatches()
+    {
+        if (!m_retries.Contains(STR("table patches")))
+        {
+            m_retries.Add(STR("table patches"), TABLE_RETRY_INITIAL, TABLE_RETRY_MAX, [this] { return ApplyTablePatches(); },
+                          TABLE_PATCH_RETRY_ATTEMPTS);
+        }
+    }
+
+    // Compiles and applies each group whose table has loaded. Returns true
+    // once nothing is left waiting for its table.
+    bool ApplyTablePatches()
+    {
+        bool waiting = false;
+        for (PatchTarget& target : m_patchTargets)
+        {
+            if (m_journal.IsActive(target.Layer) || target.Watch == ObjectDiscovery::InvalidWatch)
+            {
+                continue;
+            }
+
+            if (target.Group.IsObject())
+            {
+                waiting |= !ApplyTemplatePatch(target);
+                continue;
+            }
+
+            UDataTable* table = static_cast<UDataTable*>(m_discovery.Get(target.Watch));
+            if (!table || table->GetRowMap().Num() == 0 || !table->GetRowStruct())
+            {
+                waiting = true;
+                continue;
+            }
+
+            std::vector<StackBoost::ConfigError> errors;
+            const TMap<FName, unsigned char*>& rowMap = table->GetRowMap();
+            TablePatch::CompileResult compiled = target.Patch.Compile(table, rowMap, m_rowLayouts.Get(table->GetRowStruct()),
+                target.Group.Specs, [](const FName& key) { return std::wstring(key.ToString()); }, &errors);
+            for (const StackBoost::ConfigError& error : errors)
+            {
+                Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] {} line {}: {}\n"),
+                    PATCHES_FILE_NAME, error.Line, error.Message);
+            }
+
+            target.Table = table;
+            m_discoveryCache.Set(STR("table:") + target.Group.Table, table->GetPathName(), static_cast<uint32_t>(rowMap.Num()));
+            target.Layer = m_journal.Begin(target.Group.Table);
+            size_t changed = target.Patch.Apply(m_journal, target.Layer);
             Output::send<LogLevel::Default>(
-                STR("[InventoryStackSizeBoost] SUCCESS: Hooked GetItemTotalStack (IDs: {}, {})\n"),
-                m_hook_ids.first, m_hook_ids.second);
-            
-            m_hook_registered = true;
+                STR("[InventoryStackSizeBoost] {}: {} patch(es) applied to {} field(s) in {} row(s), {} changed\n"),
+                target.Group.Table, target.Group.Specs.size(), compiled.Fields, compiled.Rows, changed);
         }
-        catch (const std::exception& e)
+        SaveDiscoveryCache();
+        return !waiting;
+    }
+
+    // Patches a Blueprint component template once its class has loaded, then gives
+    // the components already spawned from it the same values in the same pass.
+    // Later spawns copy the patched template. Returns false while still waiting.
+    bool ApplyTemplatePatch(PatchTarget& target)
+    {
+        UClass* ownerClass = static_cast<UClass*>(m_discovery.Get(target.Watch));
+        if (!ownerClass)
         {
-            // Convert exception message to StringType (wstring)
-            std::string errorStr = e.what();
-            StringType errorMsg = STR("Failed to register hook: ");
-            errorMsg += StringType(errorStr.begin(), errorStr.end());
-            Output::send<LogLevel::Warning>(
-                STR("[InventoryStackSizeBoost] {}\n"), errorMsg);
+            return false;
+        }
+        // The class is reported on construction; its subobjects are loaded afterwards
+        UObject* templateObject = UObjectGlobals::StaticFindObject<UObject*>(nullptr, nullptr, target.Group.Table);
+        if (!templateObject || templateObject->HasAnyFlags(static_cast<EObjectFlags>(RF_NeedLoad | RF_NeedPostLoad)))
+        {
+            return false;
+        }
+
+        std::vector<StackBoost::ConfigError> errors;
+        UClass* componentClass = templateObject->GetClassPrivate();
+        size_t fields = target.Object.Compile(m_rowLayouts.Get(componentClass), target.Group.Specs, &errors);
+        for (const StackBoost::ConfigError& error : errors)
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] {} line {}: {}\n"),
+                PATCHES_FILE_NAME, error.Line, error.Message);
+        }
+
+        target.Template = templateObject;
+        m_discoveryCache.Set(STR("class:") + StackBoost::TemplateOwnerClassName(target.Group.Table), ownerClass->GetPathName());
+        target.Layer = m_journal.Begin(target.Group.Table);
+        size_t changed = target.Object.ApplyTemplate(m_journal, target.Layer, reinterpret_cast<unsigned char*>(templateObject));
+
+        size_t instances = 0;
+        size_t instanceFields = fields > 0 ? PatchTemplateInstances(target.Object, templateObject, ownerClass, instances) : 0;
+
+        Output::send<LogLevel::Default>(
+            STR("[InventoryStackSizeBoost] {}: {} field(s) patched on the template ({} changed), {} field(s) changed on {} existing instance(s)\n"),
+            target.Group.Table, fields, changed, instanceFields, instances);
+        return true;
+    }
+
+    // Instances are written directly rather than journaled: any of them may be
+    // destroyed before a revert, and reverting the template covers new spawns.
+    // Returns the number of fields changed.
+    size_t PatchTemplateInstances(ObjectPatch& patch, UObject* templateObject, UClass* ownerClass, size_t& instances)
+    {
+        UClass* componentClass = templateObject->GetClassPrivate();
+        size_t instanceFields = 0;
+        UObjectGlobals::ForEachUObject([&](UObject* object, int32, int32) {
+            if (object->GetClassPrivate() != componentClass || object == templateObject ||
+                object->HasAnyFlags(static_cast<EObjectFlags>(RF_ClassDefaultObject | RF_ArchetypeObject)))
+            {
+                return LoopAction::Continue;
+            }
+            UObject* owner = object->GetOuterPrivate();
+            if (owner && owner->GetClassPrivate() == ownerClass)
+            {
+                instanceFields += patch.ApplyInstance(reinterpret_cast<unsigned char*>(object));
+                ++instances;
+            }
+            return LoopAction::Continue;
+        });
+        return instanceFields;
+    }
+
+    // Applies and reverts the patches Lua mods queued since the last frame; all
+    // of a frame's requests share one ownership of the rows
+    void RunLuaPatches()
+    {
+        if (m_patchState.TryBegin(PatchStateMachine::Op::Maintenance) != PatchStateMachine::Result::Began)
+        {
+            m_frames.Post(m_luaPatchesAction); // An exchange owns the rows; requests stay queued
+            return;
+        }
+
+        for (auto& [name, request] : m_luaPatchRequests.Drain())
+        {
+            auto existing = m_luaPatchLayers.find(name);
+            if (existing != m_luaPatchLayers.end())
+            {
+                LuaPatchLayer& previous = existing->second;
+                bool stale = std::any_of(previous.Objects.begin(), previous.Objects.end(), [this](const LuaPatchedObject& patched) {
+                    if (FindObjectCached(patched.Path) != patched.Object)
+                    {
+                        return true;
+                    }
+                    UDataTable* table = static_cast<UDataTable*>(patched.Object);
+                    return patched.IsTable && !patched.Table.IsCurrent(table, table->GetRowMap());
+                });
+                PatchJournal::RevertResult reverted{};
+                if (stale)
+                {
+                    m_journal.Discard(previous.Layer); // The memory it wrote to is gone
+                }
+                else
+                {
+                    reverted = m_journal.Revert(previous.Layer);
+                }
+                m_luaPatchLayers.erase(existing);
+                if (reverted.Conflicts > 0)
+                {
+                    Output::send<LogLevel::Warning>(
+                        STR("[InventoryStackSizeBoost] Lua patch '{}': {} field(s) changed by the game since patching were left as they are\n"),
+                        name, reverted.Conflicts);
+                }
+                if (request.Revert)
+                {
+                    Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Lua patch '{}' reverted\n"), name);
+                }
+            }
+            if (!request.Revert)
+            {
+                ApplyLuaPatch(name, request.Groups);
+            }
+        }
+        EndPatchState();
+    }
+
+    void ApplyLuaPatch(const std::wstring& name, std::vector<PatchGroup>& groups)
+    {
+        LuaPatchLayer& patched = m_luaPatchLayers[name];
+        PatchJournal::LayerId layer = patched.Layer = m_journal.Begin(STR("lua:") + name);
+        size_t changed = 0;
+        size_t applied = 0;
+        std::vector<StackBoost::ConfigError> errors;
+        for (PatchGroup& group : groups)
+        {
+            if (group.IsObject())
+            {
+                if (!ApplyLuaTemplatePatch(patched, group, errors, changed))
+                {
+                    Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Lua patch '{}': {} is not loaded yet, patched once it is\n"), name, group.Table);
+                    patched.Waiting.push_back(std::move(group));
+                    continue;
+                }
+            }
+            else
+            {
+                UDataTable* table = FindTableCached(group.Table);
+                if (!table || table->GetRowMap().Num() == 0 || !table->GetRowStruct())
+                {
+                    Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Lua patch '{}': table {} is not loaded, skipped\n"), name, group.Table);
+                    continue;
+                }
+                LuaPatchedObject& entry = patched.Objects.emplace_back(LuaPatchedObject{table->GetPathName(), table, true});
+                entry.Table.Compile(table, table->GetRowMap(), m_rowLayouts.Get(table->GetRowStruct()), group.Specs,
+                                    [](const FName& key) { return std::wstring(key.ToString()); }, &errors);
+                changed += entry.Table.Apply(m_journal, layer);
+            }
+            ++applied;
+        }
+
+        for (const StackBoost::ConfigError& error : errors)
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Lua patch '{}' line {}: {}\n"), name, error.Line, error.Message);
+        }
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Lua patch '{}': {} of {} section(s) applied, {} field(s) changed\n"),
+            name, applied, groups.size(), changed);
+
+        if (!patched.Waiting.empty() && !m_retries.Contains(STR("Lua patches")))
+        {
+            m_retries.Add(STR("Lua patches"), TABLE_RETRY_INITIAL, TABLE_RETRY_MAX, [this] { return ApplyWaitingLuaPatches(); },
+                          TABLE_PATCH_RETRY_ATTEMPTS);
+            m_frames.Post(m_updateAction);
+        }
+    }
+
+    // Patches a component template named by a Lua patch and the components already
+    // spawned from it, into the patch's layer. Returns false while the template or
+    // its class is still loading.
+    bool ApplyLuaTemplatePatch(LuaPatchLayer& patched, const PatchGroup& group, std::vector<StackBoost::ConfigError>& errors, size_t& changed)
+    {
+        UObject* templateObject = FindObjectCached(group.Table);
+        UObject* owner = templateObject ? templateObject->GetOuterPrivate() : nullptr;
+        if (!owner || templateObject->HasAnyFlags(static_cast<EObjectFlags>(RF_NeedLoad | RF_NeedPostLoad)))
+        {
+            return false;
+        }
+        ObjectPatch patch;
+        if (patch.Compile(m_rowLayouts.Get(templateObject->GetClassPrivate()), group.Specs, &errors) > 0)
+        {
+            size_t instances = 0;
+            changed += patch.ApplyTemplate(m_journal, patched.Layer, reinterpret_cast<unsigned char*>(templateObject));
+            PatchTemplateInstances(patch, templateObject, owner->GetClassPrivate(), instances);
+        }
+        patched.Objects.push_back({group.Table, templateObject});
+        return true;
+    }
+
+    // Retries the template sections of Lua patches that arrived before their class
+    // had loaded. Returns true once none is left waiting.
+    bool ApplyWaitingLuaPatches()
+    {
+        bool waiting = false;
+        for (auto& [name, patched] : m_luaPatchLayers)
+        {
+            for (size_t i = 0; i < patched.Waiting.size();)
+            {
+                std::vector<StackBoost::ConfigError> errors;
+                size_t changed = 0;
+                if (!ApplyLuaTemplatePatch(patched, patched.Waiting[i], errors, changed))
+                {
+                    ++i;
+                    continue;
+                }
+                for (const StackBoost::ConfigError& error : errors)
+                {
+                    Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Lua patch '{}' line {}: {}\n"), name, error.Line, error.Message);
+                }
+                Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Lua patch '{}': {} loaded and patched, {} field(s) changed\n"),
+                    name, patched.Waiting[i].Table, changed);
+                patched.Waiting.erase(patched.Waiting.begin() + static_cast<std::ptrdiff_t>(i));
+            }
+            waiting |= !patched.Waiting.empty();
+        }
+        return !waiting;
+    }
+
+    // Tables are named, not addressed by path: the startup cache or one walk
+    // over the object array finds the path, which is remembered from then on
+    UDataTable* FindTableCached(const std::wstring& tableName)
+    {
+        if (m_enemyDataTable && tableName == STR("DT_Enemies"))
+        {
+            return m_enemyDataTable;
+        }
+        DiscoveryCache::Record cached;
+        std::wstring path = m_discoveryCache.Find(STR("table:") + tableName, cached) ? std::wstring(cached.Path) : std::wstring();
+        if (path.empty())
+        {
+            UClass* dataTableClass = UObjectGlobals::StaticFindObject<UClass*>(nullptr, nullptr, STR("/Script/Engine.DataTable"));
+            UObjectGlobals::ForEachUObject([&](UObject* object, int32, int32) {
+                if (object->GetClassPrivate() == dataTableClass && object->GetName() == tableName &&
+                    !object->HasAnyFlags(static_cast<EObjectFlags>(RF_ClassDefaultObject)))
+                {
+                    path = object->GetPathName();
+                    return LoopAction::Break;
+                }
+                return LoopAction::Continue;
+            });
+            if (path.empty())
+            {
+                return nullptr;
+            }
+            m_discoveryCache.Set(STR("table:") + tableName, path);
+        }
+        return static_cast<UDataTable*>(FindObjectCached(path));
+    }
+
+    void ReloadTablePatches()
+    {
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] {} changed, reloading\n"), PATCHES_FILE_NAME);
+
+        // Tables can only be watched before discovery starts, so sections keep their
+        // existing watch; sections for tables that were never watched need a restart
+        std::vector<PatchTarget> previous = std::move(m_patchTargets);
+        m_patchTargets.clear();
+        for (PatchTarget& target : previous)
+        {
+            if (!m_journal.IsActive(target.Layer))
+            {
+                continue;
+            }
+            bool stale = target.Group.IsObject() ? !target.Template
+                                                 : !target.Table || !target.Patch.IsCurrent(target.Table, target.Table->GetRowMap());
+            if (stale)
+            {
+                m_journal.Discard(target.Layer);
+                continue;
+            }
+            PatchJournal::RevertResult reverted = m_journal.Revert(target.Layer);
+            if (reverted.Conflicts > 0)
+            {
+                Output::send<LogLevel::Warning>(
+                    STR("[InventoryStackSizeBoost] {}: {} field(s) changed by the game since patching were left as they are\n"),
+                    target.Group.Table, reverted.Conflicts);
+            }
+        }
+
+        for (PatchGroup& group : ReadPatchesFile())
+        {
+            auto existing = std::find_if(previous.begin(), previous.end(),
+                                         [&](const PatchTarget& target) { return target.Group.Table == group.Table; });
+            size_t watch = existing != previous.end() ? existing->Watch : ObjectDiscovery::InvalidWatch;
+            if (watch == ObjectDiscovery::InvalidWatch)
+            {
+                Output::send<LogLevel::Warning>(
+                    STR("[InventoryStackSizeBoost] {}: new section [{}] will be patched after a game restart\n"), PATCHES_FILE_NAME, group.Table);
+            }
+            m_patchTargets.push_back({std::move(group), watch});
+        }
+        ScheduleTablePatches();
+        RequestUpdateWork(UPDATE_RETRIES);
+    }
+
+    // Snapshot current for the table and config rules compiled against it
+    bool EnsureStackRules()
+    {
+        const TMap<FName, unsigned char*>& rowMap = m_enemyDataTable->GetRowMap();
+        if (!m_stackCore.IsCurrent(m_enemyDataTable, rowMap))
+        {
+            if (!m_stackCore.Empty())
+            {
+                Output::send<LogLevel::Warning>(
+                    STR("[InventoryStackSizeBoost] DT_Enemies rows changed since the last snapshot, re-capturing original values\n"));
+            }
+            m_stackCore.Build(m_enemyDataTable, rowMap, m_maxStackField);
+            m_stackRulesCurrent = false;
+        }
+
+        if (!m_stackRulesCurrent)
+        {
+            const std::vector<FName>& keys = m_stackCore.Keys();
+            m_stackRules.Compile(m_config, m_stackCore.Entries(), [&](size_t i) { return std::wstring(keys[i].ToString()); });
+            m_stackRulesCurrent = true;
+            m_virtualLimitsCurrent = false;
+            return true;
+        }
+        return false;
+    }
+
+    void LoadDiscoveryCache()
+    {
+        std::filesystem::path modDirectory = StackBoost::ModDirectory();
+        std::filesystem::path executable = StackBoost::GameExecutablePath();
+        if (modDirectory.empty() || executable.empty())
+        {
+            return;
+        }
+
+        m_discoveryCachePath = modDirectory / DISCOVERY_CACHE_FILE_NAME;
+        m_buildKey = StackBoost::ComputeBuildKey(StackBoost::GameBuildFiles(executable));
+        if (m_discoveryCache.Load(m_discoveryCachePath, m_buildKey))
+        {
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Discovery cache loaded ({} entries)\n"), m_discoveryCache.LoadedCount());
+        }
+        else
+        {
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] No discovery cache for this game build, scanning\n"));
+        }
+    }
+
+    // The object at the path cached under key, unchecked; callers verify class and name
+    UObject* FindCachedObject(std::wstring_view key)
+    {
+        DiscoveryCache::Record cached;
+        if (!m_discoveryCache.Find(key, cached) || cached.Path.empty())
+        {
+            return nullptr;
+        }
+        return UObjectGlobals::StaticFindObject<UObject*>(nullptr, nullptr, StringType(cached.Path));
+    }
+
+    // Persists the cache once everything startup waits for has been found
+    void SaveDiscoveryCache()
+    {
+        if (m_discoveryCachePath.empty() || !m_enemyDataTable || !m_functionResolver.AllResolved() || !m_discoveryCache.Dirty())
+        {
+            return;
+        }
+
+        m_discoveryCache.Close(); // A mapped file can't be replaced on Windows
+        if (m_discoveryCache.Save(m_discoveryCachePath, m_buildKey))
+        {
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Discovery cache written to {}\n"), m_discoveryCachePath.wstring());
+        }
+        else
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Could not write {}\n"), m_discoveryCachePath.wstring());
+        }
+    }
+
+    // One walk over the object array for the tables to export, then each table is
+    // streamed to disk row by row in both formats
+    void ExportTables()
+    {
+        std::filesystem::path modDirectory = StackBoost::ModDirectory();
+        UClass* dataTableClass = UObjectGlobals::StaticFindObject<UClass*>(nullptr, nullptr, STR("/Script/Engine.DataTable"));
+        if (modDirectory.empty() || !dataTableClass || m_config.ExportTables.empty())
+        {
+            return;
+        }
+
+        std::vector<UDataTable*> tables;
+        UObjectGlobals::ForEachUObject([&](UObject* object, int32, int32) {
+            if (object->GetClassPrivate() == dataTableClass && !object->HasAnyFlags(static_cast<EObjectFlags>(RF_ClassDefaultObject)))
+            {
+                std::wstring name = object->GetName();
+                for (const std::wstring& pattern : m_config.ExportTables)
+                {
+                    if (StackBoost::MatchRowPattern(pattern, name))
+                    {
+                        tables.push_back(static_cast<UDataTable*>(object));
+                        break;
+                    }
+                }
+            }
+            return LoopAction::Continue;
+        });
+        if (tables.empty())
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Export: no loaded DataTable matches ExportTables\n"));
+            return;
+        }
+
+        std::filesystem::path directory = modDirectory / EXPORT_DIRECTORY_NAME;
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+
+        wchar_t build[17];
+        std::swprintf(build, 17, L"%016llx", static_cast<unsigned long long>(m_buildKey));
+        auto nameText = [](const unsigned char* field) { return std::wstring(reinterpret_cast<const FName*>(field)->ToString()); };
+
+        for (UDataTable* table : tables)
+        {
+            UScriptStruct* rowStruct = table->GetRowStruct();
+            if (!rowStruct)
+            {
+                continue;
+            }
+            const FieldLayout& layout = m_rowLayouts.Get(rowStruct);
+            std::wstring tableName = table->GetName();
+            std::filesystem::path stem = directory / (tableName + STR("-") + build);
+
+            TableExportWriter binary;
+            TableExportWriter csv;
+            if (!binary.Open(stem.wstring() + STR(".isbt"), TableExportFormat::Binary, tableName, rowStruct->GetName(), layout, nameText) ||
+                !csv.Open(stem.wstring() + STR(".csv"), TableExportFormat::Csv, tableName, rowStruct->GetName(), layout, nameText))
+            {
+                Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Export: cannot write {}\n"), stem.wstring());
+                continue;
+            }
+            for (const auto& pair : table->GetRowMap())
+            {
+                if (!pair.Value) continue;
+                std::wstring rowName = pair.Key.ToString();
+                binary.AddRow(rowName, pair.Value);
+                csv.AddRow(rowName, pair.Value);
+            }
+            bool written = binary.Close() & csv.Close();
+            Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Exported {} row(s), {} of {} field(s) of {} to {}.isbt/.csv{}\n"),
+                binary.Rows(), binary.ExportedFields(), layout.Fields().size(), tableName, stem.wstring(), written ? STR("") : STR(" (write failed)"));
+        }
+    }
+
+    void StartDataTableDiscovery()
+    {
+        UClass* dataTableClass = UObjectGlobals::StaticFindObject<UClass*>(nullptr, nullptr, STR("/Script/Engine.DataTable"));
+        if (!dataTableClass)
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] DataTable class not found, cannot discover DT_Enemies\n"));
+            return;
+        }
+
+        // Intern the name once; matching is then a class pointer + FName compare per constructed object
+        m_enemyTableWatch = m_discovery.Watch(dataTableClass, FName(STR("DT_Enemies"), FNAME_Add));
+        size_t cachedObjects = m_discovery.Offer(m_enemyTableWatch, FindCachedObject(STR("table:DT_Enemies")));
+
+        // Template sections wait for their Blueprint class to load
+        UClass* blueprintClass = UObjectGlobals::StaticFindObject<UClass*>(nullptr, nullptr, STR("/Script/Engine.BlueprintGeneratedClass"));
+        for (PatchTarget& target : m_patchTargets)
+        {
+            std::wstring name = target.Group.IsObject() ? StackBoost::TemplateOwnerClassName(target.Group.Table) : target.Group.Table;
+            std::wstring cacheKey = (target.Group.IsObject() ? STR("class:") : STR("table:")) + name;
+            target.Watch = m_discovery.Watch(target.Group.IsObject() ? blueprintClass : dataTableClass, FName(name.c_str(), FNAME_Add));
+            if (target.Watch == ObjectDiscovery::InvalidWatch)
+            {
+                Output::send<LogLevel::Warning>(
+                    STR("[InventoryStackSizeBoost] {}: too many sections (or class unknown), [{}] will not be patched\n"), PATCHES_FILE_NAME, target.Group.Table);
+                continue;
+            }
+            cachedObjects += m_discovery.Offer(target.Watch, FindCachedObject(cacheKey));
+        }
+
+        // Objects already loaded at their cached paths need no object-array walk
+        if (cachedObjects > 0)
+        {
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] {} table(s) and class(es) found at their cached paths\n"), cachedObjects);
+        }
+        m_discovery.Start();
+
+        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Waiting for DT_Enemies to be constructed...\n"));
+    }
+
+    // Returns true once the table has been accepted
+    bool TryAcceptDataTable()
+    {
+        UObject* found = m_discovery.Get(m_enemyTableWatch);
+        if (!found)
+        {
+            return m_enemyTableWatch == ObjectDiscovery::InvalidWatch; // Not constructed yet (or never will be)
+        }
+
+        // The table is reported on construction; its rows are serialized afterwards
+        UDataTable* dataTable = static_cast<UDataTable*>(found);
+        if (dataTable->GetRowMap().Num() == 0)
+        {
+            return false;
+        }
+
+        m_enemyDataTable = dataTable; // Store for exchange hook
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Selected DataTable: {} (stored for exchange hook)\n"), dataTable->GetFullName());
+
+        DiscoveryCache::Record cached;
+        uint32_t rowCount = static_cast<uint32_t>(dataTable->GetRowMap().Num());
+        if (m_discoveryCache.Find(STR("table:DT_Enemies"), cached) && cached.A != rowCount)
+        {
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] DT_Enemies has {} rows, {} on the last launch\n"), rowCount, cached.A);
+        }
+        m_discoveryCache.Set(STR("table:DT_Enemies"), dataTable->GetPathName(), rowCount);
+        ResolveEnemyRowLayout(dataTable);
+        BuildItemSortRanks(dataTable);
+        SaveDiscoveryCache();
+
+        // Nothing is patched here: the stacks change on Shift+J, during exchanges or through VirtualStacks
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] DataTable found and stored\n"));
+        return true;
+    }
+
+    void ResolveEnemyRowLayout(UDataTable* dataTable)
+    {
+        m_maxStackField = {};
+
+        UScriptStruct* rowStruct = dataTable->GetRowStruct();
+        if (!rowStruct)
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] DataTable has no row struct, patching disabled\n"));
+            return;
+        }
+
+        const FieldLayout& layout = m_rowLayouts.Get(rowStruct);
+        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] RowStruct: {} ({} properties)\n"),
+            rowStruct->GetFullName(), layout.Fields().size());
+
+        for (const FieldExpectation& expected : ENEMY_CONFIG_FIELDS)
+        {
+            FieldCheck check = layout.Check(expected);
+            if (check == FieldCheck::Match)
+            {
+                continue;
+            }
+
+            const StackBoost::FieldInfo* actual = layout.Find(expected.Name);
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] Row struct field '{}' {}: expected {} @ 0x{:X} (size {}), found {} @ 0x{:X} (size {})\n"),
+                expected.Name, StackBoost::FieldCheckName(check),
+                StackBoost::FieldTypeName(expected.Type), expected.Offset, expected.Size,
+                actual ? StackBoost::FieldTypeName(actual->Type) : STR("-"), actual ? actual->Offset : 0u, actual ? actual->Size : 0u);
+        }
+
+        // A moved field is still safe to use through its resolved offset; a retyped one is not
+        m_maxStackField = layout.Accessor(EnemyConfig::MaximumStack);
+        if (!m_maxStackField.IsValid())
+        {
+            Output::send<LogLevel::Error>(
+                STR("[InventoryStackSizeBoost] MaximumStack is missing or not an int32 in this game version, patching disabled\n"));
+            return;
+        }
+
+        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] MaximumStack resolved @ offset 0x{:X}\n"), m_maxStackField.Offset);
+
+        DiscoveryCache::Record cached;
+        if (m_discoveryCache.Find(STR("field:DT_Enemies.MaximumStack"), cached) && cached.A != m_maxStackField.Offset)
+        {
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] MaximumStack moved from 0x{:X} to 0x{:X} within the same game build\n"),
+                cached.A, m_maxStackField.Offset);
+        }
+        m_discoveryCache.Set(STR("field:DT_Enemies.MaximumStack"), rowStruct->GetPathName(), m_maxStackField.Offset, sizeof(int32_t));
+    }
+
+    void DeclareHookTargets()
+    {
+        m_getItemTotalStackTarget = DeclareHookTarget(STR("BeltTDInventoryInstance"), STR("GetItemTotalStack"));
+        m_tryExchangeTarget = DeclareHookTarget(STR("BeltTDInventoryComponent"), STR("TryExchangeInventorySlot"));
+        m_inventoryUpdateTarget = DeclareHookTarget(STR("BeltTDPlayerController"), STR("OnInventoryUpdate"));
+    }
+
+    size_t DeclareHookTarget(const wchar_t* ownerClass, const wchar_t* functionName)
+    {
+        size_t target = m_functionResolver.Add(ownerClass, functionName);
+        if (target != FunctionResolver::InvalidTarget)
+        {
+            m_hookTargetKeys.resize(target + 1);
+            m_hookTargetKeys[target] = std::wstring(STR("function:")) + ownerClass + STR(".") + functionName;
+        }
+        return target;
+    }
+
+    // Returns true once every declared target has been found
+    bool ResolveHookTargets()
+    {
+        auto onResolved = [this](size_t target, UFunction* function) {
+            Output::send<LogLevel::Default>(
+                STR("[InventoryStackSizeBoost] Found matching function: {}\n"), function->GetFullName());
+            m_discoveryCache.Set(m_hookTargetKeys[target], function->GetPathName());
+
+            if (target == m_getItemTotalStackTarget)
+            {
+                m_getItemTotalStackFunction = function;
+                TryHookGetItemTotalStack();
+            }
+            else if (target == m_tryExchangeTarget)
+            {
+                m_tryExchangeFunction = function;
+                // TryHookTryExchangeInventorySlot();
+            }
+            else if (target == m_inventoryUpdateTarget)
+            {
+                m_inventoryUpdateFunction = function;
+                TryHookOnInventoryUpdate();
+            }
+        };
+
+        // Paths cached for this game build came from the objects themselves on the last
+        // launch, so looking them up is safe; arbitrary StaticFindObject path guesses are
+        // avoided as they can cause fatal errors with invalid paths
+        for (size_t target = 0; target < m_hookTargetKeys.size(); ++target)
+        {
+            if (!m_functionResolver.Get(target))
+            {
+                m_functionResolver.Offer(target, FindCachedObject(m_hookTargetKeys[target]), onResolved);
+            }
+        }
+
+        // Anything not cached (or no longer valid) is matched in a single pass over the object array
+        size_t resolved = m_functionResolver.Resolve(onResolved);
+
+        if (!m_functionResolver.AllResolved())
+        {
+            Output::send<LogLevel::Verbose>(
+                STR("[InventoryStackSizeBoost] Resolved {} hook target(s) this pass, will retry for the rest...\n"), resolved);
+            return false;
+        }
+        SaveDiscoveryCache();
+        return true;
+    }
+
+    void TryHookGetItemTotalStack()
+    {
+        if (m_hook_registered || !m_getItemTotalStackFunction)
+        {
+            return;
+        }
+
+        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Attempting to hook GetItemTotalStack...\n"));
+
+        // Register post-hook to capture return value
+        auto postHook = [](UnrealScriptFunctionCallableContext& Context, void* CustomData) -> void {
+            InventoryStackSizeBoost* mod = static_cast<InventoryStackSizeBoost*>(CustomData);
+            ScopedHookTimer timer(mod->m_statsItemTotalStack);
+            
+            // Get the return value (assuming it's an int32)
+            int32_t* returnValue = static_cast<int32_t*>(Context.RESULT_DECL);
+            
+            // Virtual limits: one array load keyed by the item's name
+            if (const VirtualStackLimits::Limits* limits = mod->m_virtualLimits.Active())
+            {
+                if (const FName* item = mod->ItemNameOf(Context.Context))
+                {
+                    int32_t limit = limits->Find(item->GetComparisonIndex(), item->GetNumber());
+                    if (limit != VirtualStackLimits::NoOverride)
+                    {
+                        *returnValue = limit;
+                    }
+                }
+            }
+            
+            // Only the pointer is recorded; building the full name here would cost more than the call itself
+            mod->m_log.Log(LOG_ITEM_TOTAL_STACK, Context.Context, *returnValue);
+        };
+
+        try
+        {
+            m_hook_ids = UObjectGlobals::RegisterHook(
+                m_getItemTotalStackFunction,
+                nullptr, // Pre-hook (nullptr = no pre-hook)
+                postHook,
+                this // CustomData
+            );
+            
+            Output::send<LogLevel::Default>(
+                STR("[InventoryStackSizeBoost] SUCCESS: Hooked GetItemTotalStack (IDs: {}, {})\n"),
+                m_hook_ids.first, m_hook_ids.second);
+            
+            m_hook_registered = true;
+        }
+        catch (const std::exception& e)
+        {
+            // Convert exception message to StringType (wstring)
+            std::string errorStr = e.what();
+            StringType errorMsg = STR("Failed to register hook: ");
+            errorMsg += StringType(errorStr.begin(), errorStr.end());
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] {}\n"), errorMsg);
+        }
+    }
+
+    // The item FName of an inventory instance, preferring a field named for it.
+    // Resolved once per class.
+    const FName* ItemNameOf(UObject* instance)
+    {
+        if (!instance)
+        {
+            return nullptr;
+        }
+        UClass* instanceClass = instance->GetClassPrivate();
+        if (m_itemInstance.InstanceClass != instanceClass)
+        {
+            const StackBoost::FieldInfo* nameField = nullptr;
+            for (const StackBoost::FieldInfo& field : m_rowLayouts.Get(instanceClass).Fields())
+            {
+                if (field.Type == FieldType::Name && (!nameField || field.Name.find(STR("Item")) != std::wstring::npos))
+                {
+                    nameField = &field;
+                }
+            }
+            m_itemInstance = {instanceClass, nameField ? nameField->Offset : 0, nameField != nullptr};
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Virtual stack limits read the item name from {}.{}\n"),
+                instanceClass->GetName(), nameField ? nameField->Name : STR("(none)"));
+        }
+        if (!m_itemInstance.Valid)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<const FName*>(reinterpret_cast<unsigned char*>(instance) + m_itemInstance.ItemNameOffset);
+    }
+
+    void TryHookOnInventoryUpdate()
+    {
+        if (m_inventoryUpdate_hook_registered || !m_inventoryUpdateFunction)
+        {
+            return;
+        }
+
+        // Pre-hook: a bulk transfer fires the event once per slot, so it only queues
+        // one sort of this controller's inventory for the start of the next frame.
+        // Registered regardless of AutoSort so the setting can be toggled live.
+        auto preHook = [](UnrealScriptFunctionCallableContext& Context, void* CustomData) -> void {
+            InventoryStackSizeBoost* mod = static_cast<InventoryStackSizeBoost*>(CustomData);
+            if (!mod->m_config.AutoSort || mod->m_itemSortRanks.empty())
+            {
+                return;
+            }
+
+            ScopedHookTimer timer(mod->m_statsInventoryUpdate);
+            mod->m_frames.Post(mod->m_sortInventoryAction, Context.Context);
+        };
+
+        try
+        {
+            m_inventoryUpdate_hook_ids = UObjectGlobals::RegisterHook(m_inventoryUpdateFunction, preHook, nullptr, this);
+
+            Output::send<LogLevel::Default>(
+                STR("[InventoryStackSizeBoost] SUCCESS: Hooked OnInventoryUpdate (IDs: {}, {}), auto-sort {}\n"),
+                m_inventoryUpdate_hook_ids.first, m_inventoryUpdate_hook_ids.second, m_config.AutoSort ? STR("on") : STR("off"));
+
+            m_inventoryUpdate_hook_registered = true;
+        }
+        catch (const std::exception& e)
+        {
+            std::string errorStr = e.what();
+            StringType errorMsg = STR("Failed to register OnInventoryUpdate hook: ");
+            errorMsg += StringType(errorStr.begin(), errorStr.end());
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] {}\n"), errorMsg);
+        }
+    }
+
+    // Items sort in DT_Enemies row order, the order the game's own data lists them in
+    void BuildItemSortRanks(UDataTable* dataTable)
+    {
+        m_itemSortRanks.clear();
+        uint32_t rank = 0;
+        for (const auto& pair : dataTable->GetRowMap())
+        {
+            m_itemSortRanks.emplace(AsyncLog::PackName(pair.Key), rank++);
+        }
+        m_inventorySorter.Reset();
+    }
+
+    uint64_t SlotSortKey(const FName& item) const
+    {
+        if (item == NAME_None)
+        {
+            return StackBoost::EmptySlotKey;
+        }
+        auto rank = m_itemSortRanks.find(AsyncLog::PackName(item));
+        if (rank != m_itemSortRanks.end())
+        {
+            return rank->second;
+        }
+        // Items missing from the table go after every known one, grouped by name
+        return (uint64_t{1} << 32) | item.GetComparisonIndex();
+    }
+
+    // The inventory's slot array: an array of structs holding an item FName,
+    // preferring property and field names that say so. Resolved once per class.
+    bool ResolveInventorySlots(UObject* inventory)
+    {
+        UClass* inventoryClass = inventory->GetClassPrivate();
+        if (m_inventorySlots.InventoryClass == inventoryClass)
+        {
+            return m_inventorySlots.Valid;
+        }
+        m_inventorySlots.InventoryClass = inventoryClass;
+        m_inventorySlots.Valid = false;
+        m_inventorySorter.Reset();
+
+        FArrayProperty* slotsProperty = nullptr;
+        const StackBoost::FieldInfo* itemField = nullptr;
+        const StackBoost::FieldInfo* stackField = nullptr;
+        for (UStruct* current = inventoryClass; current; current = current->GetSuperStruct())
+        {
+            for (FProperty* prop = current->GetFirstProperty(); prop; prop = prop->GetNextFieldAsProperty())
+            {
+                if (prop->GetClass().GetName() != STR("ArrayProperty"))
+                {
+                    continue;
+                }
+                FProperty* inner = static_cast<FArrayProperty*>(prop)->GetInner();
+                if (!inner || inner->GetClass().GetName() != STR("StructProperty"))
+                {
+                    continue;
+                }
+
+                const FieldLayout& slotLayout = m_rowLayouts.Get(static_cast<FStructProperty*>(inner)->GetStruct());
+                const StackBoost::FieldInfo* nameField = nullptr;
+                const StackBoost::FieldInfo* countField = nullptr;
+                for (const StackBoost::FieldInfo& field : slotLayout.Fields())
+                {
+                    if (field.Type == FieldType::Name && (!nameField || field.Name.find(STR("Item")) != std::wstring::npos))
+                    {
+                        nameField = &field;
+                    }
+                    // Only a field named as a count: compaction writes merged stack sizes into it
+                    if (field.Type == FieldType::Int32 && IsStackCountName(field.Name))
+                    {
+                        countField = &field;
+                    }
+                }
+                if (!nameField)
+                {
+                    continue;
+                }
+
+                bool preferred = prop->GetName().find(STR("Slot")) != StringType::npos;
+                if (!slotsProperty || preferred)
+                {
+                    slotsProperty = static_cast<FArrayProperty*>(prop);
+                    itemField = nameField;
+                    stackField = countField;
+                    m_inventorySlots.SlotSize = static_cast<size_t>(inner->GetElementSize());
+                }
+                if (preferred)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (!slotsProperty || m_inventorySlots.SlotSize == 0)
+        {
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] No item slot array found on {}, auto-sort disabled\n"), inventoryClass->GetName());
+            return false;
+        }
+
+        m_inventorySlots.SlotsOffset = static_cast<size_t>(slotsProperty->GetOffset_Internal());
+        m_inventorySlots.ItemNameOffset = itemField->Offset;
+        m_inventorySlots.HasCount = stackField != nullptr;
+        m_inventorySlots.CountOffset = stackField ? stackField->Offset : 0;
+        m_inventorySlots.Valid = true;
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Auto-sort uses {}.{} by {} ({} bytes per slot, count: {})\n"),
+            inventoryClass->GetName(), slotsProperty->GetName(), itemField->Name, m_inventorySlots.SlotSize,
+            stackField ? stackField->Name : std::wstring(STR("none")));
+        return true;
+    }
+
+    static bool IsStackCountName(const std::wstring& name)
+    {
+        for (const wchar_t* word : {STR("Count"), STR("Amount"), STR("Quantity"), STR("Stack")})
+        {
+            if (name.find(word) != std::wstring::npos)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    UObject* GetPlayerInventory(UObject* controller)
+    {
+        UClass* controllerClass = controller->GetClassPrivate();
+        if (m_inventorySlots.ControllerClass != controllerClass)
+        {
+            m_inventorySlots.ControllerClass = controllerClass;
+            m_inventorySlots.InventoryOffset = 0;
+            FProperty* inventoryProperty = controllerClass->GetPropertyByNameInChain(STR("PlayerInventory"));
+            if (inventoryProperty && inventoryProperty->GetClass().GetName() == STR("ObjectProperty"))
+            {
+                m_inventorySlots.InventoryOffset = static_cast<size_t>(inventoryProperty->GetOffset_Internal());
+            }
+        }
+        if (m_inventorySlots.InventoryOffset == 0)
+        {
+            return nullptr;
+        }
+        return *reinterpret_cast<UObject**>(reinterpret_cast<unsigned char*>(controller) + m_inventorySlots.InventoryOffset);
+    }
+
+    // Frame actions posted from Lua carry no target; the local player's controller is meant
+    UObject* ResolveInventoryController(UObject* controller)
+    {
+        if (!controller)
+        {
+            controller = UObjectGlobals::FindFirstOf(STR("BeltTDPlayerController"));
+        }
+        return controller && !controller->IsUnreachable() ? controller : nullptr;
+    }
+
+    // Calls a UFunction without meaningful parameters (outputs are ignored)
+    void CallWithoutParams(UObject* object, UFunction* function)
+    {
+        m_callParams.assign(function->GetParmsSize(), 0);
+        object->ProcessEvent(function, m_callParams.empty() ? nullptr : m_callParams.data());
+    }
+
+    void SortInventoryAction(UObject* controller)
+    {
+        controller = ResolveInventoryController(controller);
+        if (!controller || m_itemSortRanks.empty() || SortInventory(controller) == 0)
+        {
+            return;
+        }
+
+        // The slots moved after the game handled the update; have it refresh again.
+        // The event posts this sort once more, which is ignored while it runs.
+        if (m_inventoryUpdateFunction)
+        {
+            CallWithoutParams(controller, m_inventoryUpdateFunction);
+        }
+    }
+
+    // The game's own full sort, for Lua mods that used to call it on every update
+    void RearrangeInventoryAction(UObject* controller)
+    {
+        controller = ResolveInventoryController(controller);
+        UObject* inventory = controller ? GetPlayerInventory(controller) : nullptr;
+        if (!inventory)
+        {
+            return;
+        }
+        if (!m_rearrangeFunction)
+        {
+            m_rearrangeFunction = inventory->GetFunctionByNameInChain(FName(STR("RearrangePlayerInventory")));
+            if (!m_rearrangeFunction)
+            {
+                return;
+            }
+        }
+        CallWithoutParams(inventory, m_rearrangeFunction);
+    }
+
+    // Returns the number of slot writes
+    size_t SortInventory(UObject* controller)
+    {
+        UObject* inventory = controller ? GetPlayerInventory(controller) : nullptr;
+        if (!inventory || !ResolveInventorySlots(inventory))
+        {
+            return 0;
+        }
+        if (inventory != m_sortedInventory)
+        {
+            m_sortedInventory = inventory;
+            m_inventorySorter.Reset();
+        }
+
+        ScriptArrayView& slots = *reinterpret_cast<ScriptArrayView*>(reinterpret_cast<unsigned char*>(inventory) + m_inventorySlots.SlotsOffset);
+        if (!slots.Data || slots.Num <= 0)
+        {
+            return 0;
+        }
+
+        size_t count = static_cast<size_t>(slots.Num);
+        m_slotKeys.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const FName& item = *reinterpret_cast<const FName*>(slots.Data + i * m_inventorySlots.SlotSize + m_inventorySlots.ItemNameOffset);
+            m_slotKeys[i] = SlotSortKey(item);
+        }
+
+        StackBoost::SlotSortResult result = m_inventorySorter.Update(m_slotKeys.data(), count);
+        if (result.Moved == 0)
+        {
+            return 0;
+        }
+
+        size_t writes = StackBoost::ApplySlotPermutation(slots.Data, m_inventorySlots.SlotSize, m_inventorySorter.Source(), m_slotScratch, m_slotPlaced);
+        m_log.Log(LOG_INVENTORY_SORTED, static_cast<uint32_t>(result.Changed), static_cast<uint32_t>(result.Moved), static_cast<uint32_t>(count));
+        return writes;
+    }
+
+    // Merges partial stacks of the same item up to its current limit (Shift+C, and
+    // after J raises the limits). Only stack counts and emptied slots are written.
+    void CompactInventoryAction(UObject* controller)
+    {
+        controller = ResolveInventoryController(controller);
+        if (!controller || !m_enemyDataTable || !m_maxStackField.IsValid() || CompactInventory(controller) == 0)
+        {
+            return;
+        }
+        if (m_inventoryUpdateFunction)
+        {
+            CallWithoutParams(controller, m_inventoryUpdateFunction);
+        }
+    }
+
+    // The stack size the game allows for an item right now
+    int32_t ItemStackLimit(const FName& item, const VirtualStackLimits::Limits* limits)
+    {
+        if (limits)
+        {
+            int32_t limit = limits->Find(item.GetComparisonIndex(), item.GetNumber());
+            if (limit != VirtualStackLimits::NoOverride)
+            {
+                return limit;
+            }
+        }
+        auto& rowMap = const_cast<TMap<FName, unsigned char*>&>(m_enemyDataTable->GetRowMap());
+        unsigned char** row = rowMap.Find(item);
+        return row && *row ? m_maxStackField.Get(*row) : 0;
+    }
+
+    // Returns the number of slot writes
+    size_t CompactInventory(UObject* controller)
+    {
+        UObject* inventory = GetPlayerInventory(controller);
+        if (!inventory || !ResolveInventorySlots(inventory))
+        {
+            return 0;
+        }
+        if (!m_inventorySlots.HasCount)
+        {
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] Inventory slots have no int32 field named Count, Amount, Quantity or Stack, cannot compact\n"));
+            return 0;
+        }
+
+        ScriptArrayView& slots = *reinterpret_cast<ScriptArrayView*>(reinterpret_cast<unsigned char*>(inventory) + m_inventorySlots.SlotsOffset);
+        if (!slots.Data || slots.Num <= 0)
+        {
+            return 0;
+        }
+
+        size_t count = static_cast<size_t>(slots.Num);
+        auto slotAt = [&](size_t i) { return slots.Data + i * m_inventorySlots.SlotSize; };
+        m_slotKeys.resize(count);
+        m_slotCounts.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const FName& item = *reinterpret_cast<const FName*>(slotAt(i) + m_inventorySlots.ItemNameOffset);
+            m_slotKeys[i] = item == NAME_None ? StackBoost::EmptySlotKey : AsyncLog::PackName(item);
+            m_slotCounts[i] = *reinterpret_cast<const int32_t*>(slotAt(i) + m_inventorySlots.CountOffset);
+        }
+
+        const VirtualStackLimits::Limits* limits = m_virtualLimits.Active();
+        const std::vector<StackBoost::SlotCountWrite>& writes =
+            m_stackCompactor.Plan(m_slotKeys.data(), m_slotCounts.data(), count, [&](size_t slot) {
+                return ItemStackLimit(*reinterpret_cast<const FName*>(slotAt(slot) + m_inventorySlots.ItemNameOffset), limits);
+            });
+
+        for (const StackBoost::SlotCountWrite& write : writes)
+        {
+            unsigned char* slot = slotAt(write.Slot);
+            *reinterpret_cast<int32_t*>(slot + m_inventorySlots.CountOffset) = write.Count;
+            if (write.Count == 0)
+            {
+                *reinterpret_cast<FName*>(slot + m_inventorySlots.ItemNameOffset) = NAME_None;
+            }
+        }
+        if (!writes.empty())
+        {
+            m_inventorySorter.Reset(); // Emptied slots change the sort keys
+            m_log.Log(LOG_INVENTORY_COMPACTED, static_cast<uint32_t>(writes.size()), static_cast<uint32_t>(m_stackCompactor.Emptied()));
         }
+        return writes.size();
     }
 
     void TryHookTryExchangeInventorySlot()
@@ -355,87 +1969,73 @@ private:
             return;
         }
 
-        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Attempting to hook TryExchangeInventorySlot function...\n"));
-
-        // Search for the function
-        std::vector<UObject*> allFunctions;
-        UObjectGlobals::FindAllOf(STR("Function"), allFunctions);
-        
-        Output::send<LogLevel::Verbose>(
-            STR("[InventoryStackSizeBoost] Searching {} functions for TryExchangeInventorySlot...\n"), allFunctions.size());
-        
-        // Look for TryExchangeInventorySlot in UBeltTDInventoryComponent
-        for (UObject* obj : allFunctions)
-        {
-            if (!obj) continue;
-            
-            StringType name = obj->GetName();
-            StringType fullName = obj->GetFullName();
-            
-            // Check if this matches TryExchangeInventorySlot in BeltTDInventoryComponent
-            if (name.find(STR("TryExchangeInventorySlot")) != StringType::npos &&
-                fullName.find(STR("BeltTDInventoryComponent")) != StringType::npos)
-            {
-                Output::send<LogLevel::Default>(
-                    STR("[InventoryStackSizeBoost] Found TryExchangeInventorySlot function: {}\n"), fullName);
-                m_tryExchangeFunction = static_cast<UFunction*>(obj);
-                break;
-            }
-        }
-
         if (!m_tryExchangeFunction)
         {
             Output::send<LogLevel::Verbose>(
-                STR("[InventoryStackSizeBoost] TryExchangeInventorySlot function not found yet, will retry...\n"));
+                STR("[InventoryStackSizeBoost] TryExchangeInventorySlot function not resolved yet, will retry...\n"));
             return;
         }
 
-        // Pre-hook: Temporarily patch stacks to MAX_STACK BEFORE TryExchangeInventorySlot runs
+        Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Attempting to hook TryExchangeInventorySlot function...\n"));
+
+        ResolveExchangeItemParams();
+
+        // Pre-hook: Temporarily patch stacks to their configured size BEFORE TryExchangeInventorySlot runs
         auto preHook = [](UnrealScriptFunctionCallableContext& Context, void* CustomData) -> void {
             InventoryStackSizeBoost* mod = static_cast<InventoryStackSizeBoost*>(CustomData);
+            ScopedHookTimer timer(mod->m_statsExchangePre);
             
-            if (!mod->m_enemyDataTable)
+            if (!mod->m_enemyDataTable || t_exchangeDepth++ > 0)
             {
                 return;
             }
 
-            // Don't patch if manual patching is active (user pressed J)
-            if (mod->m_stacksArePatched)
+            // Don't patch if manual patching is active (user pressed J); one load, no write
+            if (mod->StacksArePatched())
             {
-                Output::send<LogLevel::Verbose>(
-                    STR("[InventoryStackSizeBoost] TryExchangeInventorySlot pre-hook: Skipping (manual patch active)\n"));
+                mod->m_log.Log(LOG_EXCHANGE_PRE_SKIPPED);
                 return;
             }
 
-            Output::send<LogLevel::Verbose>(
-                STR("[InventoryStackSizeBoost] TryExchangeInventorySlot pre-hook: Patching stacks to MAX_STACK...\n"));
-
-            // Use the shared patching function, but don't set m_stacksArePatched flag
-            mod->PatchAllStacksToMaxInternal(false);
+            switch (mod->m_patchState.TryBegin(PatchStateMachine::Op::Exchange))
+            {
+            case PatchStateMachine::Result::Began:
+                t_exchangeOwner = true;
+                mod->PatchExchangeRows(Context.TheStack.Locals());
+                break;
+            case PatchStateMachine::Result::AlreadyPatched:
+                mod->m_log.Log(LOG_EXCHANGE_PRE_SKIPPED);
+                break;
+            default:
+                mod->m_log.Log(LOG_EXCHANGE_BUSY, static_cast<uint32_t>(mod->m_exchangeBusyCalls.fetch_add(1, std::memory_order_relaxed) + 1));
+                break;
+            }
         };
 
         // Post-hook: Restore original MaximumStack values AFTER TryExchangeInventorySlot completes
         auto postHook = [](UnrealScriptFunctionCallableContext& Context, void* CustomData) -> void {
             InventoryStackSizeBoost* mod = static_cast<InventoryStackSizeBoost*>(CustomData);
+            ScopedHookTimer timer(mod->m_statsExchangePost);
             
-            if (!mod->m_enemyDataTable)
+            if (t_exchangeDepth == 0 || --t_exchangeDepth > 0)
             {
                 return;
             }
 
-            // Don't restore if manual patching is active (user pressed J)
-            if (mod->m_stacksArePatched)
+            // Only the thread whose pre-hook took the rows puts them back
+            if (!t_exchangeOwner)
             {
-                Output::send<LogLevel::Verbose>(
-                    STR("[InventoryStackSizeBoost] TryExchangeInventorySlot post-hook: Skipping restore (manual patch active)\n"));
+                if (mod->StacksArePatched())
+                {
+                    mod->m_log.Log(LOG_EXCHANGE_POST_SKIPPED);
+                }
                 return;
             }
 
-            Output::send<LogLevel::Verbose>(
-                STR("[InventoryStackSizeBoost] TryExchangeInventorySlot post-hook: Restoring stacks to default...\n"));
-
-            // Use the shared restore function, but don't set m_stacksArePatched flag
-            mod->RestoreAllStacksToDefaultInternal(false);
+            // Rows touched by the whole exchange are attributed to the post-hook
+            timer.SetRowsTouched(mod->RestoreExchangeRows());
+            t_exchangeOwner = false;
+            mod->EndPatchState();
         };
 
         try
@@ -463,34 +2063,168 @@ private:
         }
     }
 
-    void CheckKeyboardInput()
+    // Finds the item row names TryExchangeInventorySlot receives, either as FName
+    // parameters or as the first FName field of a struct parameter (e.g. a slot).
+    // If none are found every exchange falls back to patching the whole table.
+    void ResolveExchangeItemParams()
     {
-        // Check Shift key state
-        bool shiftPressed = (GetAsyncKeyState(VK_SHIFT) & 0x8000) != 0;
-        
-        // Check Shift+J key (patch to max)
-        bool jKeyDown = (GetAsyncKeyState('J') & 0x8000) != 0;
-        if (shiftPressed && jKeyDown && !m_jKeyPressed)
+        m_exchangeItemNameOffsets.clear();
+
+        for (FProperty* param = m_tryExchangeFunction->GetFirstProperty(); param; param = param->GetNextFieldAsProperty())
         {
-            m_jKeyPressed = true;
-            PatchAllStacksToMax();
+            if (!param->HasAnyPropertyFlags(CPF_Parm) || param->HasAnyPropertyFlags(CPF_ReturnParm))
+            {
+                continue;
+            }
+
+            uint32_t paramOffset = static_cast<uint32_t>(param->GetOffset_Internal());
+            FieldType paramType = StackBoost::FieldTypeFromPropertyClass(param->GetClass().GetName());
+            if (paramType == FieldType::Name)
+            {
+                m_exchangeItemNameOffsets.push_back(paramOffset);
+            }
+            else if (paramType == FieldType::Struct)
+            {
+                UScriptStruct* paramStruct = static_cast<FStructProperty*>(param)->GetStruct();
+                if (!paramStruct)
+                {
+                    continue;
+                }
+                for (const StackBoost::FieldInfo& field : m_rowLayouts.Get(paramStruct).Fields())
+                {
+                    if (field.Type == FieldType::Name)
+                    {
+                        m_exchangeItemNameOffsets.push_back(paramOffset + field.Offset);
+                        break;
+                    }
+                }
+            }
+
+            if (m_exchangeItemNameOffsets.size() == MAX_EXCHANGE_ITEMS)
+            {
+                break;
+            }
         }
-        else if (!shiftPressed || !jKeyDown)
+
+        if (m_exchangeItemNameOffsets.empty())
         {
-            m_jKeyPressed = false;
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] TryExchangeInventorySlot: no item parameters found, exchanges will patch the whole table\n"));
         }
-        
-        // Check Shift+K key (restore to default)
-        bool kKeyDown = (GetAsyncKeyState('K') & 0x8000) != 0;
-        if (shiftPressed && kKeyDown && !m_kKeyPressed)
+        else
+        {
+            Output::send<LogLevel::Verbose>(
+                STR("[InventoryStackSizeBoost] TryExchangeInventorySlot: reading {} item name(s) from parameters\n"),
+                m_exchangeItemNameOffsets.size());
+        }
+    }
+
+    void PatchExchangeRows(unsigned char* params)
+    {
+        m_exchangeCounters.Calls++;
+
+        bool identified = false;
+        if (params && !m_exchangeItemNameOffsets.empty() && m_maxStackField.IsValid())
+        {
+            std::array<FName, MAX_EXCHANGE_ITEMS> itemNames{};
+            for (size_t i = 0; i < m_exchangeItemNameOffsets.size(); ++i)
+            {
+                itemNames[i] = *reinterpret_cast<const FName*>(params + m_exchangeItemNameOffsets[i]);
+            }
+
+            if (m_journal.IsActive(m_exchangeLayer))
+            {
+                // A post-hook that never ran; undo it rather than stacking on top
+                m_journal.Revert(m_exchangeLayer);
+            }
+            m_exchangeLayer = m_journal.Begin(L"exchange");
+
+            TMap<FName, unsigned char*>& rowMap = const_cast<TMap<FName, unsigned char*>&>(m_enemyDataTable->GetRowMap());
+            if (m_config.Overrides.empty())
+            {
+                identified = m_exchangePatch.Patch(m_journal, m_exchangeLayer, rowMap, itemNames.data(), m_exchangeItemNameOffsets.size(),
+                                                   NAME_None, m_maxStackField, m_config.MaxStack);
+            }
+            else
+            {
+                // Per-row overrides are looked up in the compiled rules, never matched here
+                EnsureStackRules();
+                identified = m_exchangePatch.PatchWithTargets(m_journal, m_exchangeLayer, rowMap, itemNames.data(),
+                                                              m_exchangeItemNameOffsets.size(), NAME_None, m_maxStackField,
+                                                              [this](int32_t* field, int32_t original) {
+                                                                  return m_stackRules.TargetFor(field, original);
+                                                              });
+            }
+            if (!identified)
+            {
+                m_journal.Revert(m_exchangeLayer);
+                m_exchangeLayer = PatchJournal::InvalidLayer;
+            }
+        }
+
+        if (!identified)
+        {
+            m_exchangeMode = ExchangePatchMode::Full;
+            m_exchangeCounters.FallbackCalls++;
+            m_log.Log(LOG_EXCHANGE_FALLBACK);
+            PatchAllStacksToMaxInternal(false);
+            return;
+        }
+
+        m_exchangeMode = ExchangePatchMode::Targeted;
+    }
+
+    // Returns the number of rows the exchange patched and restored
+    uint32_t RestoreExchangeRows()
+    {
+        uint32_t rowsTouched = 0;
+        if (m_exchangeMode == ExchangePatchMode::Targeted)
+        {
+            rowsTouched = static_cast<uint32_t>(m_journal.Changes(m_exchangeLayer));
+            m_journal.Revert(m_exchangeLayer);
+            m_exchangeLayer = PatchJournal::InvalidLayer;
+        }
+        else if (m_exchangeMode == ExchangePatchMode::Full)
+        {
+            rowsTouched = static_cast<uint32_t>(m_journal.Changes(m_exchangeLayer));
+            RestoreAllStacksToDefaultInternal(false);
+        }
+        m_exchangeMode = ExchangePatchMode::None;
+
+        // Each touched row is written twice: once to patch, once to restore
+        m_exchangeCounters.LastRowsTouched = rowsTouched;
+        m_exchangeCounters.RowsTouched += rowsTouched;
+        m_log.Log(LOG_EXCHANGE_ROWS_TOUCHED, rowsTouched, m_exchangeCounters.RowsTouched,
+                  m_exchangeCounters.Calls, m_exchangeCounters.FallbackCalls);
+        return rowsTouched;
+    }
+
+    void DumpHookStats()
+    {
+        std::filesystem::path modDirectory = StackBoost::ModDirectory();
+        if (modDirectory.empty())
         {
-            m_kKeyPressed = true;
-            RestoreAllStacksToDefault();
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Cannot dump hook stats: mod folder not found\n"));
+            return;
         }
-        else if (!shiftPressed || !kKeyDown)
+
+        std::lock_guard<std::mutex> lock(m_statsDumpMutex);
+        std::filesystem::path statsPath = modDirectory / STATS_FILE_NAME;
+        std::wofstream statsFile(statsPath, std::ios::trunc);
+        if (!statsFile)
         {
-            m_kKeyPressed = false;
+            Output::send<LogLevel::Warning>(STR("[InventoryStackSizeBoost] Cannot dump hook stats: failed to open {}\n"), statsPath.wstring());
+            return;
         }
+
+        statsFile << m_statsRegistry.FormatSummary();
+        Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Hook stats written to {}\n"), statsPath.wstring());
+    }
+
+    // Wait-free; safe from any hook
+    bool StacksArePatched() const
+    {
+        return m_patchState.IsPatched();
     }
 
     void PatchAllStacksToMax()
@@ -502,89 +2236,184 @@ private:
             return;
         }
 
-        // If stacks are already patched, don't do anything
-        if (m_stacksArePatched)
+        if (!m_maxStackField.IsValid())
+        {
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] Cannot patch stacks: MaximumStack field not resolved!\n"));
+            return;
+        }
+
+        if (m_config.VirtualStacks)
+        {
+            PatchVirtualStacks();
+            return;
+        }
+
+        switch (m_patchState.TryBegin(PatchStateMachine::Op::Patch))
         {
+        case PatchStateMachine::Result::Began:
+            break;
+        case PatchStateMachine::Result::AlreadyPatched:
             Output::send<LogLevel::Verbose>(
-                STR("[InventoryStackSizeBoost] Stacks are already patched to MAX_STACK\n"));
+                STR("[InventoryStackSizeBoost] Stacks are already patched to the configured sizes\n"));
+            return;
+        default:
+            m_frames.Post(m_patchStacksAction); // An exchange owns the rows
             return;
         }
 
         Output::send<LogLevel::Default>(
-            STR("[InventoryStackSizeBoost] Patching all stacks to MAX_STACK (pressed J)...\n"));
+            STR("[InventoryStackSizeBoost] Patching all stacks to the configured sizes (pressed J)...\n"));
 
-        // Use the shared function and set the flag
-        PatchAllStacksToMaxInternal(true);
+        StartStackPatchSweep();
+        RunStackSweep();
     }
 
+    // Same steps as PatchAllStacksToMaxInternal(true), spread over frames
+    void StartStackPatchSweep()
+    {
+        m_stackSweepFirstPatch = BeginStackPatch(true);
+        m_stackSweepModified = 0;
+        m_stackSweepKind = StackSweep::Patch;
+        m_stackSweep.Start(m_stackCore.Size());
+    }
+
+    // setPatchedFlag selects the manual layer; otherwise this is the exchange fallback
     void PatchAllStacksToMaxInternal(bool setPatchedFlag)
     {
-        if (!m_enemyDataTable)
+        if (!m_enemyDataTable || !m_maxStackField.IsValid())
         {
             return;
         }
 
-        // Get the DataTable row map (need non-const reference to modify)
-        TMap<FName, unsigned char*>& rowMap = const_cast<TMap<FName, unsigned char*>&>(m_enemyDataTable->GetRowMap());
-        
-        // Only store original values if we don't have them yet (first time patching)
-        bool isFirstPatch = m_originalStackValues.empty();
-        
-        // Set all MaximumStack values to MAX_STACK
+        bool isFirstPatch = BeginStackPatch(setPatchedFlag);
+        int modifiedCount = WriteStackTargets(setPatchedFlag ? m_stackLayer : m_exchangeLayer, 0, m_stackCore.Size());
+        ReportStackPatch(setPatchedFlag, isFirstPatch, modifiedCount);
+    }
+
+    // Opens the layer for a full patch. Returns true if the snapshot was (re)captured.
+    bool BeginStackPatch(bool setPatchedFlag)
+    {
+        PatchJournal::LayerId& layer = setPatchedFlag ? m_stackLayer : m_exchangeLayer;
+        if (m_journal.IsActive(layer))
+        {
+            // A fallback whose post-hook never ran; undo it rather than stacking on top
+            RestoreAllStacksToDefaultInternal(setPatchedFlag);
+        }
+
+        // Re-capture the snapshot only on first patch, or when the table's rows were replaced
+        bool isFirstPatch = !m_stackCore.IsCurrent(m_enemyDataTable, m_enemyDataTable->GetRowMap());
+        EnsureStackRules();
+        layer = m_journal.Begin(setPatchedFlag ? L"stacks" : L"exchange");
+        return isFirstPatch;
+    }
+
+    // One linear sweep over snapshot entries [begin, end); each rule is applied to the value
+    // the row holds now, so a table patch or another layer underneath is built on rather than overwritten
+    int WriteStackTargets(PatchJournal::LayerId layer, size_t begin, size_t end)
+    {
+        const std::vector<StackBoost::StackSnapshotEntry>& entries = m_stackCore.Entries();
         int modifiedCount = 0;
-        int alreadyAtMaxCount = 0;
-        for (auto& pair : rowMap)
+        for (size_t i = begin; i < end; ++i)
         {
-            unsigned char* rowData = pair.Value;
-            if (!rowData) continue;
-            
-            int32_t* maxStackPtr = reinterpret_cast<int32_t*>(rowData + OFFSET_MAXIMUM_STACK);
-            int32_t currentValue = *maxStackPtr;
-            
-            // Store original value ONLY on first patch (never overwrite)
-            if (isFirstPatch)
-            {
-                m_originalStackValues[pair.Key] = currentValue;
-            }
-            
-            // Set to max if it's a valid stackable item
-            if (currentValue > 0 && currentValue < MAX_STACK)
-            {
-                *maxStackPtr = MAX_STACK;
-                modifiedCount++;
-            }
-            else if (currentValue >= MAX_STACK)
-            {
-                alreadyAtMaxCount++;
-            }
+            int32_t* field = entries[i].MaxStack;
+            modifiedCount += m_journal.Write(layer, field, m_stackRules.Target(i, *field), static_cast<uint32_t>(i));
         }
-        
+        return modifiedCount;
+    }
+
+    void ReportStackPatch(bool setPatchedFlag, bool isFirstPatch, int modifiedCount)
+    {
         if (setPatchedFlag)
         {
-            m_stacksArePatched = true;
             if (isFirstPatch)
             {
                 Output::send<LogLevel::Default>(
-                    STR("[InventoryStackSizeBoost] Patched {} items to MAX_STACK={} (stored {} original values)\n"), 
-                    modifiedCount, MAX_STACK, m_originalStackValues.size());
+                    STR("[InventoryStackSizeBoost] Patched {} items (MaxStack={}, {} overridden, captured {} rows)\n"), 
+                    modifiedCount, m_config.MaxStack, m_stackRules.OverrideCount(), m_stackCore.Size());
             }
             else
             {
                 Output::send<LogLevel::Default>(
-                    STR("[InventoryStackSizeBoost] Patched {} items to MAX_STACK={} (using stored original values)\n"), 
-                    modifiedCount, MAX_STACK);
+                    STR("[InventoryStackSizeBoost] Patched {} items (MaxStack={}, {} overridden)\n"), 
+                    modifiedCount, m_config.MaxStack, m_stackRules.OverrideCount());
             }
         }
         else
         {
-            Output::send<LogLevel::Verbose>(
-                STR("[InventoryStackSizeBoost] Patched {} items to MAX_STACK\n"), 
-                modifiedCount);
+            m_log.Log(LOG_STACKS_PATCHED_QUIET, modifiedCount);
+        }
+    }
+
+    void PatchVirtualStacks()
+    {
+        if (m_virtualLimits.IsActive())
+        {
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Virtual stack limits are already on\n"));
+            return;
+        }
+        if (StacksArePatched())
+        {
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] DT_Enemies was patched before VirtualStacks was turned on; press K first\n"));
+            return;
+        }
+        // Building needs the snapshot, which only the owner of the rows may touch
+        if (m_patchState.TryBegin(PatchStateMachine::Op::Maintenance) != PatchStateMachine::Result::Began)
+        {
+            m_frames.Post(m_patchStacksAction);
+            return;
+        }
+        bool built = BuildVirtualLimits();
+        EndPatchState();
+        if (!built || !m_virtualLimits.Activate())
+        {
+            return;
+        }
+        Output::send<LogLevel::Default>(
+            STR("[InventoryStackSizeBoost] Virtual stack limits on (pressed J): {} item(s) answered from the hook, DT_Enemies untouched\n"),
+            m_virtualLimits.Latest()->Overrides());
+        m_frames.Post(m_compactInventoryAction);
+    }
+
+    // Owner of the patch state only. A rebuild while the limits are on takes effect at once.
+    bool BuildVirtualLimits()
+    {
+        EnsureStackRules();
+        if (m_virtualLimitsCurrent)
+        {
+            return true;
         }
+
+        const std::vector<StackBoost::StackSnapshotEntry>& entries = m_stackCore.Entries();
+        std::vector<int32_t> originals(entries.size());
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            originals[i] = entries[i].OriginalValue;
+        }
+        if (!m_virtualLimits.Build(m_stackCore.Keys(), originals, m_stackRules.Targets()))
+        {
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] DT_Enemies row names are too far apart for virtual stack limits; set VirtualStacks = false\n"));
+            return false;
+        }
+        m_virtualLimitsCurrent = true;
+        return true;
     }
 
     void RestoreAllStacksToDefault()
     {
+        // Nothing was written, so switching the limits off is the whole restore
+        if (m_virtualLimits.IsActive())
+        {
+            m_virtualLimits.Deactivate();
+            Output::send<LogLevel::Default>(STR("[InventoryStackSizeBoost] Virtual stack limits off (pressed K)\n"));
+            if (!StacksArePatched())
+            {
+                return;
+            }
+        }
+
         if (!m_enemyDataTable)
         {
             Output::send<LogLevel::Warning>(
@@ -592,105 +2421,206 @@ private:
             return;
         }
 
-        if (!m_stacksArePatched)
+        switch (m_patchState.TryBegin(PatchStateMachine::Op::Restore))
         {
+        case PatchStateMachine::Result::Began:
+            break;
+        case PatchStateMachine::Result::NotPatched:
             Output::send<LogLevel::Verbose>(
                 STR("[InventoryStackSizeBoost] Stacks are already at default values\n"));
             return;
-        }
-
-        if (m_originalStackValues.empty())
-        {
-            Output::send<LogLevel::Warning>(
-                STR("[InventoryStackSizeBoost] No original values stored to restore!\n"));
+        default:
+            m_frames.Post(m_restoreStacksAction); // An exchange owns the rows
             return;
         }
 
         Output::send<LogLevel::Default>(
             STR("[InventoryStackSizeBoost] Restoring all stacks to default (pressed K)...\n"));
 
-        // Use the shared function and set the flag
-        RestoreAllStacksToDefaultInternal(true);
+        // Same steps as RestoreAllStacksToDefaultInternal(true), spread over frames
+        if (!StackLayerRowsCurrent(m_stackLayer))
+        {
+            EndPatchState();
+            return;
+        }
+        m_stackSweepReverted = {};
+        m_stackSweepKind = StackSweep::Restore;
+        m_stackSweep.Start(m_journal.Changes(m_stackLayer));
+        RunStackSweep();
     }
 
-    void RestoreAllStacksToDefaultInternal(bool setPatchedFlag)
+    // After a config reload: restores the manual patch and applies it again with the new rules
+    void ReapplyStacks()
     {
-        if (!m_enemyDataTable || m_originalStackValues.empty())
+        switch (m_patchState.TryBegin(PatchStateMachine::Op::Restore))
         {
+        case PatchStateMachine::Result::Began:
+            break;
+        case PatchStateMachine::Result::NotPatched:
+            return; // Restored since the reload
+        default:
+            m_frames.Post(m_reapplyStacksAction); // An exchange owns the rows
             return;
         }
 
-        // Restore original values (need non-const reference to modify)
-        TMap<FName, unsigned char*>& rowMap = const_cast<TMap<FName, unsigned char*>&>(m_enemyDataTable->GetRowMap());
-        
-        int restoredCount = 0;
-        int unchangedCount = 0;
-        int notFoundCount = 0;
-        
-        // Log a few examples before/after for debugging (only for manual restore)
-        int logCount = 0;
-        const int maxLogExamples = setPatchedFlag ? 5 : 0;
-        
-        for (const auto& [itemName, originalValue] : m_originalStackValues)
+        if (!StackLayerRowsCurrent(m_stackLayer))
+        {
+            EndPatchState();
+            return;
+        }
+        m_stackSweepReverted = {};
+        m_stackSweepKind = StackSweep::Reapply;
+        m_stackSweep.Start(m_journal.Changes(m_stackLayer));
+        RunStackSweep();
+    }
+
+    // One frame's share of the J/K sweep. Runs only as a frame action, between game ticks.
+    void RunStackSweep()
+    {
+        if (m_stackSweepKind == StackSweep::None)
+        {
+            return;
+        }
+        bool patching = m_stackSweepKind == StackSweep::Patch;
+        if (!StackLayerRowsCurrent(m_stackLayer))
         {
-            auto* rowDataPtr = rowMap.Find(itemName);
-            if (rowDataPtr && *rowDataPtr)
+            m_stackSweep.Cancel();
+            m_stackSweepKind = StackSweep::None;
+            EndPatchState();
+            return;
+        }
+
+        bool done = m_stackSweep.RunFrame(std::chrono::microseconds(m_config.PatchFrameBudget), [&](size_t begin, size_t end) {
+            if (patching)
             {
-                unsigned char* rowData = *rowDataPtr;
-                int32_t* maxStackPtr = reinterpret_cast<int32_t*>(rowData + OFFSET_MAXIMUM_STACK);
-                int32_t currentValue = *maxStackPtr;
-                
-                // Log first few examples (only for manual restore)
-                if (logCount < maxLogExamples)
-                {
-                    Output::send<LogLevel::Verbose>(
-                        STR("[InventoryStackSizeBoost] Restoring '{}': {} -> {}\n"),
-                        itemName.ToString(), currentValue, originalValue);
-                    logCount++;
-                }
-                
-                // Restore the original value
-                *maxStackPtr = originalValue;
-                
-                // Verify the restore worked
-                int32_t verifyValue = *maxStackPtr;
-                if (verifyValue == originalValue)
-                {
-                    if (currentValue != originalValue)
-                    {
-                        restoredCount++;
-                    }
-                    else
-                    {
-                        unchangedCount++;
-                    }
-                }
-                else
-                {
-                    Output::send<LogLevel::Warning>(
-                        STR("[InventoryStackSizeBoost] WARNING: Restore failed for '{}': expected {}, got {}\n"),
-                        itemName.ToString(), originalValue, verifyValue);
-                }
+                m_stackSweepModified += WriteStackTargets(m_stackLayer, begin, end);
             }
             else
             {
-                notFoundCount++;
+                RevertStackEntries(true, end - begin, m_stackSweepReverted);
             }
+        });
+        if (!done)
+        {
+            const IncrementalSweep::Progress& progress = m_stackSweep.GetProgress();
+            m_log.Log(patching ? LOG_STACK_PATCH_PROGRESS : LOG_STACK_RESTORE_PROGRESS, static_cast<uint32_t>(progress.Done),
+                      static_cast<uint32_t>(progress.Total));
+            m_frames.Post(m_stackSweepAction);
+            return;
+        }
+
+        if (patching)
+        {
+            ReportStackPatch(true, m_stackSweepFirstPatch, m_stackSweepModified);
+        }
+        else
+        {
+            // A patch that changed no rows leaves an empty layer and the sweep no batches;
+            // finishing through here releases it, so the state ends Unpatched
+            RevertStackEntries(true, SIZE_MAX, m_stackSweepReverted);
+            ReportStackRestore(true, m_stackSweepReverted);
+        }
+        const IncrementalSweep::Progress& progress = m_stackSweep.GetProgress();
+        if (progress.Frames > 1)
+        {
+            Output::send<LogLevel::Verbose>(STR("[InventoryStackSizeBoost] Stack {} took {} frame(s), {} us of work\n"),
+                patching ? STR("patch") : STR("restore"), progress.Frames, progress.Busy.count());
+        }
+        if (m_stackSweepKind == StackSweep::Reapply)
+        {
+            // Still the owner: the patch half starts on the next frame
+            StartStackPatchSweep();
+            m_frames.Post(m_stackSweepAction);
+            return;
+        }
+        m_stackSweepKind = StackSweep::None;
+        EndPatchState();
+        if (patching)
+        {
+            m_frames.Post(m_compactInventoryAction); // Partial stacks can merge now
+        }
+    }
+
+    // Reverts only the fields the layer changed, skipping any the game has changed since
+    void RestoreAllStacksToDefaultInternal(bool setPatchedFlag)
+    {
+        PatchJournal::LayerId& layer = setPatchedFlag ? m_stackLayer : m_exchangeLayer;
+        if (!m_journal.IsActive(layer))
+        {
+            return;
+        }
+
+        if (!StackLayerRowsCurrent(layer))
+        {
+            return;
+        }
+        PatchJournal::RevertResult result;
+        RevertStackEntries(setPatchedFlag, SIZE_MAX, result);
+        ReportStackRestore(setPatchedFlag, result);
+    }
+
+    // False if the layer's rows are gone (the layer is discarded); writing into rows that
+    // no longer belong to the table would corrupt memory
+    bool StackLayerRowsCurrent(PatchJournal::LayerId& layer)
+    {
+        if (m_enemyDataTable && m_stackCore.IsCurrent(m_enemyDataTable, m_enemyDataTable->GetRowMap()))
+        {
+            return true;
+        }
+        Output::send<LogLevel::Warning>(
+            STR("[InventoryStackSizeBoost] DT_Enemies rows changed since they were patched, discarding stale snapshot\n"));
+        m_journal.Discard(layer);
+        layer = PatchJournal::InvalidLayer;
+        m_stackCore.Clear();
+        return false;
+    }
+
+    // Undoes up to count of the layer's newest edits, adding to result. Returns the number undone.
+    size_t RevertStackEntries(bool setPatchedFlag, size_t count, PatchJournal::RevertResult& result)
+    {
+        PatchJournal::LayerId& layer = setPatchedFlag ? m_stackLayer : m_exchangeLayer;
+
+        // Log a few examples before/after for debugging (only for manual restore)
+        const size_t maxLogExamples = setPatchedFlag ? 5 : 0;
+        const std::vector<FName>& keys = m_stackCore.Keys();
+        
+        PatchJournal::RevertResult step = m_journal.RevertNewest(layer, count, PatchJournal::RevertMode::SkipModified,
+            [&](uint32_t row, uint64_t currentValue, uint64_t originalValue) {
+                if (result.Restored < maxLogExamples)
+                {
+                    m_log.Log(LOG_RESTORING_ROW, AsyncLog::PackName(keys[row]),
+                              static_cast<int32_t>(currentValue), static_cast<int32_t>(originalValue));
+                }
+                result.Restored++;
+            });
+        result.Superseded += step.Superseded;
+        result.Conflicts += step.Conflicts;
+        if (!m_journal.IsActive(layer))
+        {
+            layer = PatchJournal::InvalidLayer;
+        }
+        return step.Restored + step.Superseded + step.Conflicts;
+    }
+
+    void ReportStackRestore(bool setPatchedFlag, const PatchJournal::RevertResult& result)
+    {
+        if (result.Conflicts > 0)
+        {
+            Output::send<LogLevel::Warning>(
+                STR("[InventoryStackSizeBoost] {} item(s) changed by the game since patching were left as they are\n"),
+                result.Conflicts);
         }
         
         if (setPatchedFlag)
         {
-            m_stacksArePatched = false;
-            // Keep m_originalStackValues for potential re-patching
+            // Keep the snapshot for potential re-patching
             Output::send<LogLevel::Default>(
-                STR("[InventoryStackSizeBoost] Restored {} items to default values ({} unchanged, {} not found)\n"), 
-                restoredCount, unchangedCount, notFoundCount);
+                STR("[InventoryStackSizeBoost] Restored {} items to default values ({} handed to a newer patch)\n"), 
+                result.Restored, result.Superseded);
         }
         else
         {
-            Output::send<LogLevel::Verbose>(
-                STR("[InventoryStackSizeBoost] Restored {} items to default\n"), 
-                restoredCount);
+            m_log.Log(LOG_STACKS_RESTORED_QUIET, static_cast<int>(result.Restored));
         }
     }
 };
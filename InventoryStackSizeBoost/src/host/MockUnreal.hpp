@@ -0,0 +1,168 @@
+#pragma once
+
+/**
+ * MockUnreal - minimal stand-ins for the UE types the portable core touches
+ *
+ * FName, TMap<FName, unsigned char*> and UDataTable mirror the UE4SS surface
+ * used by StackPatchCore and friends (Num/Find/range-for over Key/Value pairs),
+ * so the core can be built and exercised on a Linux host without the game.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MockUnreal
+{
+    // Interned name: comparison index into a process-wide pool, like FNamePool
+    class FName
+    {
+    public:
+        FName() = default;
+
+        explicit FName(const std::wstring& name)
+        {
+            auto& pool = Pool();
+            auto [it, inserted] = pool.Lookup.try_emplace(name, static_cast<uint32_t>(pool.Names.size()));
+            if (inserted)
+            {
+                pool.Names.push_back(name);
+            }
+            m_comparisonIndex = it->second;
+        }
+
+        uint32_t GetComparisonIndex() const { return m_comparisonIndex; }
+        uint32_t GetNumber() const { return 0; }
+        std::wstring ToString() const { return Pool().Names[m_comparisonIndex]; }
+
+        bool operator==(const FName& other) const { return m_comparisonIndex == other.m_comparisonIndex; }
+        bool operator!=(const FName& other) const { return m_comparisonIndex != other.m_comparisonIndex; }
+
+    private:
+        struct NamePool
+        {
+            std::vector<std::wstring> Names{L"None"};
+            std::unordered_map<std::wstring, uint32_t> Lookup{{L"None", 0}};
+        };
+
+        static NamePool& Pool()
+        {
+            static NamePool pool;
+            return pool;
+        }
+
+        uint32_t m_comparisonIndex = 0;
+    };
+
+    inline const FName NAME_None{};
+
+    template <typename K, typename V>
+    struct TPair
+    {
+        K Key;
+        V Value;
+    };
+
+    // Insertion-ordered map with hashed lookup, like TMap over a TSet of pairs
+    template <typename K, typename V>
+    class TMap
+    {
+    public:
+        int32_t Num() const { return static_cast<int32_t>(m_pairs.size()); }
+
+        void Add(const K& key, const V& value)
+        {
+            if (V* existing = Find(key))
+            {
+                *existing = value;
+                return;
+            }
+            m_index.emplace(key.GetComparisonIndex(), m_pairs.size());
+            m_pairs.push_back({key, value});
+        }
+
+        V* Find(const K& key)
+        {
+            auto it = m_index.find(key.GetComparisonIndex());
+            return it == m_index.end() ? nullptr : &m_pairs[it->second].Value;
+        }
+
+        const V* Find(const K& key) const
+        {
+            auto it = m_index.find(key.GetComparisonIndex());
+            return it == m_index.end() ? nullptr : &m_pairs[it->second].Value;
+        }
+
+        void Empty()
+        {
+            m_pairs.clear();
+            m_index.clear();
+        }
+
+        auto begin() { return m_pairs.begin(); }
+        auto end() { return m_pairs.end(); }
+        auto begin() const { return m_pairs.begin(); }
+        auto end() const { return m_pairs.end(); }
+
+    private:
+        std::vector<TPair<K, V>> m_pairs;
+        std::unordered_map<uint32_t, size_t> m_index;
+    };
+
+    using RowMap = TMap<FName, unsigned char*>;
+
+    class UDataTable
+    {
+    public:
+        const RowMap& GetRowMap() const { return m_rowMap; }
+        RowMap& MutableRowMap() { return m_rowMap; }
+
+    private:
+        RowMap m_rowMap;
+    };
+
+    // A DataTable whose rows live in one owned allocation, laid out like FBeltTDEnemyConfig
+    class SyntheticTable : public UDataTable
+    {
+    public:
+        static constexpr size_t RowSize = 0xA0;
+        static constexpr size_t MaximumStackOffset = 0x5C;
+        static constexpr size_t SellCanStackOffset = 0x99;
+
+        // maxStackFor(i) supplies each row's MaximumStack
+        SyntheticTable(size_t rowCount, const std::function<int32_t(size_t)>& maxStackFor, const std::wstring& prefix = L"Item_")
+            : m_storage(new unsigned char[rowCount * RowSize]())
+        {
+            for (size_t i = 0; i < rowCount; ++i)
+            {
+                unsigned char* row = m_storage.get() + i * RowSize;
+                int32_t maxStack = maxStackFor(i);
+                std::memcpy(row + MaximumStackOffset, &maxStack, sizeof(maxStack));
+                row[SellCanStackOffset] = maxStack > 1 ? 1 : 0;
+                MutableRowMap().Add(FName(prefix + std::to_wstring(i)), row);
+            }
+        }
+
+        unsigned char* Row(size_t index) const { return m_storage.get() + index * RowSize; }
+
+        int32_t MaxStack(size_t index) const
+        {
+            int32_t value;
+            std::memcpy(&value, Row(index) + MaximumStackOffset, sizeof(value));
+            return value;
+        }
+
+        void SetMaxStack(size_t index, int32_t value)
+        {
+            std::memcpy(Row(index) + MaximumStackOffset, &value, sizeof(value));
+        }
+
+    private:
+        std::unique_ptr<unsigned char[]> m_storage;
+    };
+}
@@ -0,0 +1,615 @@
+/**
+ * Host-side benchmarks for the patch, restore, lookup and hook paths.
+ *
+ * Runs the same StackPatchCore code the DLL uses against synthetic MockUnreal
+ * tables and prints one record per case as JSON (default) or CSV, so results
+ * can be stored per release and compared.
+ *
+ * Usage: InventoryStackSizeBoostHostBench [--format json|csv] [--out FILE]
+ *                                         [--sizes 1000,10000,...] [--reps N]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <functional>
+#include <string>
+#include <vector>
+#include "MockUnreal.hpp"
+#include "../StackPatchCore.hpp"
+#include "../AsyncLog.hpp"
+#include "../PatchEngine.hpp"
+#include "../PatchJournal.hpp"
+#include "../InventorySorter.hpp"
+#include "../VirtualStackLimits.hpp"
+#include "../ParallelScan.hpp"
+
+using namespace MockUnreal;
+using namespace StackBoost;
+
+namespace
+{
+    constexpr int32_t MAX_STACK = 1000;
+
+    template <typename T>
+    inline void DoNotOptimize(const T& value)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "g"(&value) : "memory");
+#else
+        static volatile const void* sink;
+        sink = &value;
+#endif
+    }
+
+    struct Result
+    {
+        std::string Case;
+        size_t Rows = 0;
+        double Density = 0.0;  // Fraction of rows the max-stack rule raises
+        double HitRatio = 0.0; // Fraction of targeted lookups that name a real row
+        int Reps = 0;
+        size_t OpsPerRep = 0;
+        double MedianNsPerOp = 0.0;
+        double MinNsPerOp = 0.0;
+        double RowsTouchedPerOp = 0.0;
+    };
+
+    struct Options
+    {
+        bool Csv = false;
+        std::string OutPath;
+        std::vector<size_t> Sizes{1000, 10000, 100000, 1000000};
+        int Reps = 15;
+    };
+
+    // Deterministic so runs are comparable across machines and releases
+    struct Lcg
+    {
+        uint64_t State;
+        uint32_t Next()
+        {
+            State = State * 6364136223846793005ull + 1442695040888963407ull;
+            return static_cast<uint32_t>(State >> 33);
+        }
+        double NextUnit() { return Next() / 2147483648.0; } // Next() yields 31 bits
+    };
+
+    FieldAccessor<int32_t> MaxStackField()
+    {
+        FieldAccessor<int32_t> field;
+        field.Offset = SyntheticTable::MaximumStackOffset;
+        field.Valid = true;
+        return field;
+    }
+
+    // Rows below the cap with probability `density`, the rest non-stackable or above it
+    std::function<int32_t(size_t)> MaxStackWithDensity(double density)
+    {
+        return [density](size_t i) {
+            Lcg rng{i * 2654435761ull + 1};
+            if (rng.NextUnit() < density)
+            {
+                return static_cast<int32_t>(1 + rng.Next() % (MAX_STACK - 1));
+            }
+            return (rng.Next() & 1) ? 0 : MAX_STACK * 2;
+        };
+    }
+
+    // Runs `op` reps times, `opsPerRep` calls each, and records ns per call.
+    // `setup` runs untimed before each rep (e.g. to restore a table before timing a patch).
+    Result Measure(const std::string& name, size_t rows, double density, double hitRatio, int reps, size_t opsPerRep,
+                   const std::function<size_t()>& op, const std::function<void()>& setup = {})
+    {
+        std::vector<double> samples;
+        samples.reserve(reps);
+        size_t rowsTouched = 0;
+
+        for (int rep = 0; rep < reps; ++rep)
+        {
+            if (setup)
+            {
+                setup();
+            }
+            auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < opsPerRep; ++i)
+            {
+                rowsTouched += op();
+            }
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / opsPerRep);
+        }
+
+        std::sort(samples.begin(), samples.end());
+        Result result;
+        result.Case = name;
+        result.Rows = rows;
+        result.Density = density;
+        result.HitRatio = hitRatio;
+        result.Reps = reps;
+        result.OpsPerRep = opsPerRep;
+        result.MedianNsPerOp = samples[samples.size() / 2];
+        result.MinNsPerOp = samples.front();
+        result.RowsTouchedPerOp = static_cast<double>(rowsTouched) / (static_cast<double>(reps) * opsPerRep);
+        return result;
+    }
+
+    // What the DLL's stack patch does per snapshot entry; returns rows changed
+    size_t JournalPatchStacks(PatchJournal& journal, PatchJournal::LayerId layer, const StackPatchCore<RowMap>& core)
+    {
+        size_t changed = 0;
+        const std::vector<StackSnapshotEntry>& entries = core.Entries();
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            int32_t* field = entries[i].MaxStack;
+            changed += journal.Write(layer, field, ApplyMaxStackRule(*field, MAX_STACK), static_cast<uint32_t>(i));
+        }
+        return changed;
+    }
+
+    // Whole-table operations: cost scales with rows, so one call per rep
+    void BenchFullTable(const Options& options, size_t rows, double density, std::vector<Result>& results)
+    {
+        SyntheticTable table(rows, MaxStackWithDensity(density));
+        StackPatchCore<RowMap> core;
+
+        results.push_back(Measure("snapshot_build", rows, density, 0.0, options.Reps, 1, [&] {
+            core.Build(&table, table.GetRowMap(), MaxStackField());
+            return core.Size();
+        }));
+
+        results.push_back(Measure("snapshot_validate", rows, density, 0.0, options.Reps, 1000, [&] {
+            return static_cast<size_t>(core.IsCurrent(&table, table.GetRowMap()));
+        }));
+
+        // The DLL's path: one sweep recording only changed rows in a journal layer,
+        // so revert cost follows the rows patched rather than the table size
+        PatchJournal journal;
+        PatchJournal::LayerId layer = PatchJournal::InvalidLayer;
+        auto journalPatch = [&] {
+            layer = journal.Begin(L"stacks");
+            return JournalPatchStacks(journal, layer, core);
+        };
+
+        results.push_back(Measure(
+            "journal_patch", rows, density, 0.0, options.Reps, 1,
+            journalPatch,
+            [&] { journal.Revert(layer); }));
+        journal.Revert(layer);
+
+        results.push_back(Measure(
+            "journal_revert", rows, density, 0.0, options.Reps, 1,
+            [&] { return journal.Revert(layer).Restored; },
+            [&] { journalPatch(); }));
+
+        // VirtualStacks: built once per config, then patch/restore is a pointer store
+        std::vector<int32_t> originals;
+        std::vector<int32_t> targets;
+        for (const StackSnapshotEntry& entry : core.Entries())
+        {
+            originals.push_back(entry.OriginalValue);
+            targets.push_back(ApplyMaxStackRule(entry.OriginalValue, MAX_STACK));
+        }
+        VirtualStackLimits limits;
+        results.push_back(Measure("virtual_build", rows, density, 0.0, options.Reps, 1, [&] {
+            limits.Build(core.Keys(), originals, targets);
+            return limits.Latest()->Overrides();
+        }));
+
+        results.push_back(Measure("virtual_patch_restore", rows, density, 0.0, options.Reps, 10000, [&] {
+            limits.Activate();
+            limits.Deactivate();
+            return size_t{0};
+        }));
+    }
+
+    // Exchange-hook paths: a couple of row lookups per call, with a full-table
+    // fallback whenever a key isn't a row (as the pre/post hooks do)
+    void BenchTargeted(const Options& options, size_t rows, double hitRatio, std::vector<Result>& results)
+    {
+        constexpr double density = 0.5;
+        SyntheticTable table(rows, MaxStackWithDensity(density));
+        StackPatchCore<RowMap> core;
+        core.Build(&table, table.GetRowMap(), MaxStackField());
+        RowMap& rowMap = table.MutableRowMap();
+
+        constexpr size_t keyPool = 1024;
+        std::vector<FName> keys;
+        keys.reserve(keyPool * 2);
+        Lcg rng{rows * 31 + 7};
+        for (size_t i = 0; i < keyPool * 2; ++i)
+        {
+            bool hit = rng.NextUnit() < hitRatio;
+            keys.push_back(hit ? FName(L"Item_" + std::to_wstring(rng.Next() % rows)) : FName(L"Missing_" + std::to_wstring(i)));
+        }
+
+        TargetedStackPatch<8> targeted;
+        PatchJournal exchangeJournal;
+        size_t cursor = 0;
+
+        if (hitRatio == 1.0)
+        {
+            results.push_back(Measure("single_row_patch", rows, density, hitRatio, options.Reps, 10000, [&] {
+                const FName& key = keys[cursor++ % keys.size()];
+                PatchJournal::LayerId layer = exchangeJournal.Begin(L"exchange");
+                targeted.Patch(exchangeJournal, layer, rowMap, &key, 1, NAME_None, MaxStackField(), MAX_STACK);
+                return exchangeJournal.Revert(layer).Restored;
+            }));
+        }
+
+        // What the GetItemTotalStack hook does per call with VirtualStacks on
+        std::vector<int32_t> originals;
+        std::vector<int32_t> targets;
+        for (const StackSnapshotEntry& entry : core.Entries())
+        {
+            originals.push_back(entry.OriginalValue);
+            targets.push_back(ApplyMaxStackRule(entry.OriginalValue, MAX_STACK));
+        }
+        VirtualStackLimits limits;
+        limits.Build(core.Keys(), originals, targets);
+        limits.Activate();
+        results.push_back(Measure("virtual_limit_lookup", rows, density, hitRatio, options.Reps, 100000, [&] {
+            const FName& key = keys[cursor++ % keys.size()];
+            const VirtualStackLimits::Limits* active = limits.Active();
+            int32_t limit = active ? active->Find(key.GetComparisonIndex(), key.GetNumber()) : VirtualStackLimits::NoOverride;
+            DoNotOptimize(limit);
+            return size_t{limit != VirtualStackLimits::NoOverride};
+        }));
+
+        // Fallbacks make a miss cost a full table sweep, so scale calls down with size
+        size_t opsPerRep = hitRatio == 1.0 ? 10000 : std::max<size_t>(1, 1000000 / rows);
+        results.push_back(Measure("exchange_hook", rows, density, hitRatio, options.Reps, opsPerRep, [&] {
+            const FName* pair = &keys[(cursor++ * 2) % keys.size()];
+            PatchJournal::LayerId layer = exchangeJournal.Begin(L"exchange");
+            bool identified = targeted.Patch(exchangeJournal, layer, rowMap, pair, 2, NAME_None, MaxStackField(), MAX_STACK);
+            size_t restored = exchangeJournal.Revert(layer).Restored;
+            if (identified)
+            {
+                return restored;
+            }
+            layer = exchangeJournal.Begin(L"exchange");
+            size_t touched = JournalPatchStacks(exchangeJournal, layer, core);
+            exchangeJournal.Revert(layer);
+            return touched;
+        }));
+    }
+
+    // OnInventoryUpdate auto-sort: one pickup per update, sorted from scratch
+    // (what a full rearrange costs) versus merged into the previous order
+    void BenchInventorySort(const Options& options, size_t slotCount, std::vector<Result>& results)
+    {
+        struct Slot
+        {
+            uint64_t Key;
+            unsigned char Payload[24];
+        };
+        std::vector<Slot> slots(slotCount);
+        std::vector<uint64_t> keys(slotCount);
+        IncrementalSlotSorter sorter;
+        std::vector<unsigned char> scratch;
+        std::vector<uint8_t> placed;
+        Lcg rng{slotCount * 13 + 5};
+
+        auto update = [&](bool full) {
+            // Replace one slot's item, as a pickup or a used-up stack would
+            Slot& changed = slots[rng.Next() % slotCount];
+            changed.Key = (rng.Next() & 3) == 0 ? EmptySlotKey : rng.Next() % 400;
+            for (size_t i = 0; i < slotCount; ++i)
+            {
+                keys[i] = slots[i].Key;
+            }
+            if (full)
+            {
+                sorter.Reset();
+            }
+            SlotSortResult result = sorter.Update(keys.data(), slotCount);
+            ApplySlotPermutation(reinterpret_cast<unsigned char*>(slots.data()), sizeof(Slot), sorter.Source(), scratch, placed);
+            return result.Moved;
+        };
+
+        results.push_back(Measure("inventory_sort_full", slotCount, 0.0, 0.0, options.Reps, 10000, [&] { return update(true); }));
+        results.push_back(Measure("inventory_sort_incremental", slotCount, 0.0, 0.0, options.Reps, 10000, [&] { return update(false); }));
+    }
+
+    // table_patches.ini with a few dozen tweaks: apply and revert are one sweep
+    // over the compiled rows regardless of spec count
+    void BenchTablePatch(const Options& options, size_t rows, std::vector<Result>& results)
+    {
+        SyntheticTable table(rows, MaxStackWithDensity(0.5));
+        FieldLayout layout;
+        layout.Add({L"SellPrice", 0x20, 4, FieldType::Int32});
+        layout.Add({L"Weight", 0x24, 4, FieldType::Float});
+        layout.Add({L"MaximumStack", static_cast<uint32_t>(SyntheticTable::MaximumStackOffset), 4, FieldType::Int32});
+        layout.Add({L"SellCanStack", 0x99, 1, FieldType::Bool});
+
+        std::wstring text = L"[DT_Enemies]\n*.MaximumStack = clamp(1, 9999)\n";
+        for (int i = 0; i < 40; ++i)
+        {
+            text += L"Item_" + std::to_wstring(i) + L"*.SellPrice *= 1.5\n";
+            text += L"Item_" + std::to_wstring(i) + L"?.Weight += 0.25\n";
+        }
+        std::vector<PatchGroup> groups = ParsePatchSpecs(text);
+
+        TablePatch patch;
+        auto rowName = [](const FName& key) { return key.ToString(); };
+
+        results.push_back(Measure("table_patch_compile", rows, 0.5, 0.0, options.Reps, 1, [&] {
+            return patch.Compile(&table, table.GetRowMap(), layout, groups[0].Specs, rowName).Fields;
+        }));
+
+        PatchJournal journal;
+        PatchJournal::LayerId layer = PatchJournal::InvalidLayer;
+        auto apply = [&] {
+            layer = journal.Begin(L"DT_Enemies");
+            return patch.Apply(journal, layer);
+        };
+
+        results.push_back(Measure(
+            "table_patch_apply", rows, 0.5, 0.0, options.Reps, 1,
+            apply,
+            [&] { journal.Revert(layer); }));
+        journal.Revert(layer);
+
+        results.push_back(Measure(
+            "table_patch_revert", rows, 0.5, 0.0, options.Reps, 1,
+            [&] { return journal.Revert(layer).Restored; },
+            [&] { apply(); }));
+    }
+
+    // The GetItemTotalStack post-hook as it stands: indirect call, read the
+    // return value, build the object's full name and format a log line
+    struct FakeHookContext
+    {
+        size_t ObjectIndex;
+        void* Result;
+    };
+    using FakeHook = void (*)(FakeHookContext&, void*);
+
+    void BenchHookDispatch(const Options& options, std::vector<Result>& results)
+    {
+        static wchar_t line[512];
+        FakeHook postHook = [](FakeHookContext& context, void*) {
+            int32_t returnValue = *static_cast<int32_t*>(context.Result);
+            std::wstring fullName = L"BeltTDInventoryInstance /Game/Maps/Factory.Factory:PersistentLevel.BeltTDInventoryInstance_" +
+                                    std::to_wstring(context.ObjectIndex);
+            std::swprintf(line, 512, L"[InventoryStackSizeBoost] GetItemTotalStack called on %ls -> ReturnValue: %d\n",
+                          fullName.c_str(), returnValue);
+            DoNotOptimize(line);
+        };
+        DoNotOptimize(postHook);
+
+        int32_t returnValue = 42;
+        FakeHookContext context{0, &returnValue};
+        results.push_back(Measure("item_total_stack_hook", 0, 0.0, 1.0, options.Reps, 100000, [&] {
+            context.ObjectIndex++;
+            postHook(context, nullptr);
+            return size_t{0};
+        }));
+
+        // Same hook recording a binary AsyncLog event instead; formatting happens on the log thread
+        static AsyncLog log;
+        static const AsyncLogEventSpec events[] = {
+            {L"[InventoryStackSizeBoost] GetItemTotalStack called on {} -> ReturnValue: {}\n", "xd", AsyncLogLevel::Default, 1, 0},
+            {L"[InventoryStackSizeBoost] GetItemTotalStack called on {} -> ReturnValue: {}\n", "xd", AsyncLogLevel::Default, 1, 10},
+        };
+        log.Start(events, 2, [](AsyncLogLevel, const std::wstring& formatted) { DoNotOptimize(formatted); });
+
+        FakeHook asyncHook = [](FakeHookContext& context, void*) {
+            log.Log(0, reinterpret_cast<void*>(context.ObjectIndex), *static_cast<int32_t*>(context.Result));
+        };
+        FakeHook rateLimitedHook = [](FakeHookContext& context, void*) {
+            log.Log(1, reinterpret_cast<void*>(context.ObjectIndex), *static_cast<int32_t*>(context.Result));
+        };
+        DoNotOptimize(asyncHook);
+        DoNotOptimize(rateLimitedHook);
+
+        // Below the ring capacity per rep so records are queued, not dropped
+        results.push_back(Measure(
+            "item_total_stack_hook_async", 0, 0.0, 1.0, options.Reps, AsyncLog::RingCapacity / 2,
+            [&] {
+                context.ObjectIndex++;
+                asyncHook(context, nullptr);
+                return size_t{0};
+            },
+            [&] { log.Flush(); }));
+
+        results.push_back(Measure("item_total_stack_hook_rate_limited", 0, 0.0, 1.0, options.Reps, 100000, [&] {
+            context.ObjectIndex++;
+            rateLimitedHook(context, nullptr);
+            return size_t{0};
+        }));
+        log.Stop();
+    }
+
+    // Startup discovery on a cache miss: a synthetic object array (item -> object
+    // pointers into shuffled storage, as FUObjectItem -> UObject), three (class,
+    // name) targets, scanned serially and on
+    // ParallelScan. Density is where the last target sits (1.0 = not present, a
+    // full scan); HitRatio carries the worker count.
+    void BenchObjectScan(const Options& options, size_t objects, std::vector<Result>& results)
+    {
+        struct FakeObject
+        {
+            const void* Class;
+            uint32_t Name;
+        };
+        static const int classes[16] = {};
+        std::vector<FakeObject> storage(objects);
+        std::vector<FakeObject*> array(objects);
+        Lcg rng{objects};
+        for (size_t i = 0; i < objects; ++i)
+        {
+            storage[i] = {&classes[rng.Next() % 16], rng.Next() % 50000};
+            array[i] = &storage[i];
+        }
+        for (size_t i = objects - 1; i > 0; --i)
+        {
+            std::swap(array[i], array[rng.Next() % (i + 1)]);
+        }
+        struct Target
+        {
+            const void* Class;
+            uint32_t Name;
+        };
+        const Target targets[3] = {{&classes[16 - 1] + 1, 1}, {&classes[16 - 1] + 1, 2}, {&classes[16 - 1] + 1, 3}};
+
+        for (double lastAt : {0.25, 1.0})
+        {
+            for (size_t t = 0; t < 3; ++t)
+            {
+                size_t at = static_cast<size_t>(lastAt * (t + 1) / 3 * (objects - 1));
+                if (lastAt < 1.0 || t < 2) *array[at] = {targets[t].Class, targets[t].Name};
+            }
+
+            auto matchChunk = [&](FirstMatchSet<3>& matches, size_t begin, size_t end) {
+                bool allFound = false;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    const FakeObject& object = *array[i];
+                    if (object.Class != targets[0].Class) continue;
+                    for (size_t t = 0; t < 3; ++t)
+                    {
+                        if (object.Name == targets[t].Name) allFound = matches.Record(t, i);
+                    }
+                }
+                return allFound;
+            };
+
+            results.push_back(Measure("object_scan_serial", objects, lastAt, 1.0, options.Reps, 1, [&] {
+                FirstMatchSet<3> matches(3);
+                for (size_t i = 0; i < array.size() && !matchChunk(matches, i, i + 1); ++i) {}
+                return static_cast<size_t>(matches.AllFound());
+            }));
+
+            for (size_t workers : {size_t{1}, size_t{2}, size_t{4}, size_t{8}})
+            {
+                ParallelScan scan(workers);
+                results.push_back(Measure("object_scan_parallel", objects, lastAt, static_cast<double>(workers), options.Reps, 1, [&] {
+                    FirstMatchSet<3> matches(3);
+                    scan.Run(array.size(), [&](size_t begin, size_t end) { return matchChunk(matches, begin, end); });
+                    return static_cast<size_t>(matches.AllFound());
+                }));
+            }
+
+            // Leave the array as it was for the next placement
+            for (FakeObject& object : storage)
+            {
+                if (object.Class == targets[0].Class) object.Class = &classes[0];
+            }
+        }
+    }
+
+    void WriteResults(const Options& options, const std::vector<Result>& results)
+    {
+        FILE* out = stdout;
+        if (!options.OutPath.empty())
+        {
+            out = std::fopen(options.OutPath.c_str(), "w");
+            if (!out)
+            {
+                std::fprintf(stderr, "Cannot open %s for writing\n", options.OutPath.c_str());
+                std::exit(1);
+            }
+        }
+
+        if (options.Csv)
+        {
+            std::fprintf(out, "case,rows,density,hit_ratio,reps,ops_per_rep,median_ns_per_op,min_ns_per_op,rows_touched_per_op\n");
+            for (const Result& r : results)
+            {
+                std::fprintf(out, "%s,%zu,%.2f,%.2f,%d,%zu,%.1f,%.1f,%.2f\n", r.Case.c_str(), r.Rows, r.Density, r.HitRatio, r.Reps,
+                             r.OpsPerRep, r.MedianNsPerOp, r.MinNsPerOp, r.RowsTouchedPerOp);
+            }
+        }
+        else
+        {
+            std::fprintf(out, "{\n  \"benchmark\": \"InventoryStackSizeBoost\",\n  \"results\": [\n");
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                const Result& r = results[i];
+                std::fprintf(out,
+                             "    {\"case\": \"%s\", \"rows\": %zu, \"density\": %.2f, \"hit_ratio\": %.2f, \"reps\": %d, "
+                             "\"ops_per_rep\": %zu, \"median_ns_per_op\": %.1f, \"min_ns_per_op\": %.1f, \"rows_touched_per_op\": %.2f}%s\n",
+                             r.Case.c_str(), r.Rows, r.Density, r.HitRatio, r.Reps, r.OpsPerRep, r.MedianNsPerOp, r.MinNsPerOp,
+                             r.RowsTouchedPerOp, i + 1 < results.size() ? "," : "");
+            }
+            std::fprintf(out, "  ]\n}\n");
+        }
+
+        if (out != stdout)
+        {
+            std::fclose(out);
+        }
+    }
+
+    Options ParseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--format" && hasValue)
+            {
+                options.Csv = std::strcmp(argv[++i], "csv") == 0;
+            }
+            else if (arg == "--out" && hasValue)
+            {
+                options.OutPath = argv[++i];
+            }
+            else if (arg == "--reps" && hasValue)
+            {
+                options.Reps = std::max(1, std::atoi(argv[++i]));
+            }
+            else if (arg == "--sizes" && hasValue)
+            {
+                options.Sizes.clear();
+                for (char* token = std::strtok(argv[++i], ","); token; token = std::strtok(nullptr, ","))
+                {
+                    if (size_t size = std::strtoull(token, nullptr, 10))
+                    {
+                        options.Sizes.push_back(size);
+                    }
+                }
+            }
+            else
+            {
+                std::fprintf(stderr, "Usage: %s [--format json|csv] [--out FILE] [--sizes N,N,...] [--reps N]\n", argv[0]);
+                std::exit(2);
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options = ParseOptions(argc, argv);
+    std::vector<Result> results;
+
+    for (size_t rows : options.Sizes)
+    {
+        for (double density : {0.1, 0.5, 1.0})
+        {
+            BenchFullTable(options, rows, density, results);
+        }
+        for (double hitRatio : {1.0, 0.9})
+        {
+            BenchTargeted(options, rows, hitRatio, results);
+        }
+        BenchTablePatch(options, rows, results);
+    }
+    BenchHookDispatch(options, results);
+    BenchObjectScan(options, std::max<size_t>(1000000, options.Sizes.back()), results);
+    for (size_t slotCount : {48, 240})
+    {
+        BenchInventorySort(options, slotCount, results);
+    }
+
+    WriteResults(options, results);
+    return 0;
+}
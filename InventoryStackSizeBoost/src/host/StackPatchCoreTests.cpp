@@ -0,0 +1,1529 @@
+/**
+ * Host-side tests for the portable patch core, run against MockUnreal tables.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "MockUnreal.hpp"
+#include "../StackPatchCore.hpp"
+#include "../HookStats.hpp"
+#include "../StackConfig.hpp"
+#include "../RetryScheduler.hpp"
+#include "../PatchEngine.hpp"
+#include "../PatchJournal.hpp"
+#include "../PatchState.hpp"
+#include "../VirtualStackLimits.hpp"
+#include "../ParallelScan.hpp"
+#include "../DiscoveryCache.hpp"
+#include "../InventorySorter.hpp"
+#include "../StackCompactor.hpp"
+#include "../FrameScheduler.hpp"
+#include "../TableExport.hpp"
+#include "../LuaBridge.hpp"
+#include "../IncrementalSweep.hpp"
+
+using namespace MockUnreal;
+using namespace StackBoost;
+
+static int g_failures = 0;
+
+#define CHECK(expr)                                                              \
+    do                                                                           \
+    {                                                                            \
+        if (!(expr))                                                             \
+        {                                                                        \
+            std::fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #expr); \
+            ++g_failures;                                                        \
+        }                                                                        \
+    } while (0)
+
+static FieldAccessor<int32_t> MaxStackField()
+{
+    FieldAccessor<int32_t> field;
+    field.Offset = SyntheticTable::MaximumStackOffset;
+    field.Valid = true;
+    return field;
+}
+
+// Row i: 0 (non-stackable), 1..999 (stackable), 5000 (already above the cap)
+static int32_t MixedMaxStack(size_t i)
+{
+    switch (i % 4)
+    {
+    case 0: return 0;
+    case 1: return 20;
+    case 2: return 999;
+    default: return 5000;
+    }
+}
+
+// What the mod's stack patch does: one journal write per snapshot entry
+static int PatchStacks(PatchJournal& journal, PatchJournal::LayerId layer, const StackPatchCore<RowMap>& core, int32_t maxStack)
+{
+    int modified = 0;
+    for (size_t i = 0; i < core.Size(); ++i)
+    {
+        int32_t* field = core.Entries()[i].MaxStack;
+        modified += journal.Write(layer, field, ApplyMaxStackRule(*field, maxStack), static_cast<uint32_t>(i));
+    }
+    return modified;
+}
+
+static void TestApplyMaxStackRule()
+{
+    CHECK(ApplyMaxStackRule(0, 1000) == 0);
+    CHECK(ApplyMaxStackRule(-1, 1000) == -1);
+    CHECK(ApplyMaxStackRule(1, 1000) == 1000);
+    CHECK(ApplyMaxStackRule(999, 1000) == 1000);
+    CHECK(ApplyMaxStackRule(1000, 1000) == 1000);
+    CHECK(ApplyMaxStackRule(5000, 1000) == 5000);
+}
+
+static void TestPatchRaisesOnlyStackableRows()
+{
+    SyntheticTable table(400, MixedMaxStack);
+    StackPatchCore<RowMap> core;
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+
+    CHECK(core.Size() == 400);
+    PatchJournal journal;
+    PatchJournal::LayerId layer = journal.Begin(L"stacks");
+    CHECK(PatchStacks(journal, layer, core, 1000) == 200);
+    CHECK(journal.Changes(layer) == 200);
+
+    for (size_t i = 0; i < 400; ++i)
+    {
+        int32_t expected = (i % 4 == 0) ? 0 : (i % 4 == 3) ? 5000 : 1000;
+        CHECK(table.MaxStack(i) == expected);
+    }
+}
+
+static void TestRestoreWritesOriginals()
+{
+    SyntheticTable table(400, MixedMaxStack);
+    StackPatchCore<RowMap> core;
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+    PatchJournal journal;
+    PatchJournal::LayerId layer = journal.Begin(L"stacks");
+    PatchStacks(journal, layer, core, 1000);
+
+    int callbacks = 0;
+    PatchJournal::RevertResult result = journal.Revert(layer, PatchJournal::RevertMode::SkipModified,
+                                                       [&](uint32_t tag, uint64_t from, uint64_t to) {
+        CHECK(tag < 400 && tag % 4 != 0 && tag % 4 != 3); // Only the raised rows
+        CHECK(from == 1000);
+        CHECK(to == 20 || to == 999);
+        ++callbacks;
+    });
+
+    CHECK(result.Restored == 200);
+    CHECK(result.Conflicts == 0);
+    CHECK(callbacks == 200);
+    for (size_t i = 0; i < 400; ++i)
+    {
+        CHECK(table.MaxStack(i) == MixedMaxStack(i));
+    }
+
+    // Restoring again is a no-op
+    CHECK(!journal.IsActive(layer));
+    CHECK(journal.Revert(layer).Restored == 0);
+}
+
+static void TestRepatchUsesStoredOriginals()
+{
+    SyntheticTable table(64, MixedMaxStack);
+    StackPatchCore<RowMap> core;
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+
+    PatchJournal journal;
+    for (int cycle = 0; cycle < 3; ++cycle)
+    {
+        CHECK(core.IsCurrent(&table, table.GetRowMap()));
+        PatchJournal::LayerId layer = journal.Begin(L"stacks");
+        CHECK(PatchStacks(journal, layer, core, 1000) == 32);
+        journal.Revert(layer);
+    }
+    for (size_t i = 0; i < 64; ++i)
+    {
+        CHECK(table.MaxStack(i) == MixedMaxStack(i));
+    }
+}
+
+static void TestSnapshotInvalidatedWhenRowsChange()
+{
+    SyntheticTable table(16, MixedMaxStack);
+    StackPatchCore<RowMap> core;
+    CHECK(!core.IsCurrent(&table, table.GetRowMap()));
+
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+    CHECK(core.IsCurrent(&table, table.GetRowMap()));
+
+    // Different table
+    SyntheticTable other(16, MixedMaxStack);
+    CHECK(!core.IsCurrent(&other, other.GetRowMap()));
+
+    // Row added
+    unsigned char extraRow[SyntheticTable::RowSize] = {};
+    table.MutableRowMap().Add(FName(L"Extra"), extraRow);
+    CHECK(!core.IsCurrent(&table, table.GetRowMap()));
+
+    // Rows reallocated with the same count
+    SyntheticTable reloaded(17, MixedMaxStack);
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+    table.MutableRowMap().Empty();
+    for (const auto& pair : reloaded.GetRowMap())
+    {
+        table.MutableRowMap().Add(pair.Key, pair.Value);
+    }
+    CHECK(!core.IsCurrent(&table, table.GetRowMap()));
+}
+
+static void TestFieldLayoutAccessors()
+{
+    FieldLayout layout;
+    layout.Add({L"MaximumStack", 0x60, 4, FieldType::Int32});
+    layout.Add({L"SellCanStack", 0x99, 1, FieldType::Bool});
+
+    CHECK(layout.Check({L"MaximumStack", 0x5C, 4, FieldType::Int32}) == FieldCheck::Moved);
+    CHECK(layout.Check({L"SellCanStack", 0x99, 1, FieldType::Bool}) == FieldCheck::Match);
+    CHECK(layout.Check({L"SellCanStack", 0x99, 4, FieldType::Int32}) == FieldCheck::TypeMismatch);
+    CHECK(layout.Check({L"Missing", 0, 4, FieldType::Int32}) == FieldCheck::Missing);
+
+    FieldAccessor<int32_t> maxStack = layout.Accessor<int32_t>(L"MaximumStack");
+    CHECK(maxStack.IsValid());
+    CHECK(maxStack.Offset == 0x60);
+    CHECK(!layout.Accessor<float>(L"MaximumStack").IsValid());
+    CHECK(!layout.Accessor<int64_t>(L"MaximumStack").IsValid());
+    CHECK(layout.Accessor<bool>(L"SellCanStack").IsValid());
+}
+
+namespace TestRow
+{
+    constexpr RowField<int32_t, 0x5C> MaximumStack{L"MaximumStack"};
+    constexpr RowField<bool, 0x99> SellCanStack{L"SellCanStack"};
+    constexpr RowField<float, 0x60> Price{L"Price"};
+}
+
+constexpr auto TEST_ROW_FIELDS = RowExpectations(TestRow::MaximumStack, TestRow::SellCanStack, TestRow::Price);
+static_assert(RowFieldsDisjoint(TEST_ROW_FIELDS));
+static_assert(TEST_ROW_FIELDS[0].Offset == 0x5C && TEST_ROW_FIELDS[0].Size == 4 && TEST_ROW_FIELDS[0].Type == FieldType::Int32);
+static_assert(TEST_ROW_FIELDS[1].Type == FieldType::Bool && TEST_ROW_FIELDS[2].Type == FieldType::Float);
+static_assert(!RowFieldsDisjoint(RowExpectations(TestRow::MaximumStack, RowField<int16_t, 0x5E>{L"Overlap"})));
+static_assert(FieldTypeOf<uint16_t>() == FieldType::UInt16 && FieldTypeOf<int64_t>() == FieldType::Int64);
+static_assert(TestRow::MaximumStack.Declared().Offset == 0x5C && TestRow::MaximumStack.Declared().IsValid());
+
+static void TestRowFieldDeclarations()
+{
+    FieldLayout layout;
+    layout.Add({L"MaximumStack", 0x60, 4, FieldType::Int32});
+    layout.Add({L"SellCanStack", 0x99, 1, FieldType::Bool});
+    layout.Add({L"Price", 0x64, 8, FieldType::Double});
+
+    CHECK(layout.Check(TEST_ROW_FIELDS[0]) == FieldCheck::Moved);
+    CHECK(layout.Check(TEST_ROW_FIELDS[1]) == FieldCheck::Match);
+    CHECK(layout.Check(TEST_ROW_FIELDS[2]) == FieldCheck::TypeMismatch);
+
+    // A moved field resolves to its reflected offset, a retyped one not at all
+    FieldAccessor<int32_t> maxStack = layout.Accessor(TestRow::MaximumStack);
+    CHECK(maxStack.IsValid());
+    CHECK(maxStack.Offset == 0x60);
+    CHECK(layout.Accessor(TestRow::SellCanStack).Offset == 0x99);
+    CHECK(!layout.Accessor(TestRow::Price).IsValid());
+
+    // Same row bytes through the declared and the resolved accessor of a matching layout
+    FieldLayout matching;
+    matching.Add({L"MaximumStack", 0x5C, 4, FieldType::Int32});
+    alignas(8) unsigned char row[0x100] = {};
+    matching.Accessor(TestRow::MaximumStack).Set(row, 750);
+    CHECK(TestRow::MaximumStack.Declared().Get(row) == 750);
+    CHECK(*TestRow::MaximumStack.Declared().Ptr(row) == 750);
+}
+
+static void TestPatchStateTransitions()
+{
+    using Op = PatchStateMachine::Op;
+    using Result = PatchStateMachine::Result;
+    PatchStateMachine state;
+
+    CHECK(!state.IsPatched());
+    CHECK(state.TryBegin(Op::Restore) == Result::NotPatched);
+    CHECK(state.TryBegin(Op::Exchange) == Result::Began);
+    CHECK(state.TryBegin(Op::Patch) == Result::Busy);
+    CHECK(state.TryBegin(Op::Maintenance) == Result::Busy);
+    state.End();
+    CHECK(!state.IsPatched());
+    CHECK(state.Epoch() == 1);
+
+    CHECK(state.TryBegin(Op::Patch) == Result::Began);
+    CHECK(state.Load().Owner == Op::Patch);
+    state.End(true);
+    CHECK(state.IsPatched());
+    CHECK(state.TryBegin(Op::Exchange) == Result::AlreadyPatched);
+    CHECK(state.TryBegin(Op::Patch) == Result::AlreadyPatched);
+
+    // A reload keeps the manual patch on
+    CHECK(state.TryBegin(Op::Maintenance) == Result::Began);
+    state.End();
+    CHECK(state.IsPatched());
+
+    CHECK(state.TryBegin(Op::Restore) == Result::Began);
+    state.End(false);
+    CHECK(!state.IsPatched());
+    CHECK(state.Load().Owner == Op::None);
+    CHECK(state.Epoch() == 4);
+}
+
+// Patch, restore, maintenance and exchange threads racing for one table, each
+// writing through the journal the way the DLL's actions do. Every operation
+// that wins the state must run alone, the snapshot must be built once, the
+// journal must always match the table, and a final restore must leave every
+// row at its original value.
+static void TestPatchStateStress()
+{
+    using Op = PatchStateMachine::Op;
+    using Result = PatchStateMachine::Result;
+    constexpr size_t ROWS = 256;
+    constexpr int ITERATIONS = 4000;
+    constexpr size_t RESTORE_BATCH = 16;
+
+    SyntheticTable table(ROWS, MixedMaxStack);
+    StackPatchCore<RowMap> core;
+    PatchJournal journal; // Only the owner of the state touches it
+    PatchJournal::LayerId stacks = PatchJournal::InvalidLayer;
+    PatchStateMachine state;
+    std::atomic<int> owners{0};
+    std::atomic<int> overlaps{0};
+    std::atomic<int> builds{0};
+    std::atomic<int> dirtyExchanges{0};
+    std::atomic<int> modified{0};
+    std::atomic<uint32_t> ended{0};
+    std::atomic<int> counts[5] = {};
+
+    // FNames are interned on construction, so the threads only copy them
+    std::vector<FName> names;
+    for (size_t i = 0; i < ROWS; ++i) names.emplace_back(L"Item_" + std::to_wstring(i));
+    FName none;
+
+    // Restores in batches, as the restore sweep does, releasing the layer with its last entry
+    auto revertStacks = [&] {
+        while (journal.IsActive(stacks))
+        {
+            journal.RevertNewest(stacks, RESTORE_BATCH, PatchJournal::RevertMode::SkipModified, [](uint32_t, uint64_t, uint64_t) {});
+        }
+        stacks = PatchJournal::InvalidLayer;
+    };
+
+    auto run = [&](Op op, uint32_t seed) {
+        TargetedStackPatch<4> exchange;
+        for (int n = 0; n < ITERATIONS; ++n)
+        {
+            if (op == Op::Exchange && state.IsPatched())
+            {
+                continue; // The hooks' fast path
+            }
+            if (state.TryBegin(op) != Result::Began)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            overlaps += owners.fetch_add(1) != 0;
+            switch (op)
+            {
+            case Op::Patch:
+                if (!core.IsCurrent(&table, table.GetRowMap()))
+                {
+                    core.Build(&table, table.GetRowMap(), MaxStackField());
+                    builds++;
+                }
+                stacks = journal.Begin(L"stacks");
+                PatchStacks(journal, stacks, core, 1000);
+                break;
+            case Op::Restore:
+                revertStacks();
+                break;
+            case Op::Exchange:
+            {
+                size_t rows[2] = {(seed + n) % ROWS, (seed * 7 + n) % ROWS};
+                FName keys[2] = {names[rows[0]], names[rows[1]]};
+                for (size_t row : rows)
+                {
+                    dirtyExchanges += table.MaxStack(row) != MixedMaxStack(row);
+                }
+                PatchJournal::LayerId layer = journal.Begin(L"exchange");
+                if (!exchange.Patch(journal, layer, table.MutableRowMap(), keys, 2, none, MaxStackField(), 1000))
+                {
+                    dirtyExchanges++;
+                }
+                journal.Revert(layer);
+                break;
+            }
+            default:
+                modified += static_cast<int>(journal.Verify(stacks));
+                break;
+            }
+            counts[static_cast<size_t>(op)]++;
+            owners.fetch_sub(1);
+            ended++;
+            state.End(journal.IsActive(stacks)); // What EndPatchState does
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < 4; ++i) threads.emplace_back(run, Op::Exchange, i * 31);
+    for (uint32_t i = 0; i < 2; ++i) threads.emplace_back(run, Op::Patch, 0);
+    for (uint32_t i = 0; i < 2; ++i) threads.emplace_back(run, Op::Restore, 0);
+    threads.emplace_back(run, Op::Maintenance, 0);
+    for (std::thread& thread : threads) thread.join();
+
+    if (state.TryBegin(Op::Restore) == Result::Began)
+    {
+        revertStacks();
+        ended++;
+        state.End(journal.IsActive(stacks));
+    }
+
+    CHECK(overlaps == 0);
+    CHECK(builds == 1);
+    CHECK(dirtyExchanges == 0);
+    CHECK(modified == 0);
+    CHECK(counts[static_cast<size_t>(Op::Maintenance)] > 0);
+    CHECK(counts[static_cast<size_t>(Op::Patch)] > 0);
+    CHECK(counts[static_cast<size_t>(Op::Restore)] > 0);
+    CHECK(counts[static_cast<size_t>(Op::Exchange)] > 0);
+    CHECK(state.Epoch() == ended);
+    CHECK(state.Load().Owner == Op::None);
+    CHECK(!state.IsPatched() && !journal.IsActive(stacks));
+    for (size_t i = 0; i < ROWS; ++i)
+    {
+        CHECK(table.MaxStack(i) == MixedMaxStack(i));
+    }
+}
+
+// Names that differ only in their number share a comparison index
+struct NumberedName
+{
+    uint32_t Index;
+    uint32_t Number;
+    uint32_t GetComparisonIndex() const { return Index; }
+    uint32_t GetNumber() const { return Number; }
+};
+
+static void TestTargetedPatchThroughJournal()
+{
+    SyntheticTable table(8, MixedMaxStack);
+    PatchJournal journal;
+    TargetedStackPatch<4> exchange;
+    FName none;
+
+    // Row 1 is stackable, row 3 already above the cap, row 1 again is written once
+    FName keys[4] = {FName(L"Item_1"), none, FName(L"Item_3"), FName(L"Item_1")};
+    PatchJournal::LayerId layer = journal.Begin(L"exchange");
+    CHECK(exchange.Patch(journal, layer, table.MutableRowMap(), keys, 4, none, MaxStackField(), 1000));
+    CHECK(exchange.Count() == 1);
+    CHECK(journal.Changes(layer) == 1);
+    CHECK(table.MaxStack(1) == 1000);
+    CHECK(table.MaxStack(3) == 5000);
+
+    // A restore sees the exchange's writes and puts them back
+    CHECK(journal.Revert(layer).Restored == 1);
+    CHECK(!journal.IsActive(layer));
+    CHECK(table.MaxStack(1) == 20);
+
+    // An unknown key leaves the earlier writes in the layer for the caller to revert
+    FName unknown[2] = {FName(L"Item_5"), FName(L"Missing")};
+    layer = journal.Begin(L"exchange");
+    CHECK(!exchange.Patch(journal, layer, table.MutableRowMap(), unknown, 2, none, MaxStackField(), 1000));
+    CHECK(journal.Changes(layer) == 1);
+    journal.Revert(layer);
+    CHECK(table.MaxStack(5) == 20);
+}
+
+static void TestVirtualStackLimits()
+{
+    SyntheticTable table(400, MixedMaxStack);
+    StackPatchCore<RowMap> core;
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+    std::vector<int32_t> originals;
+    std::vector<int32_t> targets;
+    for (const StackSnapshotEntry& entry : core.Entries())
+    {
+        originals.push_back(entry.OriginalValue);
+        targets.push_back(ApplyMaxStackRule(entry.OriginalValue, 1000));
+    }
+
+    VirtualStackLimits limits;
+    CHECK(!limits.Activate());
+    CHECK(limits.Build(core.Keys(), originals, targets));
+    CHECK(limits.Active() == nullptr);
+    CHECK(limits.Latest()->Overrides() == 200);
+    CHECK(limits.Activate());
+
+    const VirtualStackLimits::Limits* active = limits.Active();
+    for (size_t i = 0; i < 400; ++i)
+    {
+        const FName& key = core.Keys()[i];
+        int32_t expected = (i % 4 == 1 || i % 4 == 2) ? 1000 : VirtualStackLimits::NoOverride;
+        CHECK(active->Find(key.GetComparisonIndex(), key.GetNumber()) == expected);
+        CHECK(table.MaxStack(i) == MixedMaxStack(i)); // Never written
+    }
+    CHECK(active->Find(FName(L"NotARow").GetComparisonIndex(), 0) == VirtualStackLimits::NoOverride);
+
+    // A rebuild while on is published at once; the previous array stays readable
+    for (int32_t& target : targets) target = target == 1000 ? 600 : target;
+    CHECK(limits.Build(core.Keys(), originals, targets));
+    const FName& raised = core.Keys()[1];
+    CHECK(limits.Active()->Find(raised.GetComparisonIndex(), 0) == 600);
+    CHECK(active->Find(raised.GetComparisonIndex(), 0) == 1000);
+    limits.Deactivate();
+    CHECK(!limits.IsActive());
+
+    std::vector<NumberedName> numbered = {{7, 1}, {7, 2}, {9, 0}, {8, 0}};
+    VirtualStackLimits shared;
+    CHECK(shared.Build(numbered, {10, 10, 10, 10}, {50, 60, 70, 10}));
+    shared.Activate();
+    CHECK(shared.Active()->Find(7, 1) == 50);
+    CHECK(shared.Active()->Find(7, 2) == 60);
+    CHECK(shared.Active()->Find(7, 3) == VirtualStackLimits::NoOverride);
+    CHECK(shared.Active()->Find(9, 0) == 70);
+    CHECK(shared.Active()->Find(8, 0) == VirtualStackLimits::NoOverride);
+    CHECK(shared.Active()->Span() == 3);
+
+    std::vector<NumberedName> sparse = {{1, 0}, {uint32_t(VirtualStackLimits::MaxDenseSpan + 1), 0}};
+    CHECK(!shared.Build(sparse, {10, 10}, {20, 20}));
+    CHECK(shared.Active()->Find(9, 0) == 70);
+}
+
+static void TestParallelScanFirstMatches()
+{
+    // Object i has "class" i % 7 and "name" i; targets are (class, name % 1000) pairs
+    constexpr size_t OBJECTS = 100000;
+    struct Target { size_t Class; size_t Name; };
+    const Target targets[] = {{3, 17}, {5, 404}, {0, 999}};
+    auto firstMatch = [&](const Target& target) {
+        for (size_t i = 0; i < OBJECTS; ++i)
+        {
+            if (i % 7 == target.Class && i % 1000 == target.Name) return i;
+        }
+        return FirstMatchSet<4>::NotFound;
+    };
+
+    for (size_t workers : {1, 2, 4, 8})
+    {
+        ParallelScan scan(workers, 1000);
+        FirstMatchSet<4> matches(3);
+        size_t chunks = scan.Run(OBJECTS, [&](size_t begin, size_t end) {
+            bool allFound = false;
+            for (size_t i = begin; i < end; ++i)
+            {
+                for (size_t t = 0; t < 3; ++t)
+                {
+                    if (i % 7 == targets[t].Class && i % 1000 == targets[t].Name) allFound = matches.Record(t, i);
+                }
+            }
+            return allFound;
+        });
+        CHECK(matches.AllFound());
+        for (size_t t = 0; t < 3; ++t)
+        {
+            CHECK(matches.Get(t) == firstMatch(targets[t]));
+        }
+        // Every target matches within the first 7000 objects, so most chunks are never claimed
+        CHECK(chunks <= 8 + workers);
+    }
+
+    // Nothing to find: every chunk is scanned once
+    ParallelScan scan(4, 1000);
+    std::atomic<size_t> visited{0};
+    CHECK(scan.Run(OBJECTS, [&](size_t begin, size_t end) { visited += end - begin; return false; }) == 100);
+    CHECK(visited == OBJECTS);
+    CHECK(scan.Run(0, [&](size_t, size_t) { return true; }) == 0);
+
+    FirstMatchSet<4> partial(2);
+    partial.Exclude(0);
+    CHECK(!partial.AllFound());
+    CHECK(partial.Record(1, 50));
+    partial.Record(1, 20);
+    CHECK(partial.Get(1) == 20);
+    CHECK(!partial.Found(3));
+}
+
+static void TestHookStatsPercentiles()
+{
+    // Every value lands in a bucket whose bounds contain it
+    for (uint64_t ns : {0ull, 3ull, 4ull, 7ull, 100ull, 1000ull, 123456789ull})
+    {
+        size_t bucket = LatencyHistogram::BucketFor(ns);
+        CHECK(LatencyHistogram::BucketUpperBound(bucket) >= ns);
+        CHECK(bucket == 0 || LatencyHistogram::BucketUpperBound(bucket - 1) < ns);
+    }
+
+    HookStats stats(L"Test");
+    for (uint64_t i = 1; i <= 1000; ++i)
+    {
+        stats.Record(i * 1000, 2);
+    }
+    CHECK(stats.Calls() == 1000);
+    CHECK(stats.MaxNs() == 1000000);
+    CHECK(stats.RowsTouched() == 2000);
+
+    // Bucket bounds are at most 25% above the true percentile
+    uint64_t p50 = stats.Histogram().Percentile(50);
+    uint64_t p99 = stats.Histogram().Percentile(99);
+    CHECK(p50 >= 500000 && p50 <= 625000);
+    CHECK(p99 >= 990000 && p99 <= 1240000);
+
+    stats.Reset();
+    CHECK(stats.Calls() == 0);
+    CHECK(stats.Histogram().Percentile(99) == 0);
+}
+
+static void TestStackConfigParse()
+{
+    std::vector<StackConfigError> errors;
+    StackConfig config = ParseStackConfig(
+        L"# comment\n"
+        L"MaxStack = 250 ; inline comment\n"
+        L"AutoSort = true\n"
+        L"VirtualStacks = true\n"
+        L"ExportTables = DT_Enemies, DT_Recipe*\n"
+        L"Bogus = 1\n"
+        L"[Overrides]\n"
+        L"Item_Gold = 5000\n"
+        L"Potion_* = keep\n"
+        L"Item_Bad = -3\n"
+        L"no equals sign\n",
+        1000, &errors);
+
+    CHECK(config.MaxStack == 250);
+    CHECK(config.AutoSort);
+    CHECK(config.VirtualStacks);
+    CHECK(config.ExportTables.size() == 2 && config.ExportTables[1] == L"DT_Recipe*");
+    CHECK(config.Overrides.size() == 2);
+    CHECK(config.Overrides[0].Pattern == L"Item_Gold" && config.Overrides[0].Value == 5000);
+    CHECK(config.Overrides[1].Kind == StackRuleKind::Keep);
+    CHECK(errors.size() == 3);
+
+    CHECK(ParseStackConfig(L"MaxStack = lots\n", 1000).MaxStack == 1000);
+    CHECK(!ParseStackConfig(L"AutoSort = yes\n", 1000).AutoSort);
+    CHECK(ParseStackConfig(L"PatchFrameBudget = 0\n", 1000).PatchFrameBudget == 0);
+    CHECK(ParseStackConfig(L"PatchFrameBudget = -5\n", 1000).PatchFrameBudget == StackConfig{}.PatchFrameBudget);
+}
+
+static void TestStackRuleTableCompile()
+{
+    // Row i holds 0, 20, 999, 5000 for i % 4 == 0, 1, 2, 3
+    SyntheticTable table(12, MixedMaxStack);
+    StackPatchCore<RowMap> core;
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+
+    StackConfig config = ParseStackConfig(
+        L"MaxStack = 100\n"
+        L"[Overrides]\n"
+        L"Item_1 = 7\n"     // exact, lowers
+        L"Item_1* = 300\n"  // prefix: Item_10, Item_11
+        L"Item_? = keep\n"  // wildcard: single-digit rows without another rule
+        L"Item_4 = 50\n"    // exact, but the row is non-stackable
+        L"Item_5 = 40\n",   // exact beats the wildcard
+        1000);
+
+    StackRuleTable rules;
+    rules.Compile(config, core.Entries(), [&](size_t i) { return core.Keys()[i].ToString(); });
+    const std::vector<int32_t>& targets = rules.Targets();
+    CHECK(targets.size() == 12);
+    CHECK(targets[1] == 7);
+    CHECK(targets[2] == 999); // keep
+    CHECK(targets[4] == 0);
+    CHECK(targets[5] == 40);
+    CHECK(targets[9] == 20);  // keep
+    CHECK(targets[10] == 300);
+    CHECK(targets[11] == 300); // overrides may lower rows above the global cap
+    CHECK(rules.OverrideCount() == 12);
+
+    // Single sweep applies them; reverting the layer puts everything back
+    PatchJournal journal;
+    PatchJournal::LayerId layer = journal.Begin(L"stacks");
+    int modified = 0;
+    for (size_t i = 0; i < core.Size(); ++i)
+    {
+        modified += journal.Write(layer, core.Entries()[i].MaxStack, targets[i], static_cast<uint32_t>(i));
+    }
+    CHECK(modified == 4);
+    CHECK(table.MaxStack(1) == 7);
+    CHECK(table.MaxStack(11) == 300);
+    CHECK(journal.Revert(layer).Restored == 4);
+    CHECK(table.MaxStack(1) == 20);
+    CHECK(table.MaxStack(11) == 5000);
+
+    // Targeted lookups agree with the compiled table, and fall back to the global cap
+    CHECK(rules.TargetFor(core.Entries()[5].MaxStack, 20) == 40);
+    int32_t unrelated = 20;
+    CHECK(rules.TargetFor(&unrelated, 20) == 100);
+}
+
+static void TestRetrySchedulerBackoff()
+{
+    using namespace std::chrono;
+    RetryScheduler scheduler;
+    int attempts = 0;
+    scheduler.Add(L"Task", milliseconds(100), milliseconds(350), [&] { return ++attempts == 5; });
+
+    auto start = RetryScheduler::Clock::time_point{} + hours(1);
+    CHECK(scheduler.RunDue(start)); // First attempt is immediate
+    CHECK(attempts == 1);
+    CHECK(scheduler.NextDue() == start + milliseconds(100));
+
+    CHECK(scheduler.RunDue(start + milliseconds(99)));
+    CHECK(attempts == 1); // Not due yet
+
+    scheduler.RunDue(start + milliseconds(100));
+    CHECK(scheduler.NextDue() == start + milliseconds(300)); // Doubled
+    scheduler.RunDue(start + milliseconds(300));
+    CHECK(scheduler.NextDue() == start + milliseconds(650)); // Capped at 350
+    CHECK(scheduler.Attempts(L"Task") == 3);
+
+    CHECK(scheduler.RunDue(start + milliseconds(650)));
+    CHECK(attempts == 4);
+    CHECK(!scheduler.RunDue(start + seconds(2))); // Fifth attempt succeeds, task dropped
+    CHECK(attempts == 5);
+    CHECK(scheduler.Empty());
+    CHECK(scheduler.NextDue() == RetryScheduler::Clock::time_point::max());
+
+    // A task that never succeeds is given up at its attempt limit
+    const wchar_t* givenUp = nullptr;
+    unsigned givenUpAfter = 0;
+    auto onGiveUp = [&](const wchar_t* name, unsigned count) { givenUp = name; givenUpAfter = count; };
+    scheduler.Add(L"Never", milliseconds(100), milliseconds(100), [] { return false; }, 3);
+    CHECK(scheduler.RunDue(start, onGiveUp));
+    CHECK(scheduler.RunDue(start + milliseconds(100), onGiveUp));
+    CHECK(!scheduler.RunDue(start + milliseconds(200), onGiveUp));
+    CHECK(givenUp && std::wcscmp(givenUp, L"Never") == 0 && givenUpAfter == 3);
+    CHECK(scheduler.Empty());
+}
+
+static void TestTablePatchApplyRevert()
+{
+    SyntheticTable table(8, MixedMaxStack);
+    for (size_t i = 0; i < 8; ++i)
+    {
+        float weight = 2.0f;
+        std::memcpy(table.Row(i) + 0x24, &weight, sizeof(weight));
+    }
+    FieldLayout layout;
+    layout.Add({L"Weight", 0x24, 4, FieldType::Float});
+    layout.Add({L"MaximumStack", 0x5C, 4, FieldType::Int32});
+    layout.Add({L"SellCanStack", 0x99, 1, FieldType::Bool});
+    layout.Add({L"Id", 0x30, 8, FieldType::Name});
+
+    std::vector<ConfigError> errors;
+    std::vector<PatchGroup> groups = ParsePatchSpecs(
+        L"[DT_Enemies]\n"
+        L"*.MaximumStack *= 3\n"
+        L"*.MaximumStack = clamp(10, 2000)\n" // Composes with the line above
+        L"Item_1.Weight += 0.5\n"
+        L"Item_?.SellCanStack = true\n"
+        L"Item_2.Id = 4\n"                    // Not numeric
+        L"Item_2.Missing = 4\n"
+        L"[DT_Other]\n"
+        L"Row.Field = nonsense\n",
+        &errors);
+    CHECK(groups.size() == 1); // DT_Other has no valid specs
+    CHECK(groups[0].Specs.size() == 6);
+    CHECK(groups[0].Specs[1].Op == PatchOp::Clamp && groups[0].Specs[1].B == 2000.0);
+    CHECK(errors.size() == 1);
+
+    TablePatch patch;
+    errors.clear();
+    TablePatch::CompileResult compiled = patch.Compile(&table, table.GetRowMap(), layout, groups[0].Specs,
+                                                       [](const FName& key) { return key.ToString(); }, &errors);
+    CHECK(errors.size() == 2);
+    CHECK(compiled.Rows == 8);
+    CHECK(compiled.Fields == 8 + 1 + 8);
+
+    unsigned char sellCanStack4 = table.Row(4)[0x99];
+    PatchJournal journal;
+    PatchJournal::LayerId layer = journal.Begin(L"DT_Enemies");
+    size_t changed = patch.Apply(journal, layer);
+    CHECK(changed == journal.Changes(layer));
+    CHECK(table.MaxStack(0) == 10);   // 0 * 3, clamped up
+    CHECK(table.MaxStack(1) == 60);   // 20 * 3
+    CHECK(table.MaxStack(3) == 2000); // 5000 * 3, clamped down
+    float weight = 0.0f;
+    std::memcpy(&weight, table.Row(1) + 0x24, sizeof(weight));
+    CHECK(weight == 2.5f);
+    CHECK(table.Row(4)[0x99] == 1);
+
+    CHECK(journal.Revert(layer).Restored == changed);
+    CHECK(table.MaxStack(0) == 0 && table.MaxStack(1) == 20 && table.MaxStack(3) == 5000);
+    std::memcpy(&weight, table.Row(1) + 0x24, sizeof(weight));
+    CHECK(weight == 2.0f);
+    CHECK(table.Row(4)[0x99] == sellCanStack4);
+}
+
+static void TestBitfieldBoolsShareAByte()
+{
+    // uint32 bFirst : 1, bSecond : 1 (bit 2), bOther : 1 (bit 7) at 0x9C; all in its second byte
+    SyntheticTable table(4, MixedMaxStack);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        table.Row(i)[0x9D] = 0x84; // bSecond and bOther set
+    }
+    FieldLayout layout;
+    layout.Add({L"bFirst", 0x9C, 4, FieldType::Bool, 1, 0x01, 0x01});
+    layout.Add({L"bSecond", 0x9C, 4, FieldType::Bool, 1, 0x04, 0x04});
+    CHECK(layout.Find(L"bFirst")->IsBitfield());
+    CHECK(!layout.Accessor<bool>(L"bFirst").IsValid()); // Has no byte of its own
+    CHECK(layout.Check({L"bSecond", 0x9C, 4, FieldType::Bool}) == FieldCheck::TypeMismatch);
+    CHECK(!ReadBoolField(*layout.Find(L"bFirst"), table.Row(0)) && ReadBoolField(*layout.Find(L"bSecond"), table.Row(0)));
+
+    std::vector<PatchGroup> groups = ParsePatchSpecs(
+        L"[DT_Enemies]\n"
+        L"*.bFirst = true\n"
+        L"Item_1.bSecond = false\n");
+    TablePatch patch;
+    TablePatch::CompileResult compiled = patch.Compile(&table, table.GetRowMap(), layout, groups[0].Specs,
+                                                       [](const FName& key) { return key.ToString(); });
+    CHECK(compiled.Rows == 4 && compiled.Fields == 4 + 1);
+
+    PatchJournal journal;
+    PatchJournal::LayerId layer = journal.Begin(L"DT_Enemies");
+    CHECK(patch.Apply(journal, layer) == 5);
+    CHECK(table.Row(0)[0x9D] == 0x85 && table.Row(1)[0x9D] == 0x81 && table.Row(3)[0x9D] == 0x85);
+    CHECK(table.Row(0)[0x9C] == 0 && table.Row(0)[0x9E] == 0);
+    CHECK(patch.Apply(journal, layer) == 0); // Already set
+
+    // Exported as the bits themselves, not the byte
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "isb_bitfield_bools.csv";
+    TableExportWriter writer;
+    CHECK(writer.Open(path, TableExportFormat::Csv, L"DT_Enemies", L"BeltTDEnemyConfig", layout));
+    writer.AddRow(L"Item_1", table.Row(1));
+    CHECK(writer.Close());
+    std::ifstream csv(path);
+    std::string line;
+    std::getline(csv, line);
+    std::getline(csv, line);
+    CHECK(line == "Item_1,true,false");
+    csv.close();
+    std::filesystem::remove(path);
+
+    CHECK(journal.Revert(layer).Restored == 4); // Item_1's two bits are one byte in the journal
+    CHECK(table.Row(0)[0x9D] == 0x84 && table.Row(1)[0x9D] == 0x84);
+}
+
+static void TestObjectPatchTemplateAndInstances()
+{
+    // Stand-in for CannonFacilityComponent: a template and instances copied from it
+    struct Cannon
+    {
+        float MaxDistance;
+        float MinDistance;
+        int32_t SplinePoints;
+        int32_t TraceNum;
+    };
+    FieldLayout layout;
+    layout.Add({L"CatapultMaxDistance", 0, 4, FieldType::Float});
+    layout.Add({L"CatapultMinDistance", 4, 4, FieldType::Float});
+    layout.Add({L"SplineNumPoints", 8, 4, FieldType::Int32});
+    layout.Add({L"ObstacleTraceNum", 12, 4, FieldType::Int32});
+
+    std::vector<ConfigError> errors;
+    std::vector<PatchGroup> groups = ParsePatchSpecs(
+        L"[/Game/Blueprints/Buildings/BP_Cannon.BP_Cannon_C:CannonFacility_GEN_VARIABLE]\n"
+        L"CatapultMaxDistance = 99999.0\n"
+        L"SplineNumPoints *= 2\n"
+        L"ObstacleTraceNum = 0\n"
+        L"Rows.Field = 1\n"                // Object sections take bare field names
+        L"[/Game/NotATemplate]\n",
+        &errors);
+    CHECK(errors.size() == 2);
+    CHECK(groups.size() == 1 && groups[0].IsObject() && groups[0].Specs.size() == 3);
+    CHECK(TemplateOwnerClassName(groups[0].Table) == L"BP_Cannon_C");
+    CHECK(TemplateOwnerClassName(L"/Game/NotATemplate").empty());
+    CHECK(!IsObjectPatchSection(L"DT_Enemies"));
+
+    Cannon archetype{5000.0f, 100.0f, 3, 8};
+    std::vector<Cannon> spawned(300, archetype);
+    spawned[7].SplinePoints = 6; // Already at the new value
+
+    ObjectPatch patch;
+    CHECK(patch.Compile(layout, groups[0].Specs) == 3);
+
+    PatchJournal journal;
+    PatchJournal::LayerId layer = journal.Begin(groups[0].Table);
+    CHECK(patch.ApplyTemplate(journal, layer, reinterpret_cast<unsigned char*>(&archetype)) == 3);
+    CHECK(archetype.MaxDistance == 99999.0f && archetype.MinDistance == 100.0f && archetype.SplinePoints == 6 && archetype.TraceNum == 0);
+
+    size_t changed = 0;
+    for (Cannon& cannon : spawned)
+    {
+        changed += patch.ApplyInstance(reinterpret_cast<unsigned char*>(&cannon));
+    }
+    CHECK(changed == 300 * 3 - 1);
+    CHECK(spawned[42].MaxDistance == 99999.0f && spawned[42].SplinePoints == 6 && spawned[42].TraceNum == 0);
+
+    // Reverting restores the template; instances keep what they were given
+    journal.Revert(layer);
+    CHECK(archetype.MaxDistance == 5000.0f && archetype.SplinePoints == 3 && archetype.TraceNum == 8);
+    CHECK(spawned[42].MaxDistance == 99999.0f);
+
+    // Bitfield bools: template and instances change only the patched bits
+    FieldLayout flagsLayout;
+    flagsLayout.Add({L"bAutoFire", 0, 1, FieldType::Bool, 0, 0x01, 0x01});
+    flagsLayout.Add({L"bShowRange", 0, 1, FieldType::Bool, 0, 0x02, 0x02});
+    std::vector<PatchGroup> flagGroups = ParsePatchSpecs(
+        L"[/Game/Blueprints/Buildings/BP_Cannon.BP_Cannon_C:CannonFacility_GEN_VARIABLE]\n"
+        L"bAutoFire = true\n"
+        L"bShowRange = false\n");
+    ObjectPatch flags;
+    CHECK(flags.Compile(flagsLayout, flagGroups[0].Specs) == 2);
+    unsigned char flagTemplate = 0x82; // bShowRange and a flag the patch doesn't name
+    unsigned char flagInstances[2] = {0x02, 0x40};
+    PatchJournal::LayerId flagLayer = journal.Begin(flagGroups[0].Table);
+    CHECK(flags.ApplyTemplate(journal, flagLayer, &flagTemplate) == 2);
+    CHECK(flagTemplate == 0x81);
+    CHECK(flags.ApplyInstance(&flagInstances[0]) == 2 && flagInstances[0] == 0x01);
+    CHECK(flags.ApplyInstance(&flagInstances[1]) == 1 && flagInstances[1] == 0x41);
+    journal.Revert(flagLayer);
+    CHECK(flagTemplate == 0x82);
+}
+
+static void TestPatchJournalLayers()
+{
+    int32_t fields[4] = {10, 20, 30, 40};
+    PatchJournal journal;
+
+    PatchJournal::LayerId tables = journal.Begin(L"tables");
+    CHECK(journal.Write(tables, &fields[0], 100));
+    CHECK(journal.Write(tables, &fields[1], 200));
+    CHECK(!journal.Write(tables, &fields[2], 30)); // Unchanged bytes are not recorded
+    CHECK(journal.Write(tables, &fields[0], 150)); // Same layer again keeps the first "before"
+    CHECK(journal.Changes(tables) == 2);
+
+    PatchJournal::LayerId stacks = journal.Begin(L"stacks");
+    CHECK(journal.Write(stacks, &fields[0], 1000, 7));
+    CHECK(journal.Write(stacks, &fields[3], 1000, 9));
+    CHECK(journal.PatchedAddresses() == 3);
+
+    // Older layer first: its original is handed to the newer edit on field 0
+    PatchJournal::RevertResult result = journal.Revert(tables);
+    CHECK(result.Restored == 1 && result.Superseded == 1 && result.Conflicts == 0);
+    CHECK(fields[0] == 1000 && fields[1] == 20);
+    CHECK(!journal.IsActive(tables));
+
+    // Field 3 changed behind the journal's back is left alone unless forced
+    fields[3] = 55;
+    CHECK(journal.Verify(stacks) == 1);
+    std::vector<uint32_t> restoredTags;
+    result = journal.Revert(stacks, PatchJournal::RevertMode::SkipModified,
+                            [&](uint32_t tag, uint64_t, uint64_t) { restoredTags.push_back(tag); });
+    CHECK(result.Restored == 1 && result.Conflicts == 1);
+    CHECK(fields[0] == 10 && fields[3] == 55);
+    CHECK(restoredTags.size() == 1 && restoredTags[0] == 7);
+    CHECK(journal.PatchedAddresses() == 0);
+
+    PatchJournal::LayerId forced = journal.Begin(L"forced");
+    journal.Write(forced, &fields[3], 1000);
+    fields[3] = 56;
+    CHECK(journal.Revert(forced, PatchJournal::RevertMode::Force).Restored == 1);
+    CHECK(fields[3] == 55);
+
+    // Discard forgets a layer without writing; the layer above inherits its original
+    PatchJournal::LayerId lower = journal.Begin(L"lower");
+    PatchJournal::LayerId upper = journal.Begin(L"upper");
+    journal.Write(lower, &fields[1], 21);
+    journal.Write(upper, &fields[1], 22);
+    journal.Discard(lower);
+    CHECK(fields[1] == 22);
+    journal.Revert(upper);
+    CHECK(fields[1] == 20);
+
+    // Enough fields to grow and shrink the address index repeatedly
+    std::vector<int32_t> many(5000, 1);
+    PatchJournal::LayerId all = journal.Begin(L"all");
+    PatchJournal::LayerId odd = journal.Begin(L"odd");
+    for (size_t i = 0; i < many.size(); ++i)
+    {
+        journal.Write(all, &many[i], 2);
+    }
+    for (size_t i = 1; i < many.size(); i += 2)
+    {
+        journal.Write(odd, &many[i], 3);
+    }
+    result = journal.Revert(all);
+    CHECK(result.Restored == 2500 && result.Superseded == 2500);
+    CHECK(many[0] == 1 && many[1] == 3);
+    CHECK(journal.PatchedAddresses() == 2500);
+    journal.Revert(odd);
+    CHECK(std::count(many.begin(), many.end(), 1) == 5000);
+    CHECK(journal.PatchedAddresses() == 0);
+}
+
+static void TestIncrementalSweepBudget()
+{
+    // A fake clock: every batch takes 300 us
+    using Clock = IncrementalSweep::Clock;
+    Clock::time_point clock{};
+    auto now = [&] { return clock; };
+    std::vector<int32_t> fields(1000, 10);
+    auto step = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) fields[i] = 100;
+        clock += std::chrono::microseconds(300);
+    };
+
+    // 1000 items in batches of 64 under a 1000 us budget: 4 batches (1200 us) per frame
+    IncrementalSweep sweep;
+    sweep.Start(fields.size());
+    CHECK(!sweep.RunFrame(std::chrono::microseconds(1000), step, now));
+    CHECK(sweep.Active() && sweep.GetProgress().Done == 256);
+    CHECK(fields[255] == 100 && fields[256] == 10); // Nothing past the finished batches
+    uint32_t frames = 1;
+    while (!sweep.RunFrame(std::chrono::microseconds(1000), step, now)) frames++;
+    CHECK(frames + 1 == 4 && sweep.GetProgress().Frames == 4);
+    CHECK(!sweep.Active() && sweep.GetProgress().Done == 1000);
+    CHECK(std::all_of(fields.begin(), fields.end(), [](int32_t value) { return value == 100; }));
+    CHECK(sweep.GetProgress().Busy == std::chrono::microseconds(16 * 300));
+
+    // A budget smaller than one batch still makes progress; zero means no limit
+    sweep.Start(200, 50);
+    CHECK(!sweep.RunFrame(std::chrono::microseconds(1), step, now) && sweep.GetProgress().Done == 50);
+    CHECK(sweep.RunFrame(std::chrono::microseconds(0), step, now) && sweep.GetProgress().Done == 200);
+    sweep.Start(0);
+    CHECK(sweep.RunFrame(std::chrono::microseconds(1), step, now) && !sweep.Active());
+
+    // A revert spread over several steps ends where a single Revert would
+    int32_t a[3] = {1, 2, 3};
+    int32_t b[3] = {1, 2, 3};
+    PatchJournal whole;
+    PatchJournal stepped;
+    PatchJournal::LayerId wholeLower = whole.Begin(L"lower");
+    PatchJournal::LayerId steppedLower = stepped.Begin(L"lower");
+    whole.Write(wholeLower, &a[0], 50);
+    stepped.Write(steppedLower, &b[0], 50);
+    PatchJournal::LayerId wholeLayer = whole.Begin(L"stacks");
+    PatchJournal::LayerId steppedLayer = stepped.Begin(L"stacks");
+    for (int i = 0; i < 3; ++i)
+    {
+        whole.Write(wholeLayer, &a[i], 100 + i);
+        stepped.Write(steppedLayer, &b[i], 100 + i);
+    }
+    a[2] = 7; // Changed by the game since
+    b[2] = 7;
+    PatchJournal::RevertResult single = whole.Revert(wholeLayer);
+    PatchJournal::RevertResult first = stepped.RevertNewest(steppedLayer, 2, PatchJournal::RevertMode::SkipModified,
+                                                            [](uint32_t, uint64_t, uint64_t) {});
+    CHECK(stepped.IsActive(steppedLayer) && stepped.Changes(steppedLayer) == 1);
+    PatchJournal::RevertResult second = stepped.RevertNewest(steppedLayer, 2, PatchJournal::RevertMode::SkipModified,
+                                                             [](uint32_t, uint64_t, uint64_t) {});
+    CHECK(!stepped.IsActive(steppedLayer));
+    CHECK(first.Restored + second.Restored == single.Restored && first.Conflicts + second.Conflicts == single.Conflicts);
+    CHECK(std::equal(a, a + 3, b) && b[0] == 50 && b[1] == 2 && b[2] == 7);
+    CHECK(stepped.Revert(steppedLower).Restored == 1 && b[0] == 1);
+}
+
+// Shift+J, K, J with nothing to change, stepped the way the stack sweep
+// action does: the patch still opens a layer and the restore sweep has no
+// batches, so the restore must finish by reverting the (empty) layer.
+static void TestEmptyStackSweepRestore()
+{
+    using Op = PatchStateMachine::Op;
+    using Result = PatchStateMachine::Result;
+    SyntheticTable table(64, [](size_t) { return 5000; }); // Every row above the cap
+    StackPatchCore<RowMap> core;
+    core.Build(&table, table.GetRowMap(), MaxStackField());
+    PatchJournal journal;
+    PatchJournal::LayerId stacks = PatchJournal::InvalidLayer;
+    PatchStateMachine state;
+    IncrementalSweep sweep;
+    size_t restoreSteps = 0;
+
+    auto patch = [&] {
+        if (state.TryBegin(Op::Patch) != Result::Began) return false;
+        stacks = journal.Begin(L"stacks");
+        sweep.Start(core.Size(), 16);
+        while (!sweep.RunFrame(std::chrono::microseconds(0), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+            {
+                int32_t* field = core.Entries()[i].MaxStack;
+                journal.Write(stacks, field, ApplyMaxStackRule(*field, 1000), static_cast<uint32_t>(i));
+            }
+        }))
+        {
+        }
+        state.End(journal.IsActive(stacks));
+        return true;
+    };
+    auto restore = [&] {
+        if (state.TryBegin(Op::Restore) != Result::Began) return false;
+        sweep.Start(journal.Changes(stacks), 16);
+        while (!sweep.RunFrame(std::chrono::microseconds(0), [&](size_t begin, size_t end) {
+            restoreSteps++;
+            journal.RevertNewest(stacks, end - begin, PatchJournal::RevertMode::SkipModified, [](uint32_t, uint64_t, uint64_t) {});
+        }))
+        {
+        }
+        journal.Revert(stacks); // The sweep's last step
+        stacks = PatchJournal::InvalidLayer;
+        state.End(journal.IsActive(stacks));
+        return true;
+    };
+
+    CHECK(patch());
+    CHECK(state.IsPatched() && journal.IsActive(stacks) && journal.Changes(stacks) == 0);
+    CHECK(restore());
+    CHECK(restoreSteps == 0);
+    CHECK(!state.IsPatched() && !journal.IsActive(stacks));
+    CHECK(patch()); // Not AlreadyPatched
+    CHECK(restore());
+    CHECK(!state.IsPatched() && state.Load().Owner == Op::None);
+    for (size_t i = 0; i < 64; ++i)
+    {
+        CHECK(table.MaxStack(i) == 5000);
+    }
+}
+
+static void TestTablePatchThroughJournal()
+{
+    SyntheticTable table(8, MixedMaxStack);
+    FieldLayout layout;
+    layout.Add({L"MaximumStack", 0x5C, 4, FieldType::Int32});
+    std::vector<PatchGroup> groups = ParsePatchSpecs(L"[DT_Enemies]\nItem_1.MaximumStack *= 2\n");
+    TablePatch patch;
+    patch.Compile(&table, table.GetRowMap(), layout, groups[0].Specs, [](const FName& key) { return key.ToString(); });
+
+    // Table patch underneath, stack rules on top of its result
+    PatchJournal journal;
+    PatchJournal::LayerId tables = journal.Begin(L"DT_Enemies");
+    CHECK(patch.Apply(journal, tables) == 1);
+    CHECK(table.MaxStack(1) == 40);
+
+    PatchJournal::LayerId stacks = journal.Begin(L"stacks");
+    for (size_t i = 0; i < 8; ++i)
+    {
+        int32_t* field = reinterpret_cast<int32_t*>(table.Row(i) + SyntheticTable::MaximumStackOffset);
+        journal.Write(stacks, field, ApplyMaxStackRule(*field, 1000), static_cast<uint32_t>(i));
+    }
+    CHECK(table.MaxStack(1) == 1000 && table.MaxStack(2) == 1000);
+
+    // Undo the table patch while the stack layer stays: nothing visible changes yet
+    journal.Revert(tables);
+    CHECK(table.MaxStack(1) == 1000);
+    journal.Revert(stacks);
+    CHECK(table.MaxStack(1) == 20 && table.MaxStack(2) == 999 && table.MaxStack(3) == 5000);
+}
+
+static void TestDiscoveryCacheRoundTrip()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "isb_discovery_cache_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::filesystem::path path = directory / "discovery_cache.bin";
+
+    // Build key follows the files' size, not just their names
+    std::filesystem::path exe = directory / "Game.exe";
+    std::ofstream(exe) << "v1";
+    uint64_t buildKey = ComputeBuildKey({exe});
+    std::ofstream(exe) << "v1.1";
+    CHECK(ComputeBuildKey({exe}) != buildKey);
+
+    DiscoveryCache writer;
+    CHECK(!writer.Load(path, buildKey));
+    writer.Set(L"table:DT_Enemies", L"/Game/Data/DT_Enemies.DT_Enemies", 412);
+    writer.Set(L"field:DT_Enemies.MaximumStack", L"/Game/Data/S_EnemyConfig.S_EnemyConfig", 0x5C, 4);
+    CHECK(writer.Dirty());
+    CHECK(writer.Save(path, buildKey));
+    CHECK(!writer.Dirty());
+
+    DiscoveryCache reader;
+    CHECK(reader.Load(path, buildKey));
+    CHECK(reader.LoadedCount() == 2);
+    DiscoveryCache::Record record;
+    CHECK(reader.Find(L"table:DT_Enemies", record));
+    CHECK(record.Path == L"/Game/Data/DT_Enemies.DT_Enemies" && record.A == 412);
+    CHECK(reader.Find(L"field:DT_Enemies.MaximumStack", record) && record.A == 0x5C && record.B == 4);
+    CHECK(!reader.Find(L"table:DT_Other", record));
+
+    // Same result again is not a change; a moved object is
+    reader.Set(L"table:DT_Enemies", L"/Game/Data/DT_Enemies.DT_Enemies", 412);
+    CHECK(!reader.Dirty());
+    reader.Set(L"table:DT_Enemies", L"/Game/Data/DT_Enemies.DT_Enemies", 413);
+    CHECK(reader.Dirty());
+
+    // A result Set this launch is found again at once, and still after the
+    // mapping is closed for saving
+    reader.Set(L"table:DT_Items", L"/Game/Data/DT_Items.DT_Items");
+    CHECK(reader.Find(L"table:DT_Items", record) && record.Path == L"/Game/Data/DT_Items.DT_Items");
+    CHECK(reader.Find(L"table:DT_Enemies", record) && record.A == 413);
+
+    // Loaded entries survive a save that only updated one of them
+    reader.Close();
+    CHECK(reader.Find(L"field:DT_Enemies.MaximumStack", record) && record.A == 0x5C);
+    CHECK(reader.Save(path, buildKey));
+    CHECK(reader.Find(L"table:DT_Items", record) && record.Path == L"/Game/Data/DT_Items.DT_Items");
+    CHECK(reader.Load(path, buildKey) && reader.LoadedCount() == 3);
+    reader.Close();
+
+    // Another build, a flipped byte or a truncated file all fall back to scanning
+    CHECK(!reader.Load(path, buildKey + 1));
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    std::string corrupt = bytes;
+    corrupt[corrupt.size() - 3] ^= 0x20;
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(corrupt.data(), static_cast<std::streamsize>(corrupt.size()));
+    CHECK(!reader.Load(path, buildKey));
+    std::ofstream(path, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size() - 8));
+    CHECK(!reader.Load(path, buildKey));
+    CHECK(!reader.Loaded());
+
+    std::filesystem::remove_all(directory);
+}
+
+static void TestIncrementalSlotSorter()
+{
+    // Slots hold (key, tag); the tag tells slots with the same key apart after moving
+    struct Slot
+    {
+        uint64_t Key;
+        uint32_t Tag;
+    };
+    std::vector<Slot> slots = {{30, 0}, {10, 1}, {EmptySlotKey, 2}, {20, 3}, {10, 4}, {EmptySlotKey, 5}};
+    auto keysOf = [&] {
+        std::vector<uint64_t> keys;
+        for (const Slot& slot : slots) keys.push_back(slot.Key);
+        return keys;
+    };
+    auto sorted = [&] {
+        for (size_t i = 1; i < slots.size(); ++i)
+        {
+            if (slots[i - 1].Key > slots[i].Key) return false;
+        }
+        return true;
+    };
+
+    IncrementalSlotSorter sorter;
+    std::vector<unsigned char> scratch;
+    std::vector<uint8_t> placed;
+
+    std::vector<uint64_t> keys = keysOf();
+    SlotSortResult result = sorter.Update(keys.data(), keys.size());
+    CHECK(result.Full && result.Changed == 6);
+    ApplySlotPermutation(reinterpret_cast<unsigned char*>(slots.data()), sizeof(Slot), sorter.Source(), scratch, placed);
+    CHECK(sorted());
+    CHECK(slots[0].Tag == 1 && slots[1].Tag == 4); // Equal keys keep their order
+
+    // Nothing changed: nothing moves
+    keys = keysOf();
+    result = sorter.Update(keys.data(), keys.size());
+    CHECK(!result.Full && result.Changed == 0 && result.Moved == 0);
+
+    // A pickup lands in the first empty slot; only it and the slots it passes move
+    slots[4] = {15, 9};
+    keys = keysOf();
+    result = sorter.Update(keys.data(), keys.size());
+    CHECK(!result.Full && result.Changed == 1);
+    CHECK(result.Moved == 3);
+    CHECK(ApplySlotPermutation(reinterpret_cast<unsigned char*>(slots.data()), sizeof(Slot), sorter.Source(), scratch, placed) == 3);
+    CHECK(sorted() && slots[2].Tag == 9);
+
+    // A slot emptied in the middle moves to the end
+    slots[0] = {EmptySlotKey, 10};
+    keys = keysOf();
+    result = sorter.Update(keys.data(), keys.size());
+    CHECK(result.Changed == 1);
+    ApplySlotPermutation(reinterpret_cast<unsigned char*>(slots.data()), sizeof(Slot), sorter.Source(), scratch, placed);
+    CHECK(sorted() && slots[0].Tag == 4 && slots[5].Key == EmptySlotKey);
+
+    // Resized inventory: start over with a full sort
+    slots.push_back({5, 11});
+    keys = keysOf();
+    CHECK(sorter.Update(keys.data(), keys.size()).Full);
+    ApplySlotPermutation(reinterpret_cast<unsigned char*>(slots.data()), sizeof(Slot), sorter.Source(), scratch, placed);
+    CHECK(sorted() && slots[0].Tag == 11);
+}
+
+static void TestStackCompactorMergesPartials()
+{
+    // Item 1 stacks to 10, item 2 to 5, item 3 not at all
+    auto limitOf = [](uint64_t key) { return key == 1 ? 10 : key == 2 ? 5 : 1; };
+    std::vector<uint64_t> keys = {1, 2, EmptySlotKey, 1, 3, 1, 2, 1, 3};
+    std::vector<int32_t> counts = {4, 5, 0, 3, 1, 6, 2, 12, 1};
+    size_t asked = 0;
+    StackCompactor compactor;
+    const std::vector<SlotCountWrite>& writes = compactor.Plan(keys.data(), counts.data(), keys.size(), [&](size_t slot) {
+        asked++;
+        return limitOf(keys[slot]);
+    });
+    CHECK(asked == 3); // Once per item
+
+    // 4 + 3 fill slot 0 to 7, slot 5 tops it up to 10 and keeps 3; the full item 2 stack
+    // and the over-limit stack in slot 7 are left alone
+    std::vector<int32_t> after = counts;
+    for (const SlotCountWrite& write : writes) after[write.Slot] = write.Count;
+    CHECK(writes.size() == 3);
+    CHECK((after == std::vector<int32_t>{10, 5, 0, 0, 1, 3, 2, 12, 1}));
+    CHECK(compactor.Emptied() == 1);
+
+    // Applying the plan leaves nothing to merge
+    CHECK(compactor.Plan(keys.data(), after.data(), keys.size(), [&](size_t slot) { return limitOf(keys[slot]); }).empty());
+
+    // Raised limit: every partial stack pours into the first one
+    counts = {4, 2, 0, 3, 1, 6, 2, 2, 1};
+    compactor.Plan(keys.data(), counts.data(), keys.size(), [&](size_t slot) { return keys[slot] == 3 ? 1 : 100; });
+    after = counts;
+    for (const SlotCountWrite& write : compactor.Writes()) after[write.Slot] = write.Count;
+    CHECK((after == std::vector<int32_t>{15, 4, 0, 0, 1, 0, 0, 0, 1}));
+    CHECK(compactor.Emptied() == 4);
+}
+
+static void TestFrameSchedulerCoalescing()
+{
+    using namespace std::chrono;
+    FrameScheduler frames;
+    int a = 1, b = 2;
+    std::vector<int> sorted;
+    FrameScheduler::ActionId sort = FrameScheduler::InvalidAction;
+    FrameScheduler::ActionId update = FrameScheduler::InvalidAction;
+    sort = frames.RegisterAction(L"sort", milliseconds(0), [&](void* target) {
+        sorted.push_back(*static_cast<int*>(target));
+        CHECK(!frames.Post(sort, target)); // The event it triggers is ignored while it runs
+    });
+    FrameScheduler::ActionId rearrange = frames.RegisterAction(L"rearrange", milliseconds(350), [&](void*) {});
+    int poll = 0;
+    FrameScheduler::Clock::time_point now;
+    update = frames.RegisterAction(L"update", milliseconds(0), [&](void*) {
+        if (++poll < 3) frames.Post(update, nullptr, now); // Polls until done
+    }, FrameScheduler::ReentrantPost::Queue);
+    CHECK(frames.FindAction(L"rearrange") == rearrange && frames.FindAction(L"missing") == FrameScheduler::InvalidAction);
+
+    auto start = FrameScheduler::Clock::time_point{} + hours(1);
+    CHECK(!frames.HasQueued() && frames.RunFrame(start) == 0);
+
+    // A burst on two targets runs once per target
+    for (int i = 0; i < 20; ++i)
+    {
+        frames.Post(sort, &a, start);
+        frames.Post(sort, &b, start);
+    }
+    CHECK(frames.RunFrame(start) == 2);
+    CHECK(sorted.size() == 2 && sorted[0] == a && sorted[1] == b);
+    FrameScheduler::Counters counters = frames.GetCounters();
+    CHECK(counters.Posted == 2 && counters.Merged == 38 && counters.Suppressed == 2 && counters.Runs == 2);
+    CHECK(!frames.HasQueued());
+
+    // With an interval, posts during the cooldown merge into one trailing run
+    CHECK(frames.Post(rearrange, nullptr, start));
+    CHECK(frames.RunFrame(start) == 1);
+    CHECK(frames.Post(rearrange, nullptr, start + milliseconds(10)));
+    CHECK(!frames.Post(rearrange, nullptr, start + milliseconds(20)));
+    CHECK(frames.RunFrame(start + milliseconds(100)) == 0);
+    CHECK(frames.HasQueued());
+    CHECK(frames.RunFrame(start + milliseconds(350)) == 1);
+    CHECK(!frames.HasQueued());
+
+    // A self-posting action runs once per frame until it stops
+    frames.Post(update, nullptr, start);
+    for (int frame = 1; frame <= 5; ++frame)
+    {
+        now = start + seconds(frame);
+        frames.RunFrame(now);
+    }
+    CHECK(poll == 3 && !frames.HasQueued());
+
+    // A run posted for later waits, but an earlier post pulls it forward
+    now = start + seconds(10);
+    CHECK(frames.PostAt(sort, now + seconds(2), &a));
+    CHECK(frames.HasQueued() && !frames.HasDue(now));
+    CHECK(frames.RunFrame(now + seconds(1)) == 0);
+    CHECK(!frames.PostAt(sort, now + seconds(5), &a)); // Merged, keeps the earlier run
+    CHECK(frames.HasDue(now + seconds(2)) && !frames.HasDue(now + milliseconds(1500)));
+    CHECK(!frames.Post(sort, &a, now + milliseconds(1500)));
+    CHECK(frames.HasDue(now + milliseconds(1500)));
+    CHECK(frames.RunFrame(now + milliseconds(1500)) == 1);
+    CHECK(!frames.HasQueued() && !frames.HasDue(now + seconds(5)));
+    CHECK(!frames.Post(99)); // Unknown action
+}
+
+static void TestLuaBridgeQueueAndLookupCache()
+{
+    // A newer request for a pending name replaces it but keeps its place in line
+    KeyedRequestQueue<int> queue;
+    CHECK(queue.Push(L"cannons", 1));
+    CHECK(queue.Push(L"enemies", 2));
+    CHECK(!queue.Push(L"cannons", 3));
+    std::vector<std::pair<std::wstring, int>> drained = queue.Drain();
+    CHECK(drained.size() == 2 && drained[0].first == L"cannons" && drained[0].second == 3 && drained[1].second == 2);
+    CHECK(queue.Drain().empty() && queue.Replaced() == 1);
+    CHECK(queue.Push(L"cannons", 4)); // Drained names queue again
+
+    // Lookups: found once, then served while the check accepts the object at its index
+    int objects[2] = {};
+    int* slots[4] = {nullptr, &objects[0], nullptr, nullptr};
+    size_t finds = 0;
+    auto isAlive = [&](int* object, uint32_t index) { return index < 4 && slots[index] == object; };
+    auto find = [&](const std::wstring& path, uint32_t& index) -> int* {
+        finds++;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            if (slots[i] && path == (slots[i] == &objects[0] ? L"/Game/A" : L"/Game/B"))
+            {
+                index = i;
+                return slots[i];
+            }
+        }
+        return nullptr;
+    };
+
+    ObjectLookupCache<int> cache;
+    CHECK(cache.Get(L"/Game/A", isAlive, find) == &objects[0]);
+    CHECK(cache.Get(L"/Game/A", isAlive, find) == &objects[0] && finds == 1);
+    CHECK(cache.Get(L"/Game/B", isAlive, find) == nullptr);
+    CHECK(cache.Get(L"/Game/B", isAlive, find) == nullptr && finds == 3); // Misses are not remembered
+
+    // Collected and the slot reused: the stale entry is dropped and the path looked up again
+    slots[1] = &objects[1];
+    CHECK(cache.Get(L"/Game/A", isAlive, find) == nullptr);
+    slots[3] = &objects[0];
+    CHECK(cache.Get(L"/Game/A", isAlive, find) == &objects[0]);
+    CHECK(cache.Get(L"/Game/A", isAlive, find) == &objects[0]);
+    ObjectLookupCache<int>::Counters counters = cache.GetCounters();
+    CHECK(counters.Hits == 2 && counters.Stale == 1 && counters.Misses == 5);
+
+    // Lua strings are UTF-8: 2-, 3- and 4-byte sequences, then malformed ones
+    std::wstring path = Utf8ToWide("/Game/K\xC3\xA4se_\xE2\x82\xAC\xF0\x9F\x98\x80");
+    std::wstring expected = L"/Game/K\u00E4se_\u20AC";
+    expected += sizeof(wchar_t) == 2 ? std::wstring{wchar_t(0xD83D), wchar_t(0xDE00)} : std::wstring(1, wchar_t(0x1F600));
+    CHECK(path == expected);
+    CHECK(Utf8ToWide("a\xC0\xAF" "b\xE2\x82") == std::wstring(L"a\uFFFD\uFFFDb\uFFFD\uFFFD")); // Overlong '/', truncated
+    CHECK(Utf8ToWide("\xED\xA0\x80").size() == 3); // Encoded surrogate
+}
+
+static void TestTableExportRoundTripAndDiff()
+{
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "isb_table_export_test";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+
+    // More rows than one block, so block boundaries are crossed
+    const size_t rows = TableExportWriter::BlockRows * 2 + 17;
+    SyntheticTable before(rows, MixedMaxStack);
+    SyntheticTable after(rows, MixedMaxStack);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        float weight = static_cast<float>(i) * 0.5f;
+        std::memcpy(before.Row(i) + 0x24, &weight, sizeof(weight));
+        std::memcpy(after.Row(i) + 0x28, &weight, sizeof(weight)); // Weight moved by 4 bytes
+    }
+    after.SetMaxStack(3, 123);
+    after.SetMaxStack(rows - 1, 7);
+
+    auto layoutWithWeightAt = [](uint32_t weightOffset) {
+        FieldLayout layout;
+        layout.Add({L"Weight", weightOffset, 4, FieldType::Float});
+        layout.Add({L"MaximumStack", 0x5C, 4, FieldType::Int32});
+        layout.Add({L"SellCanStack", 0x99, 1, FieldType::Bool});
+        layout.Add({L"Stats", 0x60, 16, FieldType::Struct}); // Schema only
+        return layout;
+    };
+    auto write = [&](const std::filesystem::path& path, TableExportFormat format, SyntheticTable& table, uint32_t weightOffset, size_t skipRow) {
+        TableExportWriter writer;
+        CHECK(writer.Open(path, format, L"DT_Enemies", L"BeltTDEnemyConfig", layoutWithWeightAt(weightOffset)));
+        CHECK(writer.ExportedFields() == 3);
+        for (const auto& pair : table.GetRowMap())
+        {
+            if (pair.Key.ToString() == L"Item_" + std::to_wstring(skipRow)) continue;
+            writer.AddRow(pair.Key.ToString(), pair.Value);
+        }
+        CHECK(writer.Close());
+        return writer.Rows();
+    };
+
+    CHECK(write(directory / "before.isbt", TableExportFormat::Binary, before, 0x24, rows) == rows);
+    CHECK(write(directory / "after.isbt", TableExportFormat::Binary, after, 0x28, 5) == rows - 1);
+
+    TableDump old;
+    TableDump updated;
+    std::wstring error;
+    CHECK(ReadTableDump(directory / "before.isbt", old, &error));
+    CHECK(ReadTableDump(directory / "after.isbt", updated, &error));
+    CHECK(old.Table == L"DT_Enemies" && old.RowStruct == L"BeltTDEnemyConfig");
+    CHECK(old.RowNames.size() == rows && old.Layout.Fields().size() == 4 && old.Columns.size() == 3);
+    CHECK(old.Value(*old.FindColumn(L"MaximumStack"), 2) == L"999");
+    CHECK(old.Value(*old.FindColumn(L"Weight"), 3) == L"1.5");
+    CHECK(old.Value(*old.FindColumn(L"SellCanStack"), 2) == L"true");
+    CHECK(updated.Layout.Find(L"Weight")->Offset == 0x28); // Offsets come back from the schema
+
+    TableDumpDiff diff = DiffTableDumps(old, updated);
+    CHECK(diff.Fields.size() == 1 && diff.Fields[0].Name == L"Weight" && diff.Fields[0].Old->Offset == 0x24);
+    CHECK(diff.RowsRemoved.size() == 1 && diff.RowsRemoved[0] == L"Item_5" && diff.RowsAdded.empty());
+    CHECK(diff.FieldsCompared == 3);
+    CHECK(diff.Values.size() == 2); // The moved field's values are unchanged
+    CHECK(diff.Values[0].Row == L"Item_3" && diff.Values[0].Old == L"5000" && diff.Values[0].New == L"123");
+    CHECK(DiffTableDumps(old, updated, {L"Weight"}).Values.empty());
+    CHECK(DiffTableDumps(old, old).Empty());
+
+    // Truncated files are rejected
+    std::filesystem::resize_file(directory / "after.isbt", std::filesystem::file_size(directory / "after.isbt") - 3);
+    CHECK(!ReadTableDump(directory / "after.isbt", updated, &error));
+
+    // CSV holds the exported fields only
+    write(directory / "before.csv", TableExportFormat::Csv, before, 0x24, rows);
+    std::ifstream csv(directory / "before.csv");
+    std::string header;
+    std::string first;
+    std::getline(csv, header);
+    std::getline(csv, first);
+    CHECK(header == "Row,Weight,MaximumStack,SellCanStack");
+    CHECK(first == "Item_0,0,0,false");
+    csv.close();
+
+    std::filesystem::remove_all(directory);
+}
+
+int main()
+{
+    TestApplyMaxStackRule();
+    TestPatchRaisesOnlyStackableRows();
+    TestRestoreWritesOriginals();
+    TestRepatchUsesStoredOriginals();
+    TestSnapshotInvalidatedWhenRowsChange();
+    TestFieldLayoutAccessors();
+    TestRowFieldDeclarations();
+    TestHookStatsPercentiles();
+    TestStackConfigParse();
+    TestStackRuleTableCompile();
+    TestRetrySchedulerBackoff();
+    TestTablePatchApplyRevert();
+    TestBitfieldBoolsShareAByte();
+    TestObjectPatchTemplateAndInstances();
+    TestPatchJournalLayers();
+    TestPatchStateTransitions();
+    TestPatchStateStress();
+    TestTargetedPatchThroughJournal();
+    TestVirtualStackLimits();
+    TestParallelScanFirstMatches();
+    TestIncrementalSweepBudget();
+    TestEmptyStackSweepRestore();
+    TestTablePatchThroughJournal();
+    TestDiscoveryCacheRoundTrip();
+    TestIncrementalSlotSorter();
+    TestStackCompactorMergesPartials();
+    TestFrameSchedulerCoalescing();
+    TestTableExportRoundTripAndDiff();
+    TestLuaBridgeQueueAndLookupCache();
+
+    if (g_failures != 0)
+    {
+        std::fprintf(stderr, "%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    std::printf("All StackPatchCore tests passed\n");
+    return 0;
+}
@@ -0,0 +1,223 @@
+/**
+ * Host-side diff of two table dumps written by the mod (Shift + E).
+ *
+ * Reports fields that were added, removed, moved or changed type between the
+ * dumps, rows added or removed, and every value that differs, matching fields
+ * by name so moved fields are still compared. With one dump it prints the
+ * schema instead. --expectations prints the fields as RowField declarations,
+ * the form used by EnemyConfig in dllmain.cpp.
+ *
+ * Usage: InventoryStackSizeBoostTableDiff OLD.isbt [NEW.isbt] [--field NAME]...
+ *                                         [--limit N] [--expectations]
+ *
+ * Exit code is 0 when the dumps match, 1 when they differ and 2 on errors,
+ * like diff(1).
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "../TableExport.hpp"
+
+using namespace StackBoost;
+
+namespace
+{
+    struct Options
+    {
+        std::vector<std::string> Dumps;
+        std::vector<std::wstring> Fields;
+        size_t Limit = 50;
+        bool Expectations = false;
+    };
+
+    [[noreturn]] void Usage(const char* program)
+    {
+        std::fprintf(stderr, "Usage: %s OLD.isbt [NEW.isbt] [--field NAME]... [--limit N] [--expectations]\n", program);
+        std::exit(2);
+    }
+
+    Options ParseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "--field" && hasValue)
+            {
+                std::string name = argv[++i];
+                options.Fields.emplace_back(name.begin(), name.end());
+            }
+            else if (arg == "--limit" && hasValue)
+            {
+                options.Limit = std::strtoull(argv[++i], nullptr, 10);
+            }
+            else if (arg == "--expectations")
+            {
+                options.Expectations = true;
+            }
+            else if (arg.rfind("--", 0) != 0 && options.Dumps.size() < 2)
+            {
+                options.Dumps.push_back(arg);
+            }
+            else
+            {
+                Usage(argv[0]);
+            }
+        }
+        if (options.Dumps.empty())
+        {
+            Usage(argv[0]);
+        }
+        return options;
+    }
+
+    bool Load(const std::string& path, TableDump& dump)
+    {
+        std::wstring error;
+        if (!ReadTableDump(path, dump, &error))
+        {
+            std::fprintf(stderr, "%s: %ls\n", path.c_str(), error.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    bool Selected(const Options& options, const std::wstring& field)
+    {
+        return options.Fields.empty() || std::find(options.Fields.begin(), options.Fields.end(), field) != options.Fields.end();
+    }
+
+    void PrintField(const FieldInfo& field)
+    {
+        std::printf("0x%X %ls(%u)", field.Offset, FieldTypeName(field.Type), field.Size);
+    }
+
+    void PrintSchema(const Options& options, const TableDump& dump)
+    {
+        std::printf("%ls (%ls): %zu row(s), %zu field(s), %zu exported\n", dump.Table.c_str(), dump.RowStruct.c_str(),
+                    dump.RowNames.size(), dump.Layout.Fields().size(), dump.Columns.size());
+        for (const FieldInfo& field : dump.Layout.Fields())
+        {
+            if (!Selected(options, field.Name)) continue;
+            std::printf("  %-32ls ", field.Name.c_str());
+            PrintField(field);
+            std::printf("\n");
+        }
+    }
+
+    // C++ type a RowField declares for a field, or null if it cannot be declared as one
+    const char* RowFieldType(FieldType type)
+    {
+        switch (type)
+        {
+        case FieldType::Int8: return "int8_t";
+        case FieldType::Int16: return "int16_t";
+        case FieldType::Int32: return "int32_t";
+        case FieldType::Int64: return "int64_t";
+        case FieldType::UInt8: return "uint8_t";
+        case FieldType::UInt16: return "uint16_t";
+        case FieldType::UInt32: return "uint32_t";
+        case FieldType::UInt64: return "uint64_t";
+        case FieldType::Float: return "float";
+        case FieldType::Double: return "double";
+        case FieldType::Bool: return "bool";
+        default: return nullptr;
+        }
+    }
+
+    // Lines to paste into a RowField declaration block such as EnemyConfig
+    void PrintExpectations(const Options& options, const TableDump& dump)
+    {
+        for (const FieldInfo& field : dump.Layout.Fields())
+        {
+            if (!Selected(options, field.Name)) continue;
+            const char* type = RowFieldType(field.Type);
+            if (!type)
+            {
+                std::printf("    // %ls: %ls(%u) @ 0x%X\n", field.Name.c_str(), FieldTypeName(field.Type), field.Size, field.Offset);
+                continue;
+            }
+            std::printf("    constexpr RowField<%s, 0x%X> %ls{STR(\"%ls\")};\n", type, field.Offset, field.Name.c_str(), field.Name.c_str());
+        }
+    }
+
+    void PrintList(const char* label, const std::vector<std::wstring>& names, size_t limit)
+    {
+        if (names.empty()) return;
+        std::printf("%zu row(s) %s\n", names.size(), label);
+        for (size_t i = 0; i < names.size() && i < limit; ++i)
+        {
+            std::printf("  %ls\n", names[i].c_str());
+        }
+        if (names.size() > limit) std::printf("  ... %zu more\n", names.size() - limit);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options options = ParseOptions(argc, argv);
+
+    TableDump before;
+    if (!Load(options.Dumps[0], before))
+    {
+        return 2;
+    }
+    if (options.Dumps.size() == 1)
+    {
+        options.Expectations ? PrintExpectations(options, before) : PrintSchema(options, before);
+        return 0;
+    }
+
+    TableDump after;
+    if (!Load(options.Dumps[1], after))
+    {
+        return 2;
+    }
+    if (before.Table != after.Table)
+    {
+        std::printf("Comparing different tables: %ls and %ls\n", before.Table.c_str(), after.Table.c_str());
+    }
+
+    TableDumpDiff diff = DiffTableDumps(before, after, options.Fields);
+
+    for (const TableDumpDiff::FieldChange& change : diff.Fields)
+    {
+        std::printf("field %ls: ", change.Name.c_str());
+        if (!change.Old) { std::printf("added at "); PrintField(*change.New); }
+        else if (!change.New) { std::printf("removed (was "); PrintField(*change.Old); std::printf(")"); }
+        else { PrintField(*change.Old); std::printf(" -> "); PrintField(*change.New); }
+        std::printf("\n");
+    }
+    PrintList("removed", diff.RowsRemoved, options.Limit);
+    PrintList("added", diff.RowsAdded, options.Limit);
+
+    if (!diff.Values.empty())
+    {
+        std::printf("%zu value(s) changed\n", diff.Values.size());
+    }
+    for (size_t i = 0; i < diff.Values.size() && i < options.Limit; ++i)
+    {
+        const TableDumpDiff::ValueChange& change = diff.Values[i];
+        std::printf("  %ls.%ls: %ls -> %ls\n", change.Row.c_str(), change.Field.c_str(), change.Old.c_str(), change.New.c_str());
+    }
+    if (diff.Values.size() > options.Limit)
+    {
+        std::printf("  ... %zu more\n", diff.Values.size() - options.Limit);
+    }
+
+    if (options.Expectations)
+    {
+        PrintExpectations(options, after);
+    }
+    if (diff.Empty())
+    {
+        std::printf("No differences (%zu row(s), %zu field(s) compared)\n", before.RowNames.size(), diff.FieldsCompared);
+        return 0;
+    }
+    return 1;
+}